@@ -0,0 +1,101 @@
+/*
+ * AudioAnalyser.h - analysis of effect signals away from the audio threads
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AUDIO_ANALYSER_H
+#define AUDIO_ANALYSER_H
+
+#include <QAtomicInteger>
+
+#include "export.h"
+#include "lmms_basics.h"
+
+
+// An effect pushes its signal with push(), which only copies the frames
+// into a ring buffer. Every hop frames the last frames() of them are given
+// to analyse() on a shared low priority thread, but only while the
+// analyser is active, i.e. somebody is interested in the result.
+//
+// Subclasses have to call setActive( false ) in their destructor, so
+// analyse() isn't running while they are being destroyed.
+class EXPORT AudioAnalyser
+{
+public:
+	enum ChannelModes
+	{
+		MergeChannels,
+		LeftChannel,
+		RightChannel
+	} ;
+
+	AudioAnalyser( int _frames, int _hop );
+	virtual ~AudioAnalyser();
+
+	int frames() const
+	{
+		return m_frames;
+	}
+
+	bool isActive() const
+	{
+		return m_active.load() != 0;
+	}
+
+	// not for the audio threads
+	void setActive( bool _active );
+
+	// wait-free, for the one thread processing the effect
+	void push( const sampleFrame * _buf, const fpp_t _frames,
+					ChannelModes _mode = MergeChannels );
+
+	// counts the results of analyse(), to tell whether there is a new one
+	int results() const
+	{
+		return m_results.load();
+	}
+
+
+protected:
+	// runs on the analysis thread with the latest frames() samples
+	virtual void analyse( float * _input ) = 0;
+
+
+private:
+	// called by the analysis thread
+	void process();
+
+	const int m_frames;
+	const int m_hop;
+	int m_size;
+	float * m_ring;
+	float * m_input;
+
+	QAtomicInteger<quint32> m_written;
+	quint32 m_analysed;
+	QAtomicInt m_active;
+	QAtomicInt m_results;
+
+	friend class AnalysisThread;
+
+} ;
+
+
+#endif
@@ -45,6 +45,19 @@ public:
 
 	OutputSettings const & getOutputSettings() const { return m_outputSettings; }
 
+	// offline rendering: the periods are fetched in the rendering thread
+	// and written in blocks of several periods by another one
+	fpp_t renderNextBuffer( surroundSampleFrame * _ab )
+	{
+		return getNextBuffer( _ab );
+	}
+
+	void writeBlock( const surroundSampleFrame * _ab, const fpp_t _frames,
+						const float _master_gain )
+	{
+		writeBuffer( _ab, _frames, _master_gain );
+	}
+
 protected:
 	AudioFileDevice(OutputSettings const & outputSettings,
 			const ch_cnt_t _channels, const QString & _file,
@@ -108,6 +108,16 @@ public:
 		return true;
 	}
 
+	virtual const char * traceCategory() const
+	{
+		return "audioport";
+	}
+
+	virtual QString traceName() const
+	{
+		return m_name;
+	}
+
 	void addPlayHandle( PlayHandle * handle );
 	void removePlayHandle( PlayHandle * handle );
 
@@ -232,6 +232,9 @@ public:
                                    const QString& name,
                                    const bool required = true);
 
+	virtual bool saveJournalData( QDataStream& out ) const;
+	virtual void restoreJournalData( QDataStream& in );
+
 	virtual QString nodeName() const
 	{
 		return "automatablemodel";
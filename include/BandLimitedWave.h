@@ -70,7 +70,8 @@ public:
 		else
 		{ 	m_data3[ TLENS[ table ] + ph ] = sample; }
 	}
-private:
+	// public so that the tables generated at build time
+	// (BandLimitedWaveGen) can be aggregate-initialized
 	sample_t m_data [ MIPMAPSIZE ];
 	sample_t m_data3 [ MIPMAPSIZE3 ];
 
@@ -0,0 +1,94 @@
+/*
+ * BiQuadCascade.h - a chain of stereo biquads processed a buffer at a time
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BIQUAD_CASCADE_H
+#define BIQUAD_CASCADE_H
+
+#include "export.h"
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+
+
+// normalised, i.e. a0 = 1
+struct BiQuadCoefficients
+{
+	float a1, a2, b0, b1, b2;
+} ;
+
+
+// The stages of a filter chain, e.g. the bands of an equalizer, in
+// transposed direct form II. process() runs each stage over the whole
+// buffer, with SSE two stages at once, both channels in one register.
+//
+// Coefficients are set once per buffer, every stage ramps from the ones
+// of the last buffer to the new ones. Stages which aren't active are left
+// out of the chain, and start from silence when they are active again.
+class EXPORT BiQuadCascade
+{
+	MM_OPERATORS
+public:
+	enum
+	{
+		MaxStages = 16
+	} ;
+
+	BiQuadCascade();
+
+	void setStage( int _stage, const BiQuadCoefficients & _coeffs );
+
+	void setActive( int _stage, bool _active );
+
+	bool isActive( int _stage ) const
+	{
+		return m_stages[_stage].active;
+	}
+
+	void process( sampleFrame * _buf, const fpp_t _frames );
+
+	void clearHistory();
+
+
+private:
+	struct Stage
+	{
+		BiQuadCoefficients target;
+		BiQuadCoefficients current;
+		float z1[DEFAULT_CHANNELS];
+		float z2[DEFAULT_CHANNELS];
+		bool active;
+		bool fresh;
+	} ;
+
+	static void processStage( Stage & _s, sampleFrame * _buf,
+							const fpp_t _frames );
+#ifdef __SSE__
+	static void processStages( Stage & _s1, Stage & _s2,
+				sampleFrame * _buf, const fpp_t _frames );
+#endif
+
+	Stage m_stages[MaxStages];
+	int m_stageCount;
+
+} ;
+
+
+#endif
@@ -193,6 +193,12 @@ public:
 	}
 
 	const QString recoveryFile() const
+	{
+		return m_workingDir + "recover.mmpb";
+	}
+
+	// written by versions which autosaved plain XML projects
+	const QString legacyRecoveryFile() const
 	{
 		return m_workingDir + "recover.mmp";
 	}
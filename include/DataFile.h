@@ -27,12 +27,18 @@
 #ifndef DATA_FILE_H
 #define DATA_FILE_H
 
+#include <functional>
+
 #include <QDomDocument>
+#include <QHash>
+#include <QList>
+#include <QStringList>
 
 #include "export.h"
 #include "MemoryManager.h"
 
 class QTextStream;
+class ProjectBundle;
 
 class EXPORT DataFile : public QDomDocument
 {
@@ -72,6 +78,29 @@ public:
 	void write( QTextStream& strm );
 	bool writeFile( const QString& fn );
 
+	// Large binary payloads like sample data. With deferred binary data
+	// they are kept out of the document until it is written: bundles store
+	// them as chunks referenced by the attribute "datachunk", XML files get
+	// the attribute attr filled by encode. Otherwise encode is called
+	// right away. data and encode must stay valid until the file is written.
+	void setDeferBinaryData( bool defer )
+	{
+		m_deferBinaryData = defer;
+	}
+	void addBinaryData( QDomElement& elem, const QString& attr, quint64 tag,
+				const QByteArray& data,
+				const std::function<QString()>& encode );
+
+	// The bundles the document is going to be written to. Binary data
+	// whose chunk all of them have already (hasChunk()) may be added
+	// without data and encode, the chunk is kept.
+	void setBundleFiles( const QStringList& files );
+	bool hasChunk( quint64 tag ) const;
+
+	// chunk referenced by elem if its document was loaded from a bundle,
+	// a null array otherwise
+	static QByteArray binaryData( const QDomElement& elem );
+
 	QDomElement& content()
 	{
 		return m_content;
@@ -135,6 +164,19 @@ private:
 
 	void loadData( const QByteArray & _data, const QString & _sourceFile );
 
+	bool writeBundle( const QString& fileName );
+	void encodeBinaryData();
+
+	struct BinaryData
+	{
+		QDomElement elem;
+		QString attr;
+		quint64 tag;
+		QByteArray data;
+		std::function<QString()> encode;
+		QString encoded;
+	} ;
+
 
 	struct EXPORT typeDescStruct
 	{
@@ -147,6 +189,13 @@ private:
 	QDomElement m_head;
 	Type m_type;
 
+	bool m_deferBinaryData;
+	QList<BinaryData> m_binaryData;
+	QHash<QString, quint64> m_bundleChunks;
+	ProjectBundle* m_bundle;
+
+	static QList<DataFile*> s_bundles;
+
 } ;
 
 
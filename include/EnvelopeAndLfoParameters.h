@@ -138,10 +138,16 @@ private:
 	float  m_amountAdd;
 	f_cnt_t m_pahdFrames;
 	f_cnt_t m_rFrames;
-	sample_t * m_pahdEnv;
-	sample_t * m_rEnv;
-	f_cnt_t m_pahdBufSize;
-	f_cnt_t m_rBufSize;
+
+	// the envelope is piecewise linear, so it is evaluated per segment
+	// instead of being kept as a table of every frame
+	f_cnt_t m_predelayFrames;
+	f_cnt_t m_attackFrames;
+	f_cnt_t m_holdFrames;
+	f_cnt_t m_decayFrames;
+	float m_attackStep;
+	float m_decayStep;
+	float m_releaseStep;
 
 
 	FloatModel m_lfoPredelayModel;
@@ -179,6 +185,13 @@ private:
 	sample_t lfoShapeSample( fpp_t _frame_offset );
 	void updateLfoShapeData();
 
+	// level at _frame before the release, with the slope and the end of
+	// the segment _frame is in
+	inline float envSegment( f_cnt_t _frame, float & _step,
+						f_cnt_t & _end ) const;
+	inline void applyEnvRamp( float * _buf, fpp_t _frames, float _level,
+						float _step, bool _control ) const;
+
 
 	friend class EnvelopeAndLfoView;
 
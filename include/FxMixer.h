@@ -76,6 +76,8 @@ class FxChannel : public ThreadableJob
 	FxRouteVector m_receives;
 
 	virtual bool requiresProcessing() const { return true; }
+	virtual const char * traceCategory() const { return "fxchannel"; }
+	virtual QString traceName() const { return m_name; }
 	void unmuteForSolo();
 
 	QAtomicInt m_dependenciesMet;
@@ -39,6 +39,7 @@
 //#include "TempoSyncKnobModel.h"
 #include "MemoryManager.h"
 #include "MidiTime.h"
+#include "VoicePool.h"
 
 
 // forward-declarations
@@ -85,7 +86,8 @@ class EXPORT Instrument : public Plugin
 
 	// needed for deleting plugin-specific-data of a note - plugin has to
 	// cast void-ptr so that the plugin-data is deleted properly
-	// (call of dtor if it's a class etc.)
+	// (call of dtor if it's a class etc.). Plugins which keep their note
+	// data in a VoicePool member give it back there.
 	virtual void deleteNotePluginData( NotePlayHandle * _note_to_play );
 
 	// Get number of sample-frames that should be used when playing beat
@@ -30,6 +30,9 @@
 #include "lmms_basics.h"
 #include "SerializingObject.h"
 
+class QByteArray;
+class QDataStream;
+
 
 class EXPORT JournallingObject : public SerializingObject
 {
@@ -63,6 +66,36 @@ public:
 
 	virtual void restoreState( const QDomElement & _this );
 
+	// compact binary state used by the undo journal instead of a full
+	// XML state - objects returning false are always journalled as XML
+	virtual bool saveJournalData( QDataStream & _out ) const
+	{
+		Q_UNUSED( _out );
+		return false;
+	}
+
+	virtual void restoreJournalData( QDataStream & _in )
+	{
+		Q_UNUSED( _in );
+	}
+
+	// what changes the compact state _from into _to, to be applied by
+	// applyJournalDiff() - objects returning false keep whole states
+	virtual bool diffJournalData( const QByteArray & _from,
+					const QByteArray & _to,
+					QDataStream & _out ) const
+	{
+		Q_UNUSED( _from );
+		Q_UNUSED( _to );
+		Q_UNUSED( _out );
+		return false;
+	}
+
+	virtual void applyJournalDiff( QDataStream & _in )
+	{
+		Q_UNUSED( _in );
+	}
+
 	inline bool isJournalling() const
 	{
 		return m_journalling;
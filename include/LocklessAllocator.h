@@ -28,14 +28,19 @@
 #include <stddef.h>
 
 #include "AtomicInt.h"
+#include "export.h"
 
-class LocklessAllocator
+class EXPORT LocklessAllocator
 {
 public:
 	LocklessAllocator( size_t nmemb, size_t size );
 	virtual ~LocklessAllocator();
 	void * alloc();
+	// like alloc(), but quiet when there is no free space
+	void * tryAlloc();
 	void free( void * ptr );
+	// whether ptr came from this allocator
+	bool contains( const void * ptr ) const;
 
 
 private:
@@ -72,6 +77,16 @@ public:
 		return (T *)LocklessAllocator::alloc();
 	}
 
+	T * tryAlloc()
+	{
+		return (T *)LocklessAllocator::tryAlloc();
+	}
+
+	bool contains( const T * ptr ) const
+	{
+		return LocklessAllocator::contains( ptr );
+	}
+
 	void free( T * ptr )
 	{
 		LocklessAllocator::free( ptr );
@@ -49,9 +49,14 @@ public:
 		delete m_allocator;
 	}
 
-	void push( T value )
+	// returns false if the list is full
+	bool push( T value )
 	{
 		Element * e = m_allocator->alloc();
+		if( e == NULL )
+		{
+			return false;
+		}
 		e->value = value;
 
 		do
@@ -63,6 +68,8 @@ public:
 #endif
 		}
 		while( !m_first.testAndSetOrdered( e->next, e ) );
+
+		return true;
 	}
 
 	Element * popList()
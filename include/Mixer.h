@@ -25,6 +25,7 @@
 #ifndef MIXER_H
 #define MIXER_H
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QThread>
 #include <QVector>
@@ -34,11 +35,12 @@
 
 
 #include "lmms_basics.h"
-//#include "LocklessList.h"
+#include "LocklessList.h"
 #include "MemoryManager.h"
 #include "Note.h"
 #include "fifo_buffer.h"
 #include "MixerProfiler.h"
+#include "OverloadManager.h"
 
 
 class AudioDevice;
@@ -127,6 +129,8 @@ public:
 		{
 		}
 
+		// the graph runs at the output rate, this is the factor the
+		// nonlinear processors oversample themselves with
 		int sampleRateMultiplier() const
 		{
 			switch( oversampling )
@@ -210,6 +214,9 @@ public:
 
 	// play-handle stuff
 	bool addPlayHandle( PlayHandle* handle );
+	// adds all handles, e.g. the tones of a chord, which then start in
+	// the same period. Returns false if any of them were dropped.
+	bool addPlayHandles( const PlayHandleList& handles );
 
 	void removePlayHandle( PlayHandle* handle );
 
@@ -238,6 +245,11 @@ public:
 		return m_profiler.cpuLoad();
 	}
 
+	const OverloadManager & overloadManager() const
+	{
+		return m_overloadManager;
+	}
+
 	const qualitySettings & currentQualitySettings() const
 	{
 		return m_qualitySettings;
@@ -355,6 +367,13 @@ private:
 
 	void clearInternal();
 
+	// moves the handles added since the last call into m_playHandles and
+	// returns how many of them are notes, mixer thread only
+	int admitNewPlayHandles();
+	// deletes the handles that asked for it and, if _finished, the ones
+	// which are done, in one pass over m_playHandles
+	void removePlayHandles( bool _finished );
+
 	void runChangesInModel();
 
 	bool m_renderOnly;
@@ -383,10 +402,10 @@ private:
 
 	// playhandle stuff
 	PlayHandleList m_playHandles;
-	// place where new playhandles are added temporarily
-	//LocklessList<PlayHandle *> m_newPlayHandles;
-	PlayHandleList m_newPlayHandles;//QList<PlayHandle*>
-	ConstPlayHandleList m_playHandlesToRemove;
+	// place where new playhandles are added temporarily, from any thread
+	LocklessList<PlayHandle *> m_newPlayHandles;
+	// set when a handle requested its removal from outside the mixer
+	QAtomicInt m_removalRequested;
 
 
 	struct qualitySettings m_qualitySettings;
@@ -409,6 +428,7 @@ private:
 	fifoWriter * m_fifoWriter;
 
 	MixerProfiler m_profiler;
+	OverloadManager m_overloadManager;
 
 	bool m_metronomeActive;
 
@@ -25,9 +25,15 @@
 #ifndef MIXER_PROFILER_H
 #define MIXER_PROFILER_H
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
 #include "MicroTimer.h"
 #include "lmms_basics.h"
-#include <QFile>
+
+class ProfilerWriter;
+
 
 class MixerProfiler
 {
@@ -38,6 +44,7 @@ public:
 	void startPeriod()
 	{
 		m_periodTimer.reset();
+		m_periodBegin = traceTime();
 	}
 
 	void finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod );
@@ -47,13 +54,43 @@ public:
 		return m_cpuLoad;
 	}
 
+	// µs the last period took
+	int lastPeriod() const
+	{
+		return m_lastPeriod;
+	}
+
+	// A file ending in .json gets a Chrome trace (chrome://tracing) of
+	// every node rendered, any other file the time of each period.
 	void setOutputFile( const QString& outputFile );
 
+	// whether nodes should be recorded with traceNode()
+	bool isTracing() const
+	{
+		return m_tracing;
+	}
+
+	// ns since the profiler was created
+	qint64 traceTime() const
+	{
+		return m_clock.nsecsElapsed();
+	}
+
+	// Records a node which ran from begin until now. Wait-free, except
+	// for the first event of a thread. The category has to be a literal,
+	// the name is only shared, not copied.
+	void traceNode( const char* category, const QString& name,
+							qint64 begin );
+
 
 private:
 	MicroTimer m_periodTimer;
 	int m_cpuLoad;
-	QFile m_outputFile;
+	int m_lastPeriod;
+	QElapsedTimer m_clock;
+	qint64 m_periodBegin;
+	bool m_tracing;
+	ProfilerWriter* m_writer;
 
 };
 
@@ -25,6 +25,8 @@
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QObject>
 #include <QString>
 
@@ -40,13 +42,13 @@ class EXPORT Model : public QObject
 					bool _default_constructed = false ) :
 		QObject( _parent ),
 		m_displayName( _display_name ),
-		m_defaultConstructed( _default_constructed )
+		m_defaultConstructed( _default_constructed ),
+		m_changeQueued( 0 ),
+		m_nextChanged( NULL )
 	{
 	}
 
-	virtual ~Model()
-	{
-	}
+	virtual ~Model();
 
 	bool isDefaultConstructed()
 	{
@@ -73,6 +75,15 @@ class EXPORT Model : public QObject
 	virtual bool frequentlyUpdated() const;
 	virtual void setFrequentlyUpdated(const bool _b);
 
+	// makes the model emit changed() after dataChanged() or
+	// propertiesChanged(). Changes made outside the model's thread are
+	// collected without locking and only published by flushChanges(), so
+	// the audio thread doesn't post events to the views.
+	void trackChanges();
+	// emits changed() once for every model changed since the last call,
+	// must be called from the GUI thread
+	static void flushChanges();
+
  signals:
 	// emitted if actual data of the model (e.g. values) have changed
 	void dataChanged();
@@ -80,13 +91,25 @@ class EXPORT Model : public QObject
 	void dataUnchanged();
 	// emitted if properties of the model (e.g. ranges) have changed
 	void propertiesChanged();
+	// emitted in the model's thread for views, see trackChanges()
+	void changed();
 
  public slots:
+	void markChanged();
 
  private:
 	QString m_displayName;
 	bool m_defaultConstructed;
         bool m_frequentlyUpdated;
+
+	// intrusive lock-free stack of changed models
+	QAtomicInt m_changeQueued;
+	Model * m_nextChanged;
+	static QAtomicPointer<Model> s_changedModels;
+	// the models flushChanges() has taken but not emitted yet
+	static Model * s_flushedModels;
+
+	static void pushChanged( Model * _m );
 } ;
 
 
@@ -26,6 +26,7 @@
 #ifndef NOTE_H
 #define NOTE_H
 
+#include <QAtomicInt>
 #include <QVector>
 
 #include "volume.h"
@@ -92,7 +93,14 @@ public:
 	virtual ~Note();
 
 	// used by GUI
-	inline void setSelected( const bool selected ) { m_selected = selected; }
+	inline void setSelected( const bool selected )
+	{
+		if( selected != m_selected )
+		{
+			m_selected = selected;
+			s_revision.ref();
+		}
+	}
 	inline void setOldKey( const int oldKey ) { m_oldKey = oldKey; }
 	inline void setOldPos( const MidiTime & oldPos ) { m_oldPos = oldPos; }
 
@@ -213,6 +221,13 @@ public:
 
 	void createDetuning();
 
+	// bumped whenever any note is moved, resized or otherwise edited, so
+	// views can tell whether their cached rendering is still current
+	static int revision()
+	{
+		return s_revision.load();
+	}
+
         static int findKeyNum(QString& _name);
         static QString findKeyName(int _num);
 
@@ -238,6 +253,8 @@ private:
 	MidiTime m_length;
 	MidiTime m_pos;
 	DetuningHelper * m_detuning;
+
+	static QAtomicInt s_revision;
 };
 
 
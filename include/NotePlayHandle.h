@@ -26,6 +26,9 @@
 #ifndef NOTE_PLAY_HANDLE_H
 #define NOTE_PLAY_HANDLE_H
 
+#include <QMutex>
+#include <QVector>
+
 #include "AtomicInt.h"
 #include "Note.h"
 #include "ObjectManager.h"
@@ -123,7 +126,7 @@ class EXPORT NotePlayHandle /*final*/
      * deleted */
     virtual bool isFinished() const
     {
-        return m_released && framesLeft() <= 0;
+        return m_stealDone || (m_released && framesLeft() <= 0);
     }
 
     /*! Returns number of frames left for playback */
@@ -175,6 +178,18 @@ class EXPORT NotePlayHandle /*final*/
         return m_releaseStarted;
     }
 
+    /*! Ends the note within the next period with a short fade instead of
+     * its release, to make room for other notes under overload */
+    void steal()
+    {
+        m_stolen = true;
+    }
+
+    bool isStolen() const
+    {
+        return m_stolen;
+    }
+
     /*! Returns total numbers of frames played so far */
     f_cnt_t totalFramesPlayed() const
     {
@@ -355,6 +370,8 @@ class EXPORT NotePlayHandle /*final*/
     NotePlayHandle*    m_parent;     // parent note
     bool               m_hadChildren;
     bool               m_muted;    // indicates whether note is muted
+    volatile bool      m_stolen;     // fades out in the next period
+    bool               m_stealDone;  // faded out, can be removed
     Track*             m_bbTrack;  // related BB track
 
     // tempo reaction
@@ -417,6 +434,10 @@ static bool safe()
     static void release(NotePlayHandle* nph);
     // static void extend( int i );
 
+    // Released handles are kept for the next acquire(), so arpeggios and
+    // chords don't go through the allocator for every step.
+    static const int MaxPooled = 1024;
+
   protected:
     //static NotePlayHandleManager* s_singleton;
 
@@ -428,6 +449,8 @@ static bool safe()
     // static QReadWriteLock s_mutex;
     // static AtomicInt s_availableIndex;
     // static int s_size;
+    static QMutex                   s_poolMutex;
+    static QVector<NotePlayHandle*> s_pool;
 };
 
 #endif
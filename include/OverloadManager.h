@@ -0,0 +1,84 @@
+/*
+ * OverloadManager.h - keeps the mixer within its time budget
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef OVERLOAD_MANAGER_H
+#define OVERLOAD_MANAGER_H
+
+#include "PlayHandle.h"
+
+class InstrumentTrack;
+class NotePlayHandle;
+
+
+// Learns what a voice costs from the periods rendered so far, so the load
+// of the voices about to be rendered is known before they are. When the
+// period won't fit into its budget, the voices that matter least, i.e.
+// released, quiet and old ones, are stolen with a short fade instead of
+// new notes being refused.
+class OverloadManager
+{
+public:
+	enum Levels
+	{
+		LevelNormal,	// everything as requested
+		LevelDegraded,	// cheaper resampling, voices per track limited
+		LevelCritical	// voices stolen until the period fits
+	} ;
+
+	OverloadManager();
+
+	// forget the load seen so far, e.g. when rendering to another device
+	// starts
+	void reset();
+
+	Levels level() const
+	{
+		return m_level;
+	}
+
+	// mixer thread, after a period: how long it took, how long rendering
+	// the play handles took and how many voices there were
+	void finishPeriod( int _periodUs, int _voicesUs, int _voices,
+							int _budgetUs );
+
+	// mixer thread, before rendering the play handles, of which
+	// _newVoices notes just came in
+	void enforce( const PlayHandleList & _handles, int _newVoices );
+
+	// libsamplerate converter a new voice should use instead of the
+	// requested one
+	int interpolation( int _requested ) const;
+
+
+private:
+	void steal( const PlayHandleList & _handles,
+				const InstrumentTrack * _track, int _count );
+
+	float m_periodCost;
+	float m_voiceCost;
+	int m_budget;
+	Levels m_level;
+
+} ;
+
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Oversampler.h - runs a nonlinear processor at a multiple of the sample rate
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+#include "export.h"
+#include "lmms_basics.h"
+
+
+// Only the processors which create harmonics, i.e. shapers, distortions
+// and the like, need a higher rate to keep them from folding back. They
+// take up() to get their input at factor() times the rate, process that
+// buffer and take down() to get back to the rate of the rest of the graph.
+//
+// Every 2x step is a polyphase halfband FIR, so the factor is a power of
+// two. Both directions together delay the signal by about
+// 2 * HalfbandTaps frames.
+class EXPORT Oversampler
+{
+public:
+	enum
+	{
+		MaxFactor = 8,
+		MaxStages = 3,
+		// non-zero taps of one side of the halfband filter
+		HalfbandTaps = 8,
+		UpHistory = 2 * HalfbandTaps - 1,
+		DownHistory = 4 * HalfbandTaps - 3
+	} ;
+
+	// room for Mixer::framesPerPeriod() frames at the base rate
+	Oversampler( int _factor = 1 );
+	~Oversampler();
+
+	int factor() const
+	{
+		return m_factor;
+	}
+
+	// also forgets the signal so far
+	void setFactor( int _factor );
+
+	void clear();
+
+	// _frames frames at the base rate into buffer(), which then holds
+	// factor() * _frames frames
+	sampleFrame * up( const sampleFrame * _in, const fpp_t _frames );
+
+	// factor() * _frames frames of buffer() back into _frames frames at
+	// the base rate, _out may be the buffer given to up()
+	void down( sampleFrame * _out, const fpp_t _frames );
+
+	sampleFrame * buffer()
+	{
+		return m_buffer;
+	}
+
+
+private:
+	// what each 2x step has left of the signal of the last call
+	struct Stage
+	{
+		sampleFrame up[UpHistory];
+		sampleFrame down[DownHistory];
+	} ;
+
+	void upStage( Stage & _stage, const sampleFrame * _in,
+					sampleFrame * _out, const fpp_t _frames );
+	void downStage( Stage & _stage, const sampleFrame * _in,
+					sampleFrame * _out, const fpp_t _frames );
+
+	int m_factor;
+	int m_stageCount;
+	Stage m_stages[MaxStages];
+
+	fpp_t m_frames;
+	sampleFrame * m_buffer;
+	sampleFrame * m_scratch;
+	sampleFrame * m_work;
+
+} ;
+
+
+#endif
@@ -96,6 +96,12 @@ public:
 	// settings-management
 	virtual void saveSettings( QDomDocument & _doc, QDomElement & _parent );
 	virtual void loadSettings( const QDomElement & _this );
+	virtual bool saveJournalData( QDataStream & _out ) const;
+	virtual void restoreJournalData( QDataStream & _in );
+	virtual bool diffJournalData( const QByteArray & _from,
+					const QByteArray & _to,
+					QDataStream & _out ) const;
+	virtual void applyJournalDiff( QDataStream & _in );
 	inline virtual QString nodeName() const
 	{
 		return "pattern";
@@ -139,6 +145,7 @@ protected slots:
 private:
 	void setType( PatternTypes _new_pattern_type );
 	void checkType();
+	void restoreJournalHeader( QDataStream & _in );
 
 	void resizeToFirstTrack();
 
@@ -35,6 +35,7 @@
 #ifdef LMMS_DEBUG_PERFLOG
 
 #include <QHash>
+#include <QMutex>
 #include <QString>
 
 class PerfLog
@@ -64,6 +65,8 @@ class PerfLog
         Cumul();
     };
 
+    // begin() and end() may be called from any thread
+    static QMutex                         s_mutex;
     static QHash<QString, PerfLog::Entry> s_running;
     static QHash<QString, PerfLog::Cumul> s_cumulated;
 };
@@ -28,6 +28,7 @@
 #define PIANO_ROLL_H
 
 //#include <QVector>
+#include <QPixmap>
 #include <QWidget>
 
 #include "Editor.h"
@@ -39,7 +40,6 @@
 //#include "ToolTip.h"
 
 class QPainter;
-class QPixmap;
 class QScrollBar;
 class QString;
 class QMenu;
@@ -144,6 +144,7 @@ public:
 protected:
 	virtual void keyPressEvent( QKeyEvent * ke );
 	virtual void keyReleaseEvent( QKeyEvent * ke );
+	virtual void enterEvent( QEvent * e );
 	virtual void leaveEvent( QEvent * e );
 	virtual void mousePressEvent( QMouseEvent * me );
 	virtual void mouseDoubleClickEvent( QMouseEvent * me );
@@ -202,6 +203,9 @@ protected slots:
 
 	void selectRegionFromPixels( int xStart, int xEnd );
 
+	void invalidateNoteLayer();
+	void updateKeyboard();
+
 
 signals:
 	void currentPatternChanged();
@@ -360,6 +364,60 @@ private:
 	TimeLineWidget * m_timeLine;
 	bool m_scrollBack;
 
+	// everything paintEvent() draws only depending on these is cached
+	// in layers, so hovering, selecting or pressing keys doesn't redraw
+	// the grid and all notes
+	struct LayerState
+	{
+		QSize size;
+		int position;
+		int startKey;
+		int ppt;
+		int zoom;
+		int quantization;
+		int timeSigNumerator;
+		int timeSigDenominator;
+		int noteEditMode;
+		int notesEditHeight;
+		const Pattern * pattern;
+		uint markedSemiTones;
+
+		bool operator==( const LayerState & o ) const
+		{
+			return size == o.size && position == o.position &&
+				startKey == o.startKey && ppt == o.ppt &&
+				zoom == o.zoom && quantization == o.quantization &&
+				timeSigNumerator == o.timeSigNumerator &&
+				timeSigDenominator == o.timeSigDenominator &&
+				noteEditMode == o.noteEditMode &&
+				notesEditHeight == o.notesEditHeight &&
+				pattern == o.pattern &&
+				markedSemiTones == o.markedSemiTones;
+		}
+	} ;
+
+	LayerState layerState() const;
+	void updateGridLayer( const LayerState & state );
+	void updateNoteLayer( const LayerState & state );
+	void drawGrid( QPainter & p );
+	void drawNotes( QPainter & p, const QRect & area = QRect() );
+
+	QRect noteColumn( const Note * note ) const;
+	void markNote( const Note * note );
+	void markNotes( bool selectedOnly );
+	void beginNoteEdit();
+	void endNoteEdit();
+
+	QPixmap m_gridLayer;
+	LayerState m_gridLayerState;
+	QPixmap m_noteLayer;
+	LayerState m_noteLayerState;
+	int m_noteLayerRevision;
+	QRect m_noteLayerDirtyRect;
+	bool m_noteLayerDirty;
+	bool m_editingNotes;
+	bool m_drawNoteNames;
+
 	void copyToClipboard(const NoteVector & notes ) const;
 
 	void drawDetuningInfo( QPainter & _p, const Note * _n, int _x, int _y ) const;
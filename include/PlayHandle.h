@@ -81,6 +81,14 @@ class PlayHandle : public ThreadableJob
 		return !isFinished();
 	}
 
+	virtual const char * traceCategory() const
+	{
+		return "playhandle";
+	}
+
+	// named after the port it plays into, e.g. the instrument track
+	virtual QString traceName() const;
+
 	void lock()
 	{
 		m_processingLock.lock();
@@ -111,6 +119,18 @@ class PlayHandle : public ThreadableJob
 
 	virtual bool isFromTrack( const Track * _track ) const = 0;
 
+	// the mixer removes and deletes the handle in its next period, may be
+	// called from any thread
+	void requestRemoval()
+	{
+		m_removalRequested = true;
+	}
+
+	bool isRemovalRequested() const
+	{
+		return m_removalRequested;
+	}
+
 	inline bool usesBuffer() const
 	{
 		return m_usesBuffer;
@@ -158,6 +178,7 @@ class PlayHandle : public ThreadableJob
 	QMutex m_processingLock;
 	sampleFrame* m_playHandleBuffer;
 	bool m_bufferReleased;
+	volatile bool m_removalRequested;
 } ;
 
 
@@ -0,0 +1,104 @@
+/*
+ * ProjectBundle.h - chunked project container with incremental writes
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PROJECT_BUNDLE_H
+#define PROJECT_BUNDLE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "export.h"
+#include "MemoryManager.h"
+
+
+// A file of named chunks. The header at the start points to a table of
+// chunks, whose data is page aligned so it can be used straight from the
+// mapped file. Writing appends only the chunks the file doesn't have yet,
+// writes a new table behind them and finally switches the header to it,
+// so an interrupted save leaves the previous state readable.
+class EXPORT ProjectBundle
+{
+	MM_OPERATORS
+public:
+	struct Chunk
+	{
+		QString key;
+		// chunks with the same key, tag and size are not written again.
+		// Without data the chunk of the same key and tag in the file is
+		// kept.
+		quint64 tag;
+		QByteArray data;
+	} ;
+
+	ProjectBundle();
+	~ProjectBundle();
+
+	static bool isBundle( const QString & _file );
+	static quint64 fingerprint( const QByteArray & _data );
+
+	bool open( const QString & _file );
+	void close();
+
+	bool contains( const QString & _key ) const
+	{
+		return m_table.contains( _key );
+	}
+
+	// copy of the chunk's data, it doesn't depend on the mapping
+	QByteArray chunk( const QString & _key ) const;
+
+	// replaces the chunks of _file by _chunks, reusing what is unchanged
+	static bool write( const QString & _file,
+					const QList<Chunk> & _chunks );
+
+	// key and tag of the chunks in _file, nothing if it isn't a bundle
+	static QHash<QString, quint64> chunkTags( const QString & _file );
+
+
+private:
+	struct Entry
+	{
+		qint64 offset;
+		qint64 size;
+		quint64 tag;
+	} ;
+	typedef QHash<QString, Entry> Table;
+
+	static bool readTable( QFile & _file, Table & _table );
+	static bool readChunk( QFile & _file, const Table & _table,
+							Chunk & _chunk );
+	static bool writeTable( QFileDevice & _file, qint64 _pos,
+							const Table & _table );
+	static bool writeFresh( const QString & _file,
+					const QList<Chunk> & _chunks );
+
+	QFile m_file;
+	uchar * m_map;
+	Table m_table;
+
+} ;
+
+
+#endif
@@ -25,6 +25,7 @@
 #ifndef PROJECT_JOURNAL_H
 #define PROJECT_JOURNAL_H
 
+#include <QByteArray>
 #include <QHash>
 #include <QStack>
 
@@ -95,21 +96,57 @@ private:
 
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::JournalData ) ) :
+		enum Kinds
+		{
+			// a compressed DataFile with the full state
+			FullState,
+			// the object's own compact journal data
+			CompactState,
+			// changes to the compact state the object has when this
+			// check point is restored, whose hash is base
+			Diff
+		} ;
+
+		CheckPoint( jo_id_t initID = 0, Kinds initKind = FullState,
+				const QByteArray& initData = QByteArray() ) :
 			joID( initID ),
+			kind( initKind ),
+			base( 0 ),
 			data( initData )
 		{
 		}
 		jo_id_t joID;
-		DataFile data;
+		Kinds kind;
+		uint base;
+		QByteArray data;
 	} ;
 	typedef QStack<CheckPoint> CheckPointStack;
 
+	static CheckPoint saveCheckPoint( JournallingObject * jo, bool full );
+	// restores c and returns the check point leading back
+	static CheckPoint swapCheckPoint( JournallingObject * jo,
+						const CheckPoint & c );
+	static bool makeDiff( JournallingObject * jo, CheckPoint & c,
+						const QByteArray & from );
+	// whether c can be applied to the state jo has, i.e. it isn't a diff
+	// to another state
+	static bool fitsState( JournallingObject * jo, const CheckPoint & c );
+	// replaces the diff c, which doesn't fit its object, by the last full
+	// check point of the object on stack. The check points up to it are
+	// dropped. Returns false if there is none.
+	static bool fallBackToFullState( CheckPointStack & stack,
+							CheckPoint & c );
+	// turns the last compact state of c's object into a diff to c
+	void diffPrevious( JournallingObject * jo, const CheckPoint & c );
+
 	JoIdMap m_joIDs;
 
 	CheckPointStack m_undoCheckPoints;
 	CheckPointStack m_redoCheckPoints;
 
+	// compact check points added since the last full one
+	int m_compactCheckPoints;
+
 	bool m_journalling;
 
 } ;
@@ -25,6 +25,8 @@
 #ifndef PROJECT_RENDERER_H
 #define PROJECT_RENDERER_H
 
+#include <QElapsedTimer>
+
 #include "AudioFileDevice.h"
 #include "lmmsconfig.h"
 #include "Mixer.h"
@@ -81,6 +83,13 @@ public:
 
 	static const FileEncodeDevice fileEncodeDevices[];
 
+	// Renders one segment of a segmented export (see SegmentedRenderer):
+	// what is rendered before tick _writeFrom only warms up the effects
+	// and isn't written. With _overlap > 0, the file ends _overlap frames
+	// after the beginning of tick _cut, for the crossfade into the next
+	// segment.
+	void setSegment( tick_t _writeFrom, tick_t _cut, f_cnt_t _overlap );
+
 public slots:
 	void startProcessing();
 	void abortProcessing();
@@ -101,6 +110,15 @@ private:
 	volatile int m_progress;
 	volatile bool m_abort;
 
+	bool m_segment;
+	tick_t m_writeFrom;
+	tick_t m_cut;
+	f_cnt_t m_overlap;
+
+	// for the realtime factor
+	QElapsedTimer m_renderTimer;
+	volatile qint64 m_framesRendered;
+
 } ;
 
 #endif
@@ -49,6 +49,10 @@ class RenderManager : public QObject
     /// Export all unmuted tracks into individual file
     void renderTracks();
 
+    /// Render only one segment of a segmented export with renderProject(),
+    /// see ProjectRenderer::setSegment()
+    void setSegment(tick_t _writeFrom, tick_t _cut, f_cnt_t _overlap);
+
     void abortProcessing();
 
   signals:
@@ -74,6 +78,11 @@ class RenderManager : public QObject
     ProjectRenderer*                   m_activeRenderer;
     QVector<Track*>                    m_tracksToRender;
     QVector<Track*>                    m_unmuted;
+
+    bool    m_segment;
+    tick_t  m_segmentWriteFrom;
+    tick_t  m_segmentCut;
+    f_cnt_t m_segmentOverlap;
 };
 
 #endif
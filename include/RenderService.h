@@ -0,0 +1,92 @@
+/*
+ * RenderService.h - long running headless renderer fed from a spool
+ *                   directory
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_SERVICE_H
+#define RENDER_SERVICE_H
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "ProjectRenderer.h"
+
+class RenderManager;
+
+/// Renders the jobs dropped into a spool directory one after another,
+/// keeping the engine, loaded plugins and cached samples alive between
+/// them.
+///
+/// A job is an INI file named <name>.job:
+///
+///     project=/path/to/song.mmpz
+///     output=/path/to/song.ogg    (default: <spool>/<name><ext>)
+///     format=ogg                  (default: from output, or --format)
+///     loop=false
+///     tracks=false                (output is a directory then)
+///
+/// It is claimed by renaming it to <name>.job.running, so several
+/// services can share a spool directory to render in parallel, each in
+/// its own process. Progress is written back into the running job, and
+/// it ends up as <name>.job.done or <name>.job.failed with a [result]
+/// section holding the status and timings. A job whose project loads
+/// with errors, e.g. samples or plugins that are missing, fails.
+class RenderService : public QObject
+{
+    Q_OBJECT
+
+  public:
+    RenderService(const QString&                     _spoolDir,
+                  const Mixer::qualitySettings&      _qualitySettings,
+                  const OutputSettings&              _outputSettings,
+                  ProjectRenderer::ExportFileFormats _fmt);
+
+    virtual ~RenderService();
+
+    bool start();
+
+  private slots:
+    void poll();
+    void jobProgress(int _progress);
+    void jobFinished();
+
+  private:
+    bool startJob(const QString& _job);
+    void finishJob(const QString& _error);
+
+    QDir                               m_spool;
+    const Mixer::qualitySettings       m_qualitySettings;
+    const OutputSettings               m_outputSettings;
+    ProjectRenderer::ExportFileFormats m_format;
+    QTimer                             m_pollTimer;
+
+    // the running job
+    RenderManager* m_manager;
+    QString        m_jobFile;
+    QString        m_jobName;
+    QString        m_outputPath;
+    QElapsedTimer  m_jobTimer;
+    qint64         m_loadTime;
+    int            m_progress;
+};
+
+#endif
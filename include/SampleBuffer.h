@@ -29,6 +29,7 @@
 
 #include <QReadWriteLock>
 #include <QObject>
+#include <QStringList>
 
 #ifdef LMMS_HAVE_MPG123
 #include <mpg123.h>
@@ -42,9 +43,12 @@
 //#include "lmms_math.h"
 #include "shared_object.h"
 #include "MemoryManager.h"
+#include "SamplePeaks.h"
 
 class QPainter;
 class QRect;
+class QDomDocument;
+class QDomElement;
 
 
 // values for buffer margins, used for various libsamplerate interpolation modes
@@ -218,6 +222,14 @@ public:
 
 	QString & toBase64( QString & _dst ) const;
 
+	// stores the data base64 encoded in attribute _attr of _this, or as a
+	// chunk of the bundle when _doc is a DataFile deferring binary data
+	void saveData( QDomDocument & _doc, QDomElement & _this,
+				const QString & _attr = "data" ) const;
+	// counterpart of saveData(), false if _this has no data
+	bool loadData( const QDomElement & _this,
+				const QString & _attr = "data" );
+
 
 	// protect calls from the GUI to this function with dataReadLock() and
 	// dataUnlock()
@@ -263,6 +275,11 @@ public:
 	static QString tryToMakeAbsolute(const QString & _file);
 	static void clearMMap();
 
+	// decode the given audio files on the global thread pool. A later
+	// setAudioFile() on one of them only waits for its own decoding.
+	static void preloadAudioFiles(const QStringList & _files);
+	static void clearPreloadedAudioFiles();
+
 public slots:
 	void setAudioFile(const QString & _audioFile);
 	void loadFromBase64(const QString & _data);
@@ -277,6 +294,8 @@ signals:
 
 private:
 	void update( bool _keep_settings = false );
+	bool adoptPreloaded( const QString & _filename, bool _keepSettings );
+	void updatePeaks();
         void prefetch(f_cnt_t _index);
 
         void getDataFrame(f_cnt_t _f,sample_t& ch0_,sample_t& ch1_);
@@ -330,6 +349,14 @@ private:
 	sample_rate_t m_sampleRate;
 	QReadWriteLock m_varLock;
 
+	// changes whenever m_data is rebuilt, unique across sessions so
+	// bundles can tell which samples they already contain
+	quint64 m_revision;
+	static quint64 nextRevision();
+
+	// built on first visualize() after the data changed
+	SamplePeaks m_peaks;
+
         friend class AudioPort;
 } ;
 
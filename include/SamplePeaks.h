@@ -0,0 +1,97 @@
+/*
+ * SamplePeaks.h - multi-resolution min/max/rms summary of sample data
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_PEAKS_H
+#define SAMPLE_PEAKS_H
+
+#include <QString>
+#include <QVector>
+
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+
+
+// Pyramid of peaks over blocks of BLOCK_FRAMES, BLOCK_FRAMES * FACTOR, ...
+// frames, so any range of a sample can be summarized by reading a few
+// blocks instead of every frame.
+class SamplePeaks
+{
+	MM_OPERATORS
+public:
+	struct Peak
+	{
+		float min[DEFAULT_CHANNELS];
+		float max[DEFAULT_CHANNELS];
+		float rms[DEFAULT_CHANNELS];
+	} ;
+
+	static const f_cnt_t BLOCK_FRAMES = 256;
+	static const int FACTOR = 4;
+
+	SamplePeaks();
+
+	bool isEmpty() const
+	{
+		return m_levels.isEmpty();
+	}
+
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	void clear();
+	void build( const sampleFrame * _data, f_cnt_t _frames );
+
+	// the file is rejected if it is older than _source or doesn't
+	// match the given number of frames
+	bool load( const QString & _file, const QString & _source,
+							f_cnt_t _frames );
+	bool save( const QString & _file ) const;
+
+	// summary of frames [_from,_to) of _data, which must be the data
+	// the pyramid was built from
+	Peak peak( const sampleFrame * _data, f_cnt_t _from,
+						f_cnt_t _to ) const;
+
+
+private:
+	struct Sum
+	{
+		float min[DEFAULT_CHANNELS];
+		float max[DEFAULT_CHANNELS];
+		double squares[DEFAULT_CHANNELS];
+		f_cnt_t frames;
+	} ;
+
+	static f_cnt_t blockFrames( int _level );
+
+	void accumulate( Sum & _sum, const sampleFrame * _data,
+				f_cnt_t _from, f_cnt_t _to, int _level ) const;
+
+	QVector<QVector<Peak> > m_levels;
+	f_cnt_t m_frames;
+
+} ;
+
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * SegmentedRenderer.h - renders a song in segments, each in its own process
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SEGMENTED_RENDERER_H
+#define SEGMENTED_RENDERER_H
+
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include "ProjectRenderer.h"
+
+/// Exports the loaded song faster on machines with many cores. One mixer
+/// renders its periods one after another, and there is only one engine
+/// per process, so the song is cut into segments which are rendered by
+/// as many lmms processes at once.
+///
+/// Each process loads the project, starts some bars before its segment
+/// (the pre-roll) so that notes, reverbs and delays reaching into it are
+/// there, and writes the segment as raw float frames. They are then
+/// crossfaded into the output file.
+///
+/// The processes don't share state that runs independently of the song
+/// position: LFOs run from the start of each process and random values
+/// (noise, random LFOs, humanizing) differ. Around a cut the two segments
+/// may therefore differ, so the song is only cut where the user says it
+/// doesn't carry anything over, e.g. between the tracks of a DJ mix or
+/// the parts of a podcast.
+class SegmentedRenderer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    SegmentedRenderer(const Mixer::qualitySettings&      _qualitySettings,
+                      const OutputSettings&              _outputSettings,
+                      ProjectRenderer::ExportFileFormats _fmt,
+                      const QString&                     _outputPath,
+                      const QString&                     _project);
+
+    virtual ~SegmentedRenderer();
+
+    /// Cuts the song at _cuts (in ticks) and renders up to _jobs of the
+    /// segments at once
+    bool render(int _jobs, const QVector<tick_t>& _cuts, tick_t _preroll);
+
+    void abortProcessing();
+
+  signals:
+    void progressChanged(int);
+    /// only if the file is written, failed() is emitted otherwise
+    void finished();
+    void failed(const QString& _error);
+
+  public slots:
+    void updateConsoleProgress();
+
+  private slots:
+    void segmentOutput();
+    void segmentFinished();
+
+  private:
+    struct Segment
+    {
+        tick_t     begin;
+        tick_t     end;
+        QString    file;
+        QProcess*  process;
+        int        progress;
+        bool       done;
+        QByteArray log;
+    };
+
+    void        startSegments();
+    QStringList arguments(const Segment& _segment, bool _last) const;
+    int         segmentOf(QObject* _process) const;
+    bool        stitch(QString& _error);
+    void        finish(const QString& _error);
+
+    const Mixer::qualitySettings       m_qualitySettings;
+    const OutputSettings               m_outputSettings;
+    ProjectRenderer::ExportFileFormats m_format;
+    QString                            m_outputPath;
+    QString                            m_project;
+
+    QTemporaryDir     m_tempDir;
+    AudioFileDevice*  m_fileDev;
+    QVector<Segment>  m_segments;
+    int               m_jobs;
+    int               m_next;
+    int               m_running;
+    tick_t            m_preroll;
+    f_cnt_t           m_overlap;
+    int               m_progress;
+    bool              m_aborted;
+};
+
+#endif
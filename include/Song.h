@@ -208,6 +208,15 @@ public:
 		m_renderBetweenMarkers = renderBetweenMarkers;
 	}
 
+	// overrides the endpoints of the next export, e.g. to render one
+	// segment of a segmented export, reset by stopExport()
+	inline void setExportRange( const MidiTime & begin, const MidiTime & end )
+	{
+		m_exportRangeBegin = begin;
+		m_exportRangeEnd = end;
+		m_exportRange = true;
+	}
+
 	inline bool peakNormalizeFlag() const
 	{
 		return m_peakNormalizeFlag;
@@ -434,6 +443,9 @@ private:
 	volatile bool m_exporting;
 	volatile bool m_exportLoop;
 	volatile bool m_renderBetweenMarkers;
+	volatile bool m_exportRange;
+	MidiTime m_exportRangeBegin;
+	MidiTime m_exportRangeEnd;
 	volatile bool m_peakNormalizeFlag;
 	volatile bool m_playing;
 	volatile bool m_paused;
@@ -25,6 +25,8 @@
 #ifndef THREADABLE_JOB_H
 #define THREADABLE_JOB_H
 
+#include <QString>
+
 #include "AtomicInt.h"
 
 //#include "lmms_basics.h"
@@ -79,6 +81,19 @@ public:
 	virtual bool requiresProcessing() const = 0;
 
 
+	// how the job shows up in profiler traces, called from the thread
+	// which processed it
+	virtual const char * traceCategory() const
+	{
+		return "job";
+	}
+
+	virtual QString traceName() const
+	{
+		return QString();
+	}
+
+
 protected:
 	virtual void doProcessing() = 0;
 
@@ -0,0 +1,88 @@
+/*
+ * VoicePool.h - preallocated per-note data of instruments
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VOICE_POOL_H
+#define VOICE_POOL_H
+
+#include <new>
+#include <utility>
+
+#include "LocklessAllocator.h"
+
+
+// Room for the plugin data of a number of notes (NotePlayHandle::
+// m_pluginData), set aside when the instrument is created, so playNote()
+// doesn't have to go to the system allocator. Voices are handed out and
+// taken back wait-free from any thread. If more notes play at once than
+// there is room for, the others get their data from the heap.
+template<typename T>
+class VoicePool
+{
+public:
+	enum
+	{
+		DefaultVoices = 64
+	} ;
+
+	VoicePool( size_t _voices = DefaultVoices ) :
+		m_allocator( _voices )
+	{
+	}
+
+	template<typename... Args>
+	T * acquire( Args&&... _args )
+	{
+		T * voice = m_allocator.tryAlloc();
+		if( voice == NULL )
+		{
+			return new T( std::forward<Args>( _args )... );
+		}
+		// the global one, T may have its own operator new
+		return ::new( voice ) T( std::forward<Args>( _args )... );
+	}
+
+	// takes any voice acquire() returned, and NULL
+	void release( T * _voice )
+	{
+		if( _voice == NULL )
+		{
+			return;
+		}
+		if( m_allocator.contains( _voice ) )
+		{
+			_voice->~T();
+			m_allocator.free( _voice );
+		}
+		else
+		{
+			delete _voice;
+		}
+	}
+
+
+private:
+	LocklessAllocatorT<T> m_allocator;
+
+} ;
+
+
+#endif
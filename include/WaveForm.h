@@ -25,6 +25,8 @@
 #ifndef WAVEFORM_H_
 #define WAVEFORM_H_
 
+#include <QAtomicInt>
+
 #include "ComboBoxModel.h"
 #include "MemoryManager.h"
 #include "lmms_basics.h"
@@ -94,10 +96,24 @@ class WaveForm
         return m_index;
     }
 
+    inline bool isBuilt() const
+    {
+        return m_state.loadAcquire() == Built;
+    }
+
+    // realtime safe: never builds, returns ZERO until the background
+    // loader has published the requested table
     static const WaveForm* get(const int _bank, const int _index);
+    // queue a table for the background loader, e.g. on preset load
+    static void prewarm(const int _bank, const int _index);
     static void            fillBankModel(ComboBoxModel& _model);
     static void fillIndexModel(ComboBoxModel& _model, const int _bank);
 
+    // tabulate the function-based waves ahead of the first audio period
+    static void buildFunctionTables();
+    static void startLoader();
+    static void stopLoader();
+
     // Standard waves
     static const int ZERO_BANK  = 19;
     static const int ZERO_INDEX = 40;
@@ -133,6 +149,8 @@ class WaveForm
         void set(const int _bank, const int _index, const WaveForm* _wf);
         void fillBankModel(ComboBoxModel& _model);
         void fillIndexModel(ComboBoxModel& _model, const int _bank);
+        void buildFunctionTables();
+        void buildQueued();
 
       private:
         QString         m_bankNames[MAX_BANK - MIN_BANK + 1];
@@ -149,9 +167,17 @@ class WaveForm
              const interpolation_t _mode,
              const int             _quality);
 
+    enum state_t
+    {
+        Unbuilt,
+        Queued,
+        Built
+    };
+
     void build();
+    bool requestBuild() const;
 
-    bool            m_built;
+    mutable QAtomicInt m_state;
     QString         m_name;
     int             m_bank;
     int             m_index;
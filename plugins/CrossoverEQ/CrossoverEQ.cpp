@@ -51,17 +51,12 @@ CrossoverEQEffect::CrossoverEQEffect( Model* parent, const Descriptor::SubPlugin
 	Effect( &crossovereq_plugin_descriptor, parent, key ),
 	m_controls( this ),
 	m_sampleRate( Engine::mixer()->processingSampleRate() ),
-	m_lp1( m_sampleRate ),
-	m_lp2( m_sampleRate ),
-	m_lp3( m_sampleRate ),
-	m_hp2( m_sampleRate ),
-	m_hp3( m_sampleRate ),
-	m_hp4( m_sampleRate ),
 	m_needsUpdate( true )
 {
 	m_tmp1 = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 	m_tmp2 = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 	m_work = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
+	m_band = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 }
 
 CrossoverEQEffect::~CrossoverEQEffect()
@@ -69,21 +64,49 @@ CrossoverEQEffect::~CrossoverEQEffect()
 	MM_FREE( m_tmp1 );
 	MM_FREE( m_tmp2 );
 	MM_FREE( m_work );
+	MM_FREE( m_band );
 }
 
 void CrossoverEQEffect::sampleRateChanged()
 {
 	m_sampleRate = Engine::mixer()->processingSampleRate();
-	m_lp1.setSampleRate( m_sampleRate );
-	m_lp2.setSampleRate( m_sampleRate );
-	m_lp3.setSampleRate( m_sampleRate );
-	m_hp2.setSampleRate( m_sampleRate );
-	m_hp3.setSampleRate( m_sampleRate );
-	m_hp4.setSampleRate( m_sampleRate );
 	m_needsUpdate = true;
 }
 
 
+void CrossoverEQEffect::setLinkwitzRiley( BiQuadCascade & filter, float freq, bool highpass )
+{
+	// Butterworth, i.e. Q = 1 / sqrt( 2 ), from the Audio EQ Cookbook
+	const float w0 = F_2PI * freq / m_sampleRate;
+	const float c = cosf( w0 );
+	const float alpha = sinf( w0 ) / sqrtf( 2.0f );
+	const float a0 = 1.0f + alpha;
+
+	BiQuadCoefficients coeffs;
+	coeffs.a1 = -2.0f * c / a0;
+	coeffs.a2 = ( 1.0f - alpha ) / a0;
+	coeffs.b0 = ( highpass ? 1.0f + c : 1.0f - c ) * 0.5f / a0;
+	coeffs.b1 = ( highpass ? -2.0f : 2.0f ) * coeffs.b0;
+	coeffs.b2 = coeffs.b0;
+
+	for( int stage = 0; stage < 2; ++stage )
+	{
+		filter.setStage( stage, coeffs );
+		filter.setActive( stage, true );
+	}
+}
+
+
+void CrossoverEQEffect::addBand( const sampleFrame * band, float gain, const fpp_t frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		m_work[f][0] += band[f][0] * gain;
+		m_work[f][1] += band[f][1] * gain;
+	}
+}
+
+
 bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 {
         bool smoothBegin, smoothEnd;
@@ -93,18 +116,18 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	// filters update
 	if( m_needsUpdate || m_controls.m_xover12.isValueChanged() )
 	{
-		m_lp1.setLowpass( m_controls.m_xover12.value() );
-		m_hp2.setHighpass( m_controls.m_xover12.value() );
+		setLinkwitzRiley( m_lp1, m_controls.m_xover12.value(), false );
+		setLinkwitzRiley( m_hp2, m_controls.m_xover12.value(), true );
 	}
 	if( m_needsUpdate || m_controls.m_xover23.isValueChanged() )
 	{
-		m_lp2.setLowpass( m_controls.m_xover23.value() );
-		m_hp3.setHighpass( m_controls.m_xover23.value() );
+		setLinkwitzRiley( m_lp2, m_controls.m_xover23.value(), false );
+		setLinkwitzRiley( m_hp3, m_controls.m_xover23.value(), true );
 	}
 	if( m_needsUpdate || m_controls.m_xover34.isValueChanged() )
 	{
-		m_lp3.setLowpass( m_controls.m_xover34.value() );
-		m_hp4.setHighpass( m_controls.m_xover34.value() );
+		setLinkwitzRiley( m_lp3, m_controls.m_xover34.value(), false );
+		setLinkwitzRiley( m_hp4, m_controls.m_xover34.value(), true );
 	}
 
 	// gain values update
@@ -136,52 +159,39 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	memset( m_work, 0, sizeof( sampleFrame ) * frames );
 
 	// run temp bands
-	for( int f = 0; f < frames; ++f )
-	{
-		m_tmp1[f][0] = m_lp2.update( buf[f][0], 0 );
-		m_tmp1[f][1] = m_lp2.update( buf[f][1], 1 );
-		m_tmp2[f][0] = m_hp3.update( buf[f][0], 0 );
-		m_tmp2[f][1] = m_hp3.update( buf[f][1], 1 );
-	}
+	memcpy( m_tmp1, buf, sizeof( sampleFrame ) * frames );
+	memcpy( m_tmp2, buf, sizeof( sampleFrame ) * frames );
+	m_lp2.process( m_tmp1, frames );
+	m_hp3.process( m_tmp2, frames );
 
-	// run band 1
+	// run band 1, m_tmp1 stays for band 2
 	if( mute1 )
 	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp1.update( m_tmp1[f][0], 0 ) * m_gain1;
-			m_work[f][1] += m_lp1.update( m_tmp1[f][1], 1 ) * m_gain1;
-		}
+		memcpy( m_band, m_tmp1, sizeof( sampleFrame ) * frames );
+		m_lp1.process( m_band, frames );
+		addBand( m_band, m_gain1, frames );
 	}
 
 	// run band 2
 	if( mute2 )
 	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp2.update( m_tmp1[f][0], 0 ) * m_gain2;
-			m_work[f][1] += m_hp2.update( m_tmp1[f][1], 1 ) * m_gain2;
-		}
+		m_hp2.process( m_tmp1, frames );
+		addBand( m_tmp1, m_gain2, frames );
 	}
 
-	// run band 3
+	// run band 3, m_tmp2 stays for band 4
 	if( mute3 )
 	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp3.update( m_tmp2[f][0], 0 ) * m_gain3;
-			m_work[f][1] += m_lp3.update( m_tmp2[f][1], 1 ) * m_gain3;
-		}
+		memcpy( m_band, m_tmp2, sizeof( sampleFrame ) * frames );
+		m_lp3.process( m_band, frames );
+		addBand( m_band, m_gain3, frames );
 	}
 
 	// run band 4
 	if( mute4 )
 	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp4.update( m_tmp2[f][0], 0 ) * m_gain4;
-			m_work[f][1] += m_hp4.update( m_tmp2[f][1], 1 ) * m_gain4;
-		}
+		m_hp4.process( m_tmp2, frames );
+		addBand( m_tmp2, m_gain4, frames );
 	}
 
 	for( int f = 0; f < frames; ++f )
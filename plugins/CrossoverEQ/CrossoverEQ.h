@@ -31,7 +31,7 @@
 #include "CrossoverEQControls.h"
 #include "ValueBuffer.h"
 #include "lmms_math.h"
-#include "BasicFilters.h"
+#include "BiQuadCascade.h"
 
 class CrossoverEQEffect : public Effect
 {
@@ -51,6 +51,8 @@ private:
 	CrossoverEQControls m_controls;
 
 	void sampleRateChanged();
+	void setLinkwitzRiley( BiQuadCascade & filter, float freq, bool highpass );
+	void addBand( const sampleFrame * band, float gain, const fpp_t frames );
 
 	float m_sampleRate;
 	
@@ -59,17 +61,19 @@ private:
 	float m_gain3;
 	float m_gain4;
 	
-	StereoLinkwitzRiley m_lp1;
-	StereoLinkwitzRiley m_lp2;
-	StereoLinkwitzRiley m_lp3;
+	// Linkwitz-Riley filters, each one two Butterworth stages
+	BiQuadCascade m_lp1;
+	BiQuadCascade m_lp2;
+	BiQuadCascade m_lp3;
 	
-	StereoLinkwitzRiley m_hp2;
-	StereoLinkwitzRiley m_hp3;
-	StereoLinkwitzRiley m_hp4;
+	BiQuadCascade m_hp2;
+	BiQuadCascade m_hp3;
+	BiQuadCascade m_hp4;
 	
 	sampleFrame * m_tmp1;
 	sampleFrame * m_tmp2;
 	sampleFrame * m_work;
+	sampleFrame * m_band;
 	
 	bool m_needsUpdate;
 	
@@ -54,8 +54,10 @@ EqEffect::EqEffect( Model *parent, const Plugin::Descriptor::SubPluginFeatures::
 	Effect( &eq_plugin_descriptor, parent, key ),
 	m_eqControls( this ),
 	m_inGain( 1.0 ),
-	m_outGain( 1.0 )
+	m_outGain( 1.0 ),
+	m_outResults( 0 )
 {
+	m_dryBuf = MM_ALLOC( sampleFrame, Engine::mixer()->framesPerPeriod() );
 }
 
 
@@ -63,6 +65,25 @@ EqEffect::EqEffect( Model *parent, const Plugin::Descriptor::SubPluginFeatures::
 
 EqEffect::~EqEffect()
 {
+	MM_FREE( m_dryBuf );
+}
+
+
+
+
+float EqEffect::periodValue( FloatModel & model, const fpp_t frames )
+{
+	const ValueBuffer * vb = model.valueBuffer();
+	return vb ? vb->value( frames - 1 ) : model.value();
+}
+
+
+
+
+void EqEffect::setStage( int stage, const EqFilter & filter, bool active )
+{
+	m_cascade.setStage( stage, filter.coefficients() );
+	m_cascade.setActive( stage, active );
 }
 
 
@@ -74,78 +95,25 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
         if(!shouldProcessAudioBuffer(buf, frames, smoothBegin, smoothEnd))
                 return false;
 
-	// setup sample exact controls
-	float hpRes = m_eqControls.m_hpResModel.value();
-	float lowShelfRes = m_eqControls.m_lowShelfResModel.value();
-	float para1Bw = m_eqControls.m_para1BwModel.value();
-	float para2Bw = m_eqControls.m_para2BwModel.value();
-	float para3Bw = m_eqControls.m_para3BwModel.value();
-	float para4Bw = m_eqControls.m_para4BwModel.value();
-	float highShelfRes = m_eqControls.m_highShelfResModel.value();
-	float lpRes = m_eqControls.m_lpResModel.value();
-
-	float hpFreq = m_eqControls.m_hpFeqModel.value();
-	float lowShelfFreq = m_eqControls.m_lowShelfFreqModel.value();
-	float para1Freq = m_eqControls.m_para1FreqModel.value();
-	float para2Freq = m_eqControls.m_para2FreqModel.value();
-	float para3Freq = m_eqControls.m_para3FreqModel.value();
-	float para4Freq = m_eqControls.m_para4FreqModel.value();
-	float highShelfFreq = m_eqControls.m_highShelfFreqModel.value();
-	float lpFreq = m_eqControls.m_lpFreqModel.value();
-
-	ValueBuffer *hpResBuffer = m_eqControls.m_hpResModel.valueBuffer();
-	ValueBuffer *lowShelfResBuffer = m_eqControls.m_lowShelfResModel.valueBuffer();
-	ValueBuffer *para1BwBuffer = m_eqControls.m_para1BwModel.valueBuffer();
-	ValueBuffer *para2BwBuffer = m_eqControls.m_para2BwModel.valueBuffer();
-	ValueBuffer *para3BwBuffer = m_eqControls.m_para3BwModel.valueBuffer();
-	ValueBuffer *para4BwBuffer = m_eqControls.m_para4BwModel.valueBuffer();
-	ValueBuffer *highShelfResBuffer = m_eqControls.m_highShelfResModel.valueBuffer();
-	ValueBuffer *lpResBuffer = m_eqControls.m_lpResModel.valueBuffer();
-
-	ValueBuffer *hpFreqBuffer = m_eqControls.m_hpFeqModel.valueBuffer();
-	ValueBuffer *lowShelfFreqBuffer = m_eqControls.m_lowShelfFreqModel.valueBuffer();
-	ValueBuffer *para1FreqBuffer = m_eqControls.m_para1FreqModel.valueBuffer();
-	ValueBuffer *para2FreqBuffer = m_eqControls.m_para2FreqModel.valueBuffer();
-	ValueBuffer *para3FreqBuffer = m_eqControls.m_para3FreqModel.valueBuffer();
-	ValueBuffer *para4FreqBuffer = m_eqControls.m_para4FreqModel.valueBuffer();
-	ValueBuffer *highShelfFreqBuffer = m_eqControls.m_highShelfFreqModel.valueBuffer();
-	ValueBuffer *lpFreqBuffer = m_eqControls.m_lpFreqModel.valueBuffer();
-
-	int hpResInc = hpResBuffer ? 1 : 0;
-	int lowShelfResInc = lowShelfResBuffer ? 1 : 0;
-	int para1BwInc = para1BwBuffer ? 1 : 0;
-	int para2BwInc = para2BwBuffer ? 1 : 0;
-	int para3BwInc = para3BwBuffer ? 1 : 0;
-	int para4BwInc = para4BwBuffer ? 1 : 0;
-	int highShelfResInc = highShelfResBuffer ? 1 : 0;
-	int lpResInc = lpResBuffer ? 1 : 0;
-
-	int hpFreqInc = hpFreqBuffer ? 1 : 0;
-	int lowShelfFreqInc = lowShelfFreqBuffer ? 1 : 0;
-	int para1FreqInc = para1FreqBuffer ? 1 : 0;
-	int para2FreqInc = para2FreqBuffer ? 1 : 0;
-	int para3FreqInc = para3FreqBuffer ? 1 : 0;
-	int para4FreqInc = para4FreqBuffer ? 1 : 0;
-	int highShelfFreqInc = highShelfFreqBuffer ? 1 : 0;
-	int lpFreqInc = lpFreqBuffer ? 1 : 0;
-
-	float *hpResPtr = hpResBuffer ? &( hpResBuffer->values()[ 0 ] ) : &hpRes;
-	float *lowShelfResPtr = lowShelfResBuffer ? &( lowShelfResBuffer->values()[ 0 ] ) : &lowShelfRes;
-	float *para1BwPtr = para1BwBuffer ? &( para1BwBuffer->values()[ 0 ] ) : &para1Bw;
-	float *para2BwPtr = para2BwBuffer ? &( para2BwBuffer->values()[ 0 ] ) : &para2Bw;
-	float *para3BwPtr = para3BwBuffer ? &( para3BwBuffer->values()[ 0 ] ) : &para3Bw;
-	float *para4BwPtr = para4BwBuffer ? &( para4BwBuffer->values()[ 0 ] ) : &para4Bw;
-	float *highShelfResPtr = highShelfResBuffer ? &( highShelfResBuffer->values()[ 0 ] ) : &highShelfRes;
-	float *lpResPtr = lpResBuffer ? &( lpResBuffer->values()[ 0 ] ) : &lpRes;
-
-	float *hpFreqPtr = hpFreqBuffer ? &( hpFreqBuffer->values()[ 0 ] ) : &hpFreq;
-	float *lowShelfFreqPtr = lowShelfFreqBuffer ? &( lowShelfFreqBuffer->values()[ 0 ] ) : &lowShelfFreq;
-	float *para1FreqPtr = para1FreqBuffer ? &(para1FreqBuffer->values()[ 0 ] ) : &para1Freq;
-	float *para2FreqPtr = para2FreqBuffer ? &(para2FreqBuffer->values()[ 0 ] ) : &para2Freq;
-	float *para3FreqPtr = para3FreqBuffer ? &(para3FreqBuffer->values()[ 0 ] ) : &para3Freq;
-	float *para4FreqPtr = para4FreqBuffer ? &(para4FreqBuffer->values()[ 0 ] ) : &para4Freq;
-	float *hightShelfFreqPtr = highShelfFreqBuffer ? &(highShelfFreqBuffer->values()[ 0 ] ) : &highShelfFreq;
-	float *lpFreqPtr = lpFreqBuffer ? &(lpFreqBuffer ->values()[ 0 ] ) : &lpFreq;
+	// automated parameters are taken at the end of the period, the
+	// filters ramp to them
+	const float hpRes = periodValue( m_eqControls.m_hpResModel, frames );
+	const float lowShelfRes = periodValue( m_eqControls.m_lowShelfResModel, frames );
+	const float para1Bw = periodValue( m_eqControls.m_para1BwModel, frames );
+	const float para2Bw = periodValue( m_eqControls.m_para2BwModel, frames );
+	const float para3Bw = periodValue( m_eqControls.m_para3BwModel, frames );
+	const float para4Bw = periodValue( m_eqControls.m_para4BwModel, frames );
+	const float highShelfRes = periodValue( m_eqControls.m_highShelfResModel, frames );
+	const float lpRes = periodValue( m_eqControls.m_lpResModel, frames );
+
+	const float hpFreq = periodValue( m_eqControls.m_hpFeqModel, frames );
+	const float lowShelfFreq = periodValue( m_eqControls.m_lowShelfFreqModel, frames );
+	const float para1Freq = periodValue( m_eqControls.m_para1FreqModel, frames );
+	const float para2Freq = periodValue( m_eqControls.m_para2FreqModel, frames );
+	const float para3Freq = periodValue( m_eqControls.m_para3FreqModel, frames );
+	const float para4Freq = periodValue( m_eqControls.m_para4FreqModel, frames );
+	const float highShelfFreq = periodValue( m_eqControls.m_highShelfFreqModel, frames );
+	const float lpFreq = periodValue( m_eqControls.m_lpFreqModel, frames );
 
 	bool hpActive = m_eqControls.m_hpActiveModel.value();
 	bool hp24Active = m_eqControls.m_hp24Model.value();
@@ -185,9 +153,9 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 
 	if(!smoothEnd
            && m_eqControls.m_analyseInModel.value( true )
-           && m_eqControls.m_inFftBands.getActive()) // outSum > 0 )
+           && m_eqControls.m_inFftBands.isActive()) // outSum > 0 )
 	{
-		m_eqControls.m_inFftBands.analyze( buf, frames );
+		m_eqControls.m_inFftBands.push( buf, frames );
 	}
 	else
 	{
@@ -198,128 +166,45 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	m_eqControls.m_inPeakL = m_eqControls.m_inPeakL < m_inPeak[0] ? m_inPeak[0] : m_eqControls.m_inPeakL;
 	m_eqControls.m_inPeakR = m_eqControls.m_inPeakR < m_inPeak[1] ? m_inPeak[1] : m_eqControls.m_inPeakR;
 
+	// bands which are off aren't part of the cascade at all
+	m_hp.setParameters( sampleRate, hpFreq, hpRes, 1 );
+	setStage( StageHp12, m_hp, hpActive );
+	setStage( StageHp24, m_hp, hpActive && ( hp24Active || hp48Active ) );
+	setStage( StageHp480, m_hp, hpActive && hp48Active );
+	setStage( StageHp481, m_hp, hpActive && hp48Active );
+
+	m_lowShelf.setParameters( sampleRate, lowShelfFreq, lowShelfRes, lowShelfGain );
+	setStage( StageLowShelf, m_lowShelf, lowShelfActive );
+
+	m_para1.setParameters( sampleRate, para1Freq, para1Bw, para1Gain );
+	setStage( StagePara1, m_para1, para1Active );
+	m_para2.setParameters( sampleRate, para2Freq, para2Bw, para2Gain );
+	setStage( StagePara2, m_para2, para2Active );
+	m_para3.setParameters( sampleRate, para3Freq, para3Bw, para3Gain );
+	setStage( StagePara3, m_para3, para3Active );
+	m_para4.setParameters( sampleRate, para4Freq, para4Bw, para4Gain );
+	setStage( StagePara4, m_para4, para4Active );
+
+	m_highShelf.setParameters( sampleRate, highShelfFreq, highShelfRes, highShelfGain );
+	setStage( StageHighShelf, m_highShelf, highShelfActive );
+
+	m_lp.setParameters( sampleRate, lpFreq, lpRes, 1 );
+	setStage( StageLp12, m_lp, lpActive );
+	setStage( StageLp24, m_lp, lpActive && ( lp24Active || lp48Active ) );
+	setStage( StageLp480, m_lp, lpActive && lp48Active );
+	setStage( StageLp481, m_lp, lpActive && lp48Active );
+
+	memcpy( m_dryBuf, buf, sizeof( sampleFrame ) * frames );
+	m_cascade.process( buf, frames );
+
+	//apply wet / dry levels
 	for( fpp_t f = 0; f < frames; f++)
 	{
                 float w0, d0, w1, d1;
                 computeWetDryLevels(f, frames, smoothBegin, smoothEnd, w0, d0, w1, d1);
 
-		sample_t dryS[2] = { buf[f][0], buf[f][1] };
-                //dryS[0] = buf[f][0];
-		//dryS[1] = buf[f][1];
-
-		if( hpActive )
-		{
-			m_hp12.setParameters( sampleRate, *hpFreqPtr, *hpResPtr, 1 );
-			buf[f][0] = m_hp12.update( buf[f][0], 0 );
-			buf[f][1] = m_hp12.update( buf[f][1], 1 );
-
-			if( hp24Active || hp48Active )
-			{
-				m_hp24.setParameters( sampleRate, *hpFreqPtr, *hpResPtr, 1 );
-				buf[f][0] = m_hp24.update( buf[f][0], 0 );
-				buf[f][1] = m_hp24.update( buf[f][1], 1 );
-			}
-
-			if( hp48Active )
-			{
-				m_hp480.setParameters( sampleRate, *hpFreqPtr, *hpResPtr, 1 );
-				buf[f][0] = m_hp480.update( buf[f][0], 0 );
-				buf[f][1] = m_hp480.update( buf[f][1], 1 );
-
-				m_hp481.setParameters( sampleRate, *hpFreqPtr, *hpResPtr, 1 );
-				buf[f][0] = m_hp481.update( buf[f][0], 0 );
-				buf[f][1] = m_hp481.update( buf[f][1], 1 );
-			}
-		}
-
-		if( lowShelfActive )
-		{
-			m_lowShelf.setParameters( sampleRate, *lowShelfFreqPtr, *lowShelfResPtr, lowShelfGain );
-			buf[f][0] = m_lowShelf.update( buf[f][0], 0 );
-			buf[f][1] = m_lowShelf.update( buf[f][1], 1 );
-		}
-
-		if( para1Active )
-		{
-			m_para1.setParameters( sampleRate, *para1FreqPtr, *para1BwPtr, para1Gain );
-			buf[f][0] = m_para1.update( buf[f][0], 0 );
-			buf[f][1] = m_para1.update( buf[f][1], 1 );
-		}
-
-		if( para2Active )
-		{
-			m_para2.setParameters( sampleRate, *para2FreqPtr, *para2BwPtr, para2Gain );
-			buf[f][0] = m_para2.update( buf[f][0], 0 );
-			buf[f][1] = m_para2.update( buf[f][1], 1 );
-		}
-
-		if( para3Active )
-		{
-			m_para3.setParameters( sampleRate, *para3FreqPtr, *para3BwPtr, para3Gain );
-			buf[f][0] = m_para3.update( buf[f][0], 0 );
-			buf[f][1] = m_para3.update( buf[f][1], 1 );
-		}
-
-		if( para4Active )
-		{
-			m_para4.setParameters( sampleRate, *para4FreqPtr, *para4BwPtr, para4Gain );
-			buf[f][0] = m_para4.update( buf[f][0], 0 );
-			buf[f][1] = m_para4.update( buf[f][1], 1 );
-		}
-
-		if( highShelfActive )
-		{
-			m_highShelf.setParameters( sampleRate, *hightShelfFreqPtr, *highShelfResPtr, highShelfGain );
-			buf[f][0] = m_highShelf.update( buf[f][0], 0 );
-			buf[f][1] = m_highShelf.update( buf[f][1], 1 );
-		}
-
-		if( lpActive ){
-			m_lp12.setParameters( sampleRate, *lpFreqPtr, *lpResPtr, 1 );
-			buf[f][0] = m_lp12.update( buf[f][0], 0 );
-			buf[f][1] = m_lp12.update( buf[f][1], 1 );
-
-			if( lp24Active || lp48Active )
-			{
-				m_lp24.setParameters( sampleRate, *lpFreqPtr, *lpResPtr, 1 );
-				buf[f][0] = m_lp24.update( buf[f][0], 0 );
-				buf[f][1] = m_lp24.update( buf[f][1], 1 );
-			}
-
-			if( lp48Active )
-			{
-				m_lp480.setParameters( sampleRate, *lpFreqPtr, *lpResPtr, 1 );
-				buf[f][0] = m_lp480.update( buf[f][0], 0 );
-				buf[f][1] = m_lp480.update( buf[f][1], 1 );
-
-				m_lp481.setParameters( sampleRate, *lpFreqPtr, *lpResPtr, 1 );
-				buf[f][0] = m_lp481.update( buf[f][0], 0 );
-				buf[f][1] = m_lp481.update( buf[f][1], 1 );
-			}
-		}
-
-		//apply wet / dry levels
-		buf[f][0] = ( d0 * dryS[0] ) + ( w0 * buf[f][0] );
-		buf[f][1] = ( d1 * dryS[1] ) + ( w1 * buf[f][1] );
-
-		//increment pointers if needed
-		hpResPtr += hpResInc;
-		lowShelfResPtr += lowShelfResInc;
-		para1BwPtr += para1BwInc;
-		para2BwPtr += para2BwInc;
-		para3BwPtr += para3BwInc;
-		para4BwPtr += para4BwInc;
-		highShelfResPtr += highShelfResInc;
-		lpResPtr += lpResInc;
-
-		hpFreqPtr += hpFreqInc;
-		lowShelfFreqPtr += lowShelfFreqInc;
-		para1FreqPtr += para1FreqInc;
-		para2FreqPtr += para2FreqInc;
-		para3FreqPtr += para3FreqInc;
-		para4FreqPtr += para4FreqInc;
-		hightShelfFreqPtr += highShelfFreqInc;
-		lpFreqPtr += lpFreqInc;
+		buf[f][0] = ( d0 * m_dryBuf[f][0] ) + ( w0 * buf[f][0] );
+		buf[f][1] = ( d1 * m_dryBuf[f][1] ) + ( w1 * buf[f][1] );
 	}
 
 	sampleFrame outPeak = { 0, 0 };
@@ -329,10 +214,15 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 
 	if(!smoothEnd
            && m_eqControls.m_analyseOutModel.value( true )
-           && m_eqControls.m_outFftBands.getActive())//outSum > 0 )
+           && m_eqControls.m_outFftBands.isActive())//outSum > 0 )
 	{
-		m_eqControls.m_outFftBands.analyze( buf, frames );
-		setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
+		m_eqControls.m_outFftBands.push( buf, frames );
+		// the bands only change when the analysis thread is done
+		if( m_eqControls.m_outFftBands.results() != m_outResults )
+		{
+			m_outResults = m_eqControls.m_outFftBands.results();
+			setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
+		}
 	}
 	else
 	{
@@ -25,6 +25,7 @@
 #define EQEFFECT_H
 
 #include "BasicFilters.h"
+#include "BiQuadCascade.h"
 #include "Effect.h"
 #include "EqControls.h"
 #include "EqFilter.h"
@@ -65,10 +66,27 @@ public:
 private:
 	EqControls m_eqControls;
 
-	EqHp12Filter m_hp12;
-	EqHp12Filter m_hp24;
-	EqHp12Filter m_hp480;
-	EqHp12Filter m_hp481;
+	// the stages of m_cascade, the pass filters get steeper by repeating
+	// the same coefficients
+	enum Stages
+	{
+		StageHp12,
+		StageHp24,
+		StageHp480,
+		StageHp481,
+		StageLowShelf,
+		StagePara1,
+		StagePara2,
+		StagePara3,
+		StagePara4,
+		StageHighShelf,
+		StageLp12,
+		StageLp24,
+		StageLp480,
+		StageLp481
+	} ;
+
+	EqHp12Filter m_hp;
 
 	EqLowShelfFilter m_lowShelf;
 
@@ -79,16 +97,21 @@ private:
 
 	EqHighShelfFilter m_highShelf;
 
-	EqLp12Filter m_lp12;
-	EqLp12Filter m_lp24;
-	EqLp12Filter m_lp480;
-	EqLp12Filter m_lp481;
+	EqLp12Filter m_lp;
+
+	BiQuadCascade m_cascade;
+	sampleFrame * m_dryBuf;
 
 	float m_inGain;
 	float m_outGain;
+	// last result of m_outFftBands the band peaks were taken from
+	int m_outResults;
 
 	float peakBand( float minF, float maxF, EqAnalyser *, int );
 
+	static float periodValue( FloatModel & model, const fpp_t frames );
+	void setStage( int stage, const EqFilter & filter, bool active );
+
 	inline float bandToFreq ( int index , int sampleRate )
 	{
 		return index * sampleRate / ( MAX_BANDS * 2 );
@@ -26,16 +26,17 @@
 #define EQFILTER_H
 
 #include "BasicFilters.h"
+#include "BiQuadCascade.h"
 #include "lmms_math.h"
 
 ///
 /// \brief The EqFilter class.
-/// A wrapper for the StereoBiQuad class, giving it freq, res, and gain controls.
-/// It is designed to process periods in one pass, with recalculation of coefficents
-/// upon parameter changes. The intention is to use this as a bass class, children override
-/// the calcCoefficents() function, providing the coefficents a1, a2, b0, b1, b2.
+/// Calculates the coefficents of one stage of a BiQuadCascade from freq, res,
+/// and gain controls, upon parameter changes. The intention is to use this as a
+/// bass class, children override the calcCoefficents() function, providing the
+/// coefficents a1, a2, b0, b1, b2.
 ///
-class EqFilter : public StereoBiQuad
+class EqFilter
 {
 public:
 	EqFilter() :
@@ -45,7 +46,22 @@ public:
 		m_gain(0),
 		m_bw(0)
 	{
+		setCoeffs( 0, 0, 0, 0, 0 );
+	}
+
+
 
+
+	virtual ~EqFilter()
+	{
+	}
+
+
+
+
+	inline const BiQuadCoefficients & coefficients() const
+	{
+		return m_coeffs;
 	}
 
 
@@ -127,6 +143,16 @@ protected:
 
 	}
 
+	inline void setCoeffs( float a1, float a2, float b0, float b1, float b2 )
+	{
+		m_coeffs.a1 = a1;
+		m_coeffs.a2 = a2;
+		m_coeffs.b0 = b0;
+		m_coeffs.b1 = b1;
+		m_coeffs.b2 = b2;
+	}
+
+	BiQuadCoefficients m_coeffs;
 	float m_sampleRate;
 	float m_freq;
 	float m_res;
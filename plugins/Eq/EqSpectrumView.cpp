@@ -29,10 +29,9 @@
 #include "Mixer.h"
 
 EqAnalyser::EqAnalyser() :
-	m_framesFilledUp ( 0 ),
+	AudioAnalyser( FFT_BUFFER_SIZE, FFT_BUFFER_SIZE ),
 	m_energy ( 0 ),
-	m_sampleRate ( 1 ),
-	m_active ( true )
+	m_sampleRate ( 1 )
 {
 	m_inProgress=false;
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
@@ -51,7 +50,10 @@ EqAnalyser::EqAnalyser() :
 									  + a2 * cosf( 4 * F_PI * i / (float)FFT_BUFFER_SIZE-1)
 									  - a3 * cos( 6 * F_PI * i / (float)FFT_BUFFER_SIZE - 1.0 ));
 	}
-	clear();
+
+	// planning uses the buffer, the second half stays zero from now on
+	memset( m_buffer, 0, sizeof( m_buffer ) );
+	memset( m_bands, 0, sizeof( m_bands ) );
 }
 
 
@@ -59,6 +61,7 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
+	setActive( false );
 	fftwf_destroy_plan( m_fftPlan );
 	fftwf_free( m_specBuf );
 }
@@ -66,56 +69,31 @@ EqAnalyser::~EqAnalyser()
 
 
 
-void EqAnalyser::analyze( sampleFrame *buf, const fpp_t frames )
+// runs on the analysis thread while the view is visible
+void EqAnalyser::analyse( float * _input )
 {
-	//only analyse if the view is visible
-	if ( m_active )
-	{
-		m_inProgress=true;
-		const int FFT_BUFFER_SIZE = 2048;
-		fpp_t f = 0;
-		if( frames > FFT_BUFFER_SIZE )
-		{
-			m_framesFilledUp = 0;
-			f = frames - FFT_BUFFER_SIZE;
-		}
-		// meger channels
-		for( ; f < frames; ++f )
-		{
-			m_buffer[m_framesFilledUp] =
-					( buf[f][0] + buf[f][1] ) * 0.5;
-			++m_framesFilledUp;
-		}
+	m_inProgress=true;
 
-		if( m_framesFilledUp < FFT_BUFFER_SIZE )
-		{
-			m_inProgress = false;
-			return;
-		}
+	m_sampleRate = Engine::mixer()->processingSampleRate();
+	const int LOWEST_FREQ = 0;
+	const int HIGHEST_FREQ = m_sampleRate / 2;
 
-		m_sampleRate = Engine::mixer()->processingSampleRate();
-		const int LOWEST_FREQ = 0;
-		const int HIGHEST_FREQ = m_sampleRate / 2;
-
-		//apply FFT window
-		for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
-		{
-			m_buffer[i] = m_buffer[i] * m_fftWindow[i];
-		}
+	//apply FFT window
+	for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
+	{
+		m_buffer[i] = _input[i] * m_fftWindow[i];
+	}
 
-		fftwf_execute( m_fftPlan );
-		absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+	fftwf_execute( m_fftPlan );
+	absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
 
-		compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
-					   MAX_BANDS,
-					   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
-					   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
-		m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+	compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
+				   MAX_BANDS,
+				   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
+				   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
+	m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
 
-		m_framesFilledUp = 0;
-		m_inProgress = false;
-		m_active = false;
-	}
+	m_inProgress = false;
 }
 
 
@@ -137,22 +115,6 @@ int EqAnalyser::getSampleRate() const
 
 
 
-bool EqAnalyser::getActive() const
-{
-	return m_active;
-}
-
-
-
-
-void EqAnalyser::setActive(bool active)
-{
-	m_active = active;
-}
-
-
-
-
 bool EqAnalyser::getInProgress()
 {
 	return m_inProgress;
@@ -163,9 +125,12 @@ bool EqAnalyser::getInProgress()
 
 void EqAnalyser::clear()
 {
-	m_framesFilledUp = 0;
+	// called every period while nothing is analysed
+	if( m_energy == 0 )
+	{
+		return;
+	}
 	m_energy = 0;
-	memset( m_buffer, 0, sizeof( m_buffer ) );
 	memset( m_bands, 0, sizeof( m_bands ) );
 }
 
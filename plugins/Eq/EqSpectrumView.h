@@ -26,13 +26,14 @@
 #include <QPainter>
 #include <QWidget>
 
+#include "AudioAnalyser.h"
 #include "fft_helpers.h"
 #include "lmms_basics.h"
 #include "lmms_math.h"
 
 
 const int MAX_BANDS = 2048;
-class EqAnalyser
+class EqAnalyser : public AudioAnalyser
 {
 public:
 	EqAnalyser();
@@ -42,23 +43,19 @@ public:
 	bool getInProgress();
 	void clear();
 
-	void analyze( sampleFrame *buf, const fpp_t frames );
-
 	float getEnergy() const;
 	int getSampleRate() const;
-	bool getActive() const;
 
-	void setActive(bool active);
+protected:
+	virtual void analyse( float * _input );
 
 private:
 	fftwf_plan m_fftPlan;
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
 	float m_buffer[FFT_BUFFER_SIZE*2];
-	int m_framesFilledUp;
 	float m_energy;
 	int m_sampleRate;
-	bool m_active;
 	bool m_inProgress;
 	float m_fftWindow[FFT_BUFFER_SIZE];
 };
@@ -73,6 +70,7 @@ public:
 	explicit EqSpectrumView( EqAnalyser *b, QWidget *_parent = 0 );
 	virtual ~EqSpectrumView()
 	{
+		m_analyser->setActive( false );
 	}
 
 	QColor getColor() const;
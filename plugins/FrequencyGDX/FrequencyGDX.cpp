@@ -71,10 +71,9 @@ int closest_key(float _f, float _delta)
 FrequencyGDX::FrequencyGDX(Model*                                    parent,
                            const Descriptor::SubPluginFeatures::Key* key) :
       Effect(&frequencygdx_plugin_descriptor, parent, key),
-      m_gdxControls(this), m_framesFilledUp(0), m_ak(-1), m_energy(0)
+      AudioAnalyser(FFT_BUFFER_SIZE * 2, FFT_BUFFER_SIZE * 2),
+      m_gdxControls(this), m_ak(-1), m_energy(0)
 {
-    memset(m_buffer, 0, 2 * FFT_BUFFER_SIZE);
-
     m_specBuf = (fftwf_complex*)fftwf_malloc((FFT_BUFFER_SIZE + 1)
                                              * sizeof(fftwf_complex));
     m_fftPlan = fftwf_plan_dft_r2c_1d(FFT_BUFFER_SIZE * 2, m_buffer,
@@ -86,61 +85,33 @@ FrequencyGDX::FrequencyGDX(Model*                                    parent,
         float pitch  = (k - 69) / 12.f;
         REF_FREQS[k] = 440.f * powf(2.f, pitch);
     }
+
+    // the models are outputs, so there's always somebody interested
+    setActive(true);
 }
 
 FrequencyGDX::~FrequencyGDX()
 {
+    setActive(false);
     fftwf_destroy_plan(m_fftPlan);
     fftwf_free(m_specBuf);
 }
 
 bool FrequencyGDX::processAudioBuffer(sampleFrame* _buf, const fpp_t _frames)
 {
-    int frames = qMin<int>(_frames, 2 * FFT_BUFFER_SIZE);
-    memmove(m_buffer, m_buffer + frames, 2 * FFT_BUFFER_SIZE - frames);
-    int start = 2 * FFT_BUFFER_SIZE - frames;
-    // memset(m_buffer + start, 0, frames);
-
     bool smoothBegin, smoothEnd;
     if(!shouldProcessAudioBuffer(_buf, _frames, smoothBegin, smoothEnd))
-    {
-        m_framesFilledUp = 0;
         return false;
-    }
 
-    const int cm = LeftChannel;  // m_saControls.m_channelMode.value();
+    // the frequency is detected by the analysis thread
+    push(_buf, _frames, LeftChannel);
 
-    switch(cm)
-    {
-        case MergeChannels:
-            for(fpp_t f = 0; f < frames; ++f)
-            {
-                m_buffer[start + f] = (_buf[f][0] + _buf[f][1]) * 0.5;
-            }
-            break;
-        case LeftChannel:
-            for(fpp_t f = 0; f < frames; ++f)
-            {
-                m_buffer[start + f] = _buf[f][0];
-            }
-            break;
-        case RightChannel:
-            for(fpp_t f = 0; f < frames; ++f)
-            {
-                m_buffer[start + f] = _buf[f][1];
-            }
-            break;
-    }
-
-    m_framesFilledUp += frames;
-
-    // qInfo("ffu=%d FBS=%d frames=%d", m_framesFilledUp, FFT_BUFFER_SIZE,
-    //      frames);
+    return shouldKeepRunning(_buf, _frames);
+}
 
-    if(m_framesFilledUp < 2 * FFT_BUFFER_SIZE)
-        return isRunning();
-    else
-        m_framesFilledUp = 2 * FFT_BUFFER_SIZE;
+void FrequencyGDX::analyse(float* _input)
+{
+    memcpy(m_buffer, _input, 2 * FFT_BUFFER_SIZE * sizeof(float));
 
     fftwf_execute(m_fftPlan);
     absspec(m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE + 1);
@@ -184,10 +155,6 @@ bool FrequencyGDX::processAudioBuffer(sampleFrame* _buf, const fpp_t _frames)
 
         m_ak = ak;
     }
-
-    m_framesFilledUp = 0;
-
-    return shouldKeepRunning(_buf, _frames);
 }
 
 extern "C"
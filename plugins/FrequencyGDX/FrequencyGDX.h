@@ -25,6 +25,7 @@
 #ifndef FREQUENCYGDX_H
 #define FREQUENCYGDX_H
 
+#include "AudioAnalyser.h"
 #include "Effect.h"
 #include "FrequencyGDXControls.h"
 #include "ValueBuffer.h"
@@ -34,16 +35,9 @@
 #define FFT_BUFFER_SIZE 4096
 // 22050
 
-class PLUGIN_EXPORT FrequencyGDX : public Effect
+class PLUGIN_EXPORT FrequencyGDX : public Effect, public AudioAnalyser
 {
   public:
-    enum ChannelModes
-    {
-        MergeChannels,
-        LeftChannel,
-        RightChannel
-    };
-
     static const int MAX_BANDS = 22050;
 
     FrequencyGDX(Model*                                    parent,
@@ -56,6 +50,9 @@ class PLUGIN_EXPORT FrequencyGDX : public Effect
         return &m_gdxControls;
     }
 
+  protected:
+    virtual void analyse(float* _input);
+
   private:
     FrequencyGDXControls m_gdxControls;
 
@@ -64,7 +61,6 @@ class PLUGIN_EXPORT FrequencyGDX : public Effect
     fftwf_complex* m_specBuf;
     float          m_absSpecBuf[FFT_BUFFER_SIZE + 1];
     float          m_buffer[FFT_BUFFER_SIZE * 2];
-    int            m_framesFilledUp;
 
     int   m_ak;
     float m_energy;
@@ -177,7 +177,7 @@ void PadsGDX::playNote(NotePlayHandle* _n, sampleFrame* _buffer )
 				break;
 		}
                 */
-		_n->m_pluginData = new handleState( _n->hasDetuningInfo(), srcmode );
+		_n->m_pluginData = m_voices.acquire( _n->hasDetuningInfo(), srcmode );
 		((handleState*)_n->m_pluginData)->setFrameIndex( m_nextPlayStartPoint );
 		((handleState*)_n->m_pluginData)->setBackwards( m_nextPlayBackwards );
 
@@ -227,7 +227,7 @@ void PadsGDX::playNote(NotePlayHandle* _n, sampleFrame* _buffer )
 
 void PadsGDX::deleteNotePluginData(NotePlayHandle* _n)
 {
-	delete (handleState*)_n->m_pluginData;
+	m_voices.release( (handleState*)_n->m_pluginData );
 }
 
 
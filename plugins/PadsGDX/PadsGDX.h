@@ -132,6 +132,8 @@ public slots:
 	f_cnt_t       m_nextPlayStartPoint;
 	bool          m_nextPlayBackwards;
 
+	VoicePool<handleState> m_voices;
+
 	friend class PadsGDXView;
 
 };
@@ -71,6 +71,16 @@ bool ShaperGDX::processAudioBuffer(sampleFrame* _buf, const fpp_t _frames)
             = WaveForm::get(m_gdxControls.m_waveBankModel.value(),
                             m_gdxControls.m_waveIndexModel.value());
 
+    // clipping makes harmonics, which would fold back at the base rate
+    const int factor
+            = Engine::mixer()->currentQualitySettings().sampleRateMultiplier();
+    if(factor != m_oversampler.factor())
+        m_oversampler.setFactor(factor);
+    sampleFrame* buf = m_oversampler.up(_buf, _frames);
+    const float  phaseInc
+            = 1000.f / Engine::mixer()->processingSampleRate()
+              / m_oversampler.factor();
+
     for(fpp_t f = 0; f < _frames; ++f)
     {
         float w0, d0, w1, d1;
@@ -87,26 +97,36 @@ bool ShaperGDX::processAudioBuffer(sampleFrame* _buf, const fpp_t _frames)
                 = (float)(outGainBuf ? outGainBuf->value(f)
                                      : m_gdxControls.m_outGainModel.value());
 
-        float curVal0 = _buf[f][0];
-        float curVal1 = _buf[f][1];
+        for(int o = 0; o < m_oversampler.factor(); ++o, ++buf)
+        {
+            float curVal0 = buf[0][0];
+            float curVal1 = buf[0][1];
 
-        m_phase = fraction(m_phase);
+            m_phase = fraction(m_phase);
 
-        float waveGain = wf->f(m_phase);
-        waveGain=(ratio * waveGain + (1.f - ratio)) * outGain;
+            float waveGain = wf->f(m_phase);
+            waveGain=(ratio * waveGain + (1.f - ratio)) * outGain;
 
-        m_phase += (1000.f / time / Engine::mixer()->processingSampleRate());
+            m_phase += phaseInc / time;
 
-        curVal0 = qBound(-1.f, curVal0 * waveGain, 1.f);
-        curVal1 = qBound(-1.f, curVal1 * waveGain, 1.f);
+            curVal0 = qBound(-1.f, curVal0 * waveGain, 1.f);
+            curVal1 = qBound(-1.f, curVal1 * waveGain, 1.f);
 
-        m_gdxControls.m_buffer[f][0]=waveGain;
-        m_gdxControls.m_buffer[f][1]=curVal0;
+            if(o == 0)
+            {
+                m_gdxControls.m_buffer[f][0]=waveGain;
+                m_gdxControls.m_buffer[f][1]=curVal0;
+            }
 
-        _buf[f][0] = d0 * _buf[f][0] + w0 * curVal0;
-        _buf[f][1] = d1 * _buf[f][1] + w1 * curVal1;
+            // the dry signal is oversampled as well so both are
+            // delayed alike
+            buf[0][0] = d0 * buf[0][0] + w0 * curVal0;
+            buf[0][1] = d1 * buf[0][1] + w1 * curVal1;
+        }
     }
 
+    m_oversampler.down(_buf, _frames);
+
     m_gdxControls.emit nextStereoBuffer(_buf);
     return shouldKeepRunning(_buf, _frames);
 }
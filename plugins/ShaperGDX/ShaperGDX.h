@@ -26,6 +26,7 @@
 #define SHAPERGDX_H
 
 #include "Effect.h"
+#include "Oversampler.h"
 #include "ShaperGDXControls.h"
 #include "ValueBuffer.h"
 #include "lmms_math.h"
@@ -45,6 +46,7 @@ class PLUGIN_EXPORT ShaperGDX : public Effect
   private:
     ShaperGDXControls m_gdxControls;
     float             m_phase;
+    Oversampler       m_oversampler;
 
     friend class ShaperGDXControls;
 };
@@ -54,6 +54,8 @@ ShaperGDXControls::ShaperGDXControls(ShaperGDX* effect) :
 
     connect(&m_waveBankModel, SIGNAL(dataChanged()), this,
             SLOT(updateWaveIndexModel()));
+    connect(&m_waveIndexModel, SIGNAL(dataChanged()), this,
+            SLOT(prewarmWave()));
 
     /*
     connect( &m_volumeModel, SIGNAL( dataChanged() ), this, SLOT(
@@ -82,6 +84,7 @@ void ShaperGDXControls::loadSettings(const QDomElement& _this)
     m_ratioModel.loadSettings(_this, "ratio");
     m_outGainModel.loadSettings(_this, "out_gain");
     m_modeModel.loadSettings(_this, "mode");
+    prewarmWave();
 }
 
 void ShaperGDXControls::saveSettings(QDomDocument& doc, QDomElement& _this)
@@ -101,3 +104,8 @@ void ShaperGDXControls::updateWaveIndexModel()
     WaveForm::fillIndexModel(m_waveIndexModel, bank);
     m_waveIndexModel.setValue(old);
 }
+
+void ShaperGDXControls::prewarmWave()
+{
+    WaveForm::prewarm(m_waveBankModel.value(), m_waveIndexModel.value());
+}
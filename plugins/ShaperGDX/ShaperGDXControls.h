@@ -62,6 +62,7 @@ class ShaperGDXControls : public EffectControls
   private slots:
     void changeControl();
     void updateWaveIndexModel();
+    void prewarmWave();
 
   private:
     ShaperGDX* m_effect;
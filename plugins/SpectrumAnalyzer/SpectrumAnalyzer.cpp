@@ -50,14 +50,16 @@ Plugin::Descriptor PLUGIN_EXPORT spectrumanalyzer_plugin_descriptor =
 SpectrumAnalyzer::SpectrumAnalyzer( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &spectrumanalyzer_plugin_descriptor, _parent, _key ),
+	AudioAnalyser( FFT_BUFFER_SIZE, FFT_BUFFER_SIZE ),
 	m_saControls( this ),
-	m_framesFilledUp( 0 ),
 	m_energy( 0 )
 {
-	memset( m_buffer, 0, sizeof( m_buffer ) );
-
 	m_specBuf = (fftwf_complex *) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
 	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+
+	// planning uses the buffer, the second half stays zero from now on
+	memset( m_buffer, 0, sizeof( m_buffer ) );
+	memset( m_bands, 0, sizeof( m_bands ) );
 }
 
 
@@ -65,6 +67,7 @@ SpectrumAnalyzer::SpectrumAnalyzer( Model * _parent,
 
 SpectrumAnalyzer::~SpectrumAnalyzer()
 {
+	setActive( false );
 	fftwf_destroy_plan( m_fftPlan );
 	fftwf_free( m_specBuf );
 }
@@ -78,56 +81,20 @@ bool SpectrumAnalyzer::processAudioBuffer( sampleFrame* _buf, const fpp_t _frame
         if(!shouldProcessAudioBuffer(_buf, _frames, smoothBegin, smoothEnd))
                 return false;
 
-	//tmp optimisation if the display is hidden, use dontRun
-	//if( !m_saControls.isViewVisible() )
-        /*
-	if( dontRun() )
-	{
-		qWarning("SpectrumAnalyzer::processAudioBuffer dontRun is set, skip processing");
-		return true;
-	}
-        */
+	// the spectrum is computed by the analysis thread while the view
+	// is open
+	push( _buf, _frames,
+		(ChannelModes) m_saControls.m_channelMode.value() );
 
-	fpp_t f = 0;
-	if( _frames > FFT_BUFFER_SIZE )
-	{
-		m_framesFilledUp = 0;
-		f = _frames - FFT_BUFFER_SIZE;
-	}
+	return true;
+}
 
-	const int cm = m_saControls.m_channelMode.value();
 
-	switch( cm )
-	{
-		case MergeChannels:
-			for( ; f < _frames; ++f )
-			{
-				m_buffer[m_framesFilledUp] =
-					( _buf[f][0] + _buf[f][1] ) * 0.5;
-				++m_framesFilledUp;
-			}
-			break;
-		case LeftChannel:
-			for( ; f < _frames; ++f )
-			{
-				m_buffer[m_framesFilledUp] = _buf[f][0];
-				++m_framesFilledUp;
-			}
-			break;
-		case RightChannel:
-			for( ; f < _frames; ++f )
-			{
-				m_buffer[m_framesFilledUp] = _buf[f][1];
-				++m_framesFilledUp;
-			}
-			break;
-	}
 
-	if( m_framesFilledUp < FFT_BUFFER_SIZE )
-	{
-		return isRunning();
-	}
 
+void SpectrumAnalyzer::analyse( float * _input )
+{
+	memcpy( m_buffer, _input, FFT_BUFFER_SIZE * sizeof( float ) );
 
 //	hanming( m_buffer, FFT_BUFFER_SIZE, HAMMING );
 
@@ -150,11 +117,6 @@ bool SpectrumAnalyzer::processAudioBuffer( sampleFrame* _buf, const fpp_t _frame
 		calc13octaveband31( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1, sr/2.0 );
 		m_energy = signalpower( m_buffer, FFT_BUFFER_SIZE ) / maximum( m_buffer, FFT_BUFFER_SIZE );
 	}
-
-
-	m_framesFilledUp = 0;
-
-	return true;
 }
 
 
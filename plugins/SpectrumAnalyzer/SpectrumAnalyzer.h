@@ -26,6 +26,7 @@
 #ifndef _SPECTRUM_ANALYZER_H
 #define _SPECTRUM_ANALYZER_H
 
+#include "AudioAnalyser.h"
 #include "Effect.h"
 #include "fft_helpers.h"
 #include "SpectrumAnalyzerControls.h"
@@ -34,16 +35,9 @@
 const int MAX_BANDS = 249;
 
 
-class SpectrumAnalyzer : public Effect
+class SpectrumAnalyzer : public Effect, public AudioAnalyser
 {
 public:
-	enum ChannelModes
-	{
-		MergeChannels,
-		LeftChannel,
-		RightChannel
-	} ;
-
 	SpectrumAnalyzer( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key );
 	virtual ~SpectrumAnalyzer();
@@ -62,6 +56,10 @@ public:
 	}
 
 
+protected:
+	virtual void analyse( float * _input );
+
+
 private:
 	SpectrumAnalyzerControls m_saControls;
 
@@ -70,7 +68,6 @@ private:
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
 	float m_buffer[FFT_BUFFER_SIZE*2];
-	int m_framesFilledUp;
 
 	float m_bands[MAX_BANDS];
 	float m_energy;
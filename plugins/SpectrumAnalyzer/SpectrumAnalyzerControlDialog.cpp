@@ -185,7 +185,10 @@ void SpectrumAnalyzerControlDialog::setVisible(bool _b)
 {
 	EffectControlDialog::setVisible(_b);
 	if( m_controls->m_effect )
+	{
 		m_controls->m_effect->setDontRun(!_b);
+		m_controls->m_effect->setActive(_b);
+	}
 }
 
 void SpectrumAnalyzerControlDialog::paintEvent( QPaintEvent * )
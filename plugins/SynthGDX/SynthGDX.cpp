@@ -1091,6 +1091,12 @@ void SynthGDX::loadSettings(const QDomElement& _this)
         m_osc[i]->m_lfoEnabledModel.loadSettings(_this, "lfo_enabled" + is);
         m_osc[i]->m_lfoTimeModel.loadSettings(_this, "lfo_time" + is);
         m_osc[i]->m_portamentoModel.loadSettings(_this, "portamento" + is);
+
+        // build file-backed waves before the first note needs them
+        WaveForm::prewarm(m_osc[i]->m_wave1BankModel.value(),
+                          m_osc[i]->m_wave1IndexModel.value());
+        WaveForm::prewarm(m_osc[i]->m_wave2BankModel.value(),
+                          m_osc[i]->m_wave2IndexModel.value());
     }
 
     for(int i = 0; i < NB_MODULATORS; ++i)
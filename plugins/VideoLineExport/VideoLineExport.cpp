@@ -28,12 +28,17 @@
 #include <QFile>
 #include <QIODevice>
 #include <QApplication>
+#include <QBuffer>
+#include <QFontDatabase>
 #include <QImage>
 #include <QMessageBox>
 #include <QPainter>
 #include <QProcess>
 #include <QProgressDialog>
 #include <QRegExp>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtConcurrent>
 
 #include "VideoLineExport.h"
 
@@ -60,7 +65,7 @@ Plugin::Descriptor PLUGIN_EXPORT videolineexport_plugin_descriptor =
 	"Video Line Export",
 	QT_TRANSLATE_NOOP( "pluginBrowser",
                            "Filter for exporting M-JPEG Video lines. "
-                           "72x40@15fps. 10 minutes max."),
+                           "72x40@15fps."),
 	"gi0e5b06",
 	0x0100,
 	Plugin::ExportFilter,
@@ -84,23 +89,136 @@ VideoLineExport::~VideoLineExport()
 }
 
 
-int VideoLineExport::posToImg(int tempo,int pos) // 1s=1:3:8=2*48+8
+int VideoLineExport::posToImg(int tempo,int pos) const // 1s=1:3:8=2*48+8
 {
         double ms=60000./tempo/48.*pos;
-        int i=qRound(15./1000.*ms);
+        int i=qRound(FPS/1000.*ms);
         //qInfo("PosToImg p=%d -> i=%d",pos,i);
         return i;
 }
 
 
-int VideoLineExport::imgToPos(int tempo,int img)
+int VideoLineExport::imgToPos(int tempo,int img) const
 {
-        double ms=1000./15.*img;
+        double ms=1000./FPS*img;
         int p=qRound(ms*tempo*48./60000.);
         //qInfo("ImgToPos i=%d -> p=%d",img,p);
         return p;
 }
 
+
+QImage VideoLineExport::frame(int i) const
+{
+        QImage img(WI,HI,QImage::Format_ARGB32);
+        img.fill(m_background[i]);
+
+        QPainter p(&img);
+
+        for(int l=0;l<m_loops.size();l++)
+        {
+                if(i<m_loops[l].first || i>m_loops[l].last) continue;
+
+                p.fillRect(WI-13,HI-16,11,14,QColor(255,0,0,160));
+                p.setPen(QColor(0,0,0,255));
+                p.setFont(QFont("monospace",13));
+                p.drawText(WI-13,HI-3,QChar('A'+l));
+                p.drawText(WI-12,HI-3,QChar('A'+l));
+        }
+
+        for(const Segment& s : m_segments)
+        {
+                int r=s.first;
+                int u=s.length;
+
+                if(i>=r && i<r+5) //tempo/10
+                {
+                        p.fillRect(0,0,WI,HI,s.color);
+                        p.setPen(Qt::black);
+                        p.setFont(QFont("monospace",18));
+                        p.drawText(5,HI-2,QString("%1").arg(s.track));
+                }
+
+                int k=i-r;
+                if(k>=-u-WI && k<u+WI)
+                {
+                        p.fillRect(10-k,s.track*3,u,2,s.color);
+                        p.fillRect(10-k+u-1,s.track*3,1,2,s.color);
+                }
+        }
+
+        p.setPen(QColor(0xFF,0xFF,0x00,0x99));
+        for(int k=-10;k<=WI+21;k++)
+        {
+                if(k+i<-10) continue;
+                int q=imgToPos(m_tempo,i+k);
+                if(q%192<7) p.drawLine(10+k,0,10+k,HI-1);
+                if(q%768<7) p.drawLine( 8+k,0, 8+k,HI-1);
+        }
+
+        int frm=i%FPS;
+        int msc=qRound(1000.*frm/FPS);
+        int sec=((i-frm)/FPS)%60;
+        int min=((i-frm)/FPS-sec)/60;
+
+        int q=imgToPos(m_tempo,i);
+        int bar=q/192;
+        int bet=(q-192*bar)/48;
+        int rem=q-192*bar-48*bet;
+
+        QString ti("#%1");
+        QString tt("%1:%2:%3");
+        QString tb("%1-%2-%3");
+        ti=ti.arg(i,7,10,QChar('0'));
+        tt=tt.arg(min,2,10,QChar('0')).arg(sec,2,10,QChar('0')).arg(msc,3,10,QChar('0'));
+        tb=tb.arg(bar+1,2,10,QChar('-')).arg(bet+1,2,10,QChar('-')).arg(rem,3,10,QChar('-'));
+        p.setPen(Qt::white);
+        p.setFont(QFont("monospace",6));
+        p.drawText(12, 8,ti);
+        p.drawText(14,15,tt);
+        p.drawText(14,22,tb);
+        p.drawLine(10,0,10,HI);
+        p.end();
+
+        return img;
+}
+
+
+QByteArray VideoLineExport::encodeFrame(int i,bool y4m) const
+{
+        const QImage img=frame(i);
+        QByteArray data;
+
+        if(!y4m)
+        {
+                QBuffer buf(&data);
+                buf.open(QIODevice::WriteOnly);
+                img.save(&buf,"PNG");
+                return data;
+        }
+
+        // YUV 4:4:4, BT.601 studio range
+        data.reserve(6+3*WI*HI);
+        data.append("FRAME\n");
+        QByteArray u(WI*HI,0);
+        QByteArray v(WI*HI,0);
+        for(int y=0;y<HI;y++)
+        {
+                const QRgb* line=reinterpret_cast<const QRgb*>(img.constScanLine(y));
+                for(int x=0;x<WI;x++)
+                {
+                        const int r=qRed(line[x]);
+                        const int g=qGreen(line[x]);
+                        const int b=qBlue(line[x]);
+                        data.append(char((( 66*r+129*g+ 25*b+128)>>8)+ 16));
+                        u[y*WI+x] =  char(((-38*r- 74*g+112*b+128)>>8)+128);
+                        v[y*WI+x] =  char(((112*r- 94*g- 18*b+128)>>8)+128);
+                }
+        }
+        data.append(u);
+        data.append(v);
+        return data;
+}
+
 /*
 bool VideoLineExport::tryExport(const TrackContainer::TrackList &tracks,
                                 const TrackContainer::TrackList &tracks_BB,
@@ -113,7 +231,7 @@ bool VideoLineExport::proceed(const QString& _fileName)
 {
         TrackContainer::TrackList tracks=Engine::getSong()->tracks();
         //TrackContainer::TrackList tracks_BB=Engine::getBBTrackContainer()->tracks();
-        int tempo=Engine::getSong()->getTempo();
+        m_tempo=Engine::getSong()->getTempo();
         //int masterPitch=Engine::getSong()->m_masterPitchModel.value();
         const TimeLineWidget* tl = gui->songEditor()->m_editor->timeLineWidget();
 
@@ -121,45 +239,19 @@ bool VideoLineExport::proceed(const QString& _fileName)
 	for (const Track* track : tracks) if (track->type() == Track::InstrumentTrack) nTracks++;
 	//for (const Track* track : tracks_BB) if (track->type() == Track::InstrumentTrack) nTracks++;
 
-        // mpg is a vector of jpeg images
-        const int WI=72;
-        const int HI=40;
-        QVector<QImage> mpg(600*15,QImage(WI,HI,QImage::Format_ARGB32));
-
-        int c=0x00;
-        int d=0x03;
-        for(int i=0; i<mpg.size(); i++)
-        {
-                int q=imgToPos(tempo,i);
-                if((q/768)%2==1) c=qMax(c,0x22);
-                     if(q%768<32) { c=0xFF; d=0x05; }
-                else if(q%192<32) { c=0xBF; d=0x05; }
-                //else if(q% 48<32) { c=0xBF; d=0x07; }
-                mpg[i].fill(QColor(c,c,qMin(0x7F,c),0xFF));
-                c=qMax(0x00,c-d);
-        }
-
+        // only the layout is collected here, the frames are drawn and
+        // encoded batch after batch while streaming them out
+        m_loops.clear();
         for(int l=0;l<tl->NB_LOOPS;l++)
         {
-                int first =posToImg(tempo,tl->loopBegin(l));
-                int second=posToImg(tempo,tl->loopEnd(l));
-                for(int i=first;i<=second;i++)
-                {
-                        QImage& img=mpg[i];
-
-                        QPainter p(&img);
-                        p.fillRect(WI-13,HI-16,11,14,QColor(255,0,0,160));
-                        p.setPen(QColor(0,0,0,255));
-                        p.setFont(QFont("monospace",13));
-                        p.drawText(WI-13,HI-3,QChar('A'+l));
-                        p.drawText(WI-12,HI-3,QChar('A'+l));
-                        p.end();
-                }
+                Loop loop;
+                loop.first=posToImg(m_tempo,tl->loopBegin(l));
+                loop.last =posToImg(m_tempo,tl->loopEnd(l));
+                m_loops.append(loop);
         }
 
-
         int rmax=0;
-	// mpg tracks
+        m_segments.clear();
         int tn=0;
 	for (Track* track : tracks)
 	{
@@ -214,132 +306,118 @@ bool VideoLineExport::proceed(const QString& _fileName)
                                 if(base_time<0) continue;
                                 if(base_len<0) base_len=0;
 
-                                int r=posToImg(tempo,base_time);
-                                int u=posToImg(tempo,base_time+base_len)-r;
-                                if(r<0) r=0;
-                                if(r>=mpg.size()) r=mpg.size()-1;
-                                if(r+u>rmax) rmax=r+u;
-                                for(int k=0;k<5;k++) //tempo/10
-                                {
-                                        if(r+k>=mpg.size()) continue;
-                                        QImage& img=mpg[r+k];
-                                        QPainter p(&img);
-                                        p.fillRect(0,0,WI,HI,pc);
-                                        p.setPen(Qt::black);
-                                        p.setFont(QFont("monospace",18));
-                                        p.drawText(5,HI-2,QString("%1").arg(tn));
-                                        p.end();
-                                }
-                                for(int k=-u-WI;k<u+WI;k++)
-                                {
-                                        if(r+k<0) continue;
-                                        if(r+k>=mpg.size()) continue;
-                                        QImage& img=mpg[r+k];
-                                        QPainter p(&img);
-                                        p.fillRect(10-k,tn*3,u,2,pc);
-                                        p.fillRect(10-k+u-1,tn*3,1,2,pc);
-                                        //p.setPen(Qt::black);
-                                        //p.setFont(QFont("monospace",18));
-                                        //p.drawText(5,HI-2,QString("%1").arg(tn));
-                                        p.end();
-                                }
+                                Segment s;
+                                s.track=tn;
+                                s.color=pc;
+                                s.first=posToImg(m_tempo,base_time);
+                                s.length=posToImg(m_tempo,base_time+base_len)-s.first;
+                                if(s.first<0) s.first=0;
+                                if(s.first+s.length>rmax) rmax=s.first+s.length;
+                                m_segments.append(s);
                         }
-			//ProcessBBNotes(pat, INT_MAX);
-			//writePatternToTrack(mtrack, pat);
-			//size = mtrack.writeToBuffer(buffer);
-			//mpgout.writeRawData((char *)buffer, size);
 		}
 	} // for each track
 
-        rmax+=posToImg(tempo,192);
-        if(rmax>=mpg.size()) rmax=mpg.size()-1;
-        mpg=mpg.mid(0,rmax+1);
+        rmax+=posToImg(m_tempo,192);
 
-        int fps=15;
-        for(int i=0;i<=rmax;i++)
+        // the background fades out after bars and beats, so it depends
+        // on the previous frames
+        m_background.resize(rmax+1);
+        int c=0x00;
+        int d=0x03;
+        for(int i=0; i<=rmax; i++)
         {
-                QImage& img=mpg[i];
-
-                QPainter p(&img);
-                p.setPen(QColor(0xFF,0xFF,0x00,0x99));
-                for(int k=-10;k<=WI+21;k++)
-                {
-                        if(k+i<-10) continue;
-                        int q=imgToPos(tempo,i+k);
-                        if(i==0) qInfo("i=0  k=%d q=%d",k,q);
-                        if(q%192<7) p.drawLine(10+k,0,10+k,HI-1);
-                        if(q%768<7) p.drawLine( 8+k,0, 8+k,HI-1);
-                }
-
-                int frm=i%fps;
-                int msc=qRound(1000.*(frm/15.));
-                int sec=((i-frm)/fps)%60;
-                int min=((i-frm)/fps-sec)/60;
-
-                int q=imgToPos(tempo,i);
-                int bar=q/192;
-                int bet=(q-192*bar)/48;
-                int rem=q-192*bar-48*bet;
-
-                QString ti("#%1");
-                QString tt("%1:%2:%3");
-                QString tb("%1-%2-%3");
-                ti=ti.arg(i,7,10,QChar('0'));
-                tt=tt.arg(min,2,10,QChar('0')).arg(sec,2,10,QChar('0')).arg(msc,3,10,QChar('0'));
-                tb=tb.arg(bar+1,2,10,QChar('-')).arg(bet+1,2,10,QChar('-')).arg(rem,3,10,QChar('-'));
-                p.setPen(Qt::white);
-                p.setFont(QFont("monospace",6));
-                p.drawText(12, 8,ti);
-                p.drawText(14,15,tt);
-                p.drawText(14,22,tb);
-                p.drawLine(10,0,10,HI);
-                p.end();
+                int q=imgToPos(m_tempo,i);
+                if((q/768)%2==1) c=qMax(c,0x22);
+                     if(q%768<32) { c=0xFF; d=0x05; }
+                else if(q%192<32) { c=0xBF; d=0x05; }
+                //else if(q% 48<32) { c=0xBF; d=0x07; }
+                m_background[i]=qRgba(c,c,qMin(0x7F,c),0xFF);
+                c=qMax(0x00,c-d);
         }
 
         qWarning("Images: %d",rmax);
-        qWarning("Time: %d:%d:%d",(rmax/fps/60),(rmax/fps)%60,rmax%fps);
-        qWarning("Exporting: ffmpeg");
+        qWarning("Time: %d:%d:%d",(rmax/FPS/60),(rmax/FPS)%60,rmax%FPS);
 
-        QStringList args;
-        args << "-y" << "-loglevel" << "quiet";
+        // without an encoder the frames go to a YUV4MPEG2 file which
+        // ffmpeg or any other encoder can pick up later
+        QProcess ffmpeg;
+        QFile raw;
+        QIODevice* out=&ffmpeg;
+        bool y4m=true;
+
+        const QString encoder=QStandardPaths::findExecutable("ffmpeg");
+        if(!encoder.isEmpty())
+        {
+                qWarning("Exporting: ffmpeg");
 
-        //QFile audio(QString(filename).replace(QRegExp("[.][a-zA-Z0-9]+$"),".wav"));
-        //if(audio.exists()) args << "-acodec" << "wav" << "-i" << audio.fileName();
+                QStringList args;
+                args << "-y" << "-loglevel" << "quiet";
 
-        args << "-framerate" << "15" //QString("%1").arg(tempo/10)
-             << "-f" << "image2pipe" << "-vcodec" << "png" << "-i" << "-";
+                //QFile audio(QString(filename).replace(QRegExp("[.][a-zA-Z0-9]+$"),".wav"));
+                //if(audio.exists()) args << "-acodec" << "wav" << "-i" << audio.fileName();
 
-        args << "-acodec" << "libmp3lame" << "-vcodec" << "libx264" << _fileName;
+                args << "-framerate" << QString::number(FPS)
+                     << "-f" << "image2pipe" << "-vcodec" << "png" << "-i" << "-";
 
-        //cat *.jpg | ffmpeg -f image2pipe -r 1 -vcodec mjpeg -i - -vcodec libx264 out.mp4
+                args << "-acodec" << "libmp3lame" << "-vcodec" << "libx264" << _fileName;
 
-        QProcess& ffmpeg=*new QProcess();
-        //ffmpeg.setProcessChannelMode(QProcess::ForwardedChannels);
+                ffmpeg.start(encoder,args);
+                y4m=!ffmpeg.waitForStarted();
+        }
+
+        if(y4m)
+        {
+                raw.setFileName(QString(_fileName).replace(QRegExp("[.][a-zA-Z0-9]+$"),"")+".y4m");
+                qWarning("Exporting: %s",qPrintable(raw.fileName()));
+                if(!raw.open(QIODevice::WriteOnly|QIODevice::Truncate)) return false;
+                raw.write(QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C444\n")
+                          .arg(WI).arg(HI).arg(FPS).toLatin1());
+                out=&raw;
+        }
 
-        qInfo("QProcess ffmpeg: start");
-        ffmpeg.start("/usr/bin/ffmpeg",args);
-        if(!ffmpeg.waitForStarted()) return false;
+        // frames are drawn and encoded in parallel, one batch at a time
+        // and in time order, so memory doesn't grow with the song length
+        const bool threaded=QFontDatabase::supportsThreadedFontRendering();
+        const int batchSize=qMax(1,QThread::idealThreadCount())*4;
+        FrameEncoder encode;
+        encode.exporter=this;
+        encode.y4m=y4m;
 
-        qInfo("QProcess ffmpeg: image loop");
-	for(int i=0;i<=rmax;i++)
+        for(int first=0;first<=rmax;first+=batchSize)
         {
-                mpg[i].save(&ffmpeg,"PNG");
+                QVector<int> batch;
+                for(int i=first;i<=rmax && i<first+batchSize;i++)
+                        batch.append(i);
+
+                QVector<QByteArray> frames;
+                if(threaded)
+                        frames=QtConcurrent::blockingMapped<QVector<QByteArray> >(batch,encode);
+                else
+                        for(int i : batch) frames.append(encode(i));
+
+                for(const QByteArray& f : frames)
+                        out->write(f);
+
+                // let the encoder catch up instead of buffering the song
+                while(out==&ffmpeg && ffmpeg.bytesToWrite()>0)
+                        if(!ffmpeg.waitForBytesWritten(-1)) return false;
         }
 
+        m_segments.clear();
+        m_background.clear();
+
+        if(y4m)
+        {
+                raw.close();
+                return raw.error()==QFile::NoError;
+        }
 
         qInfo("QProcess ffmpeg: close");
         ffmpeg.closeWriteChannel();
-        //qWarning("%s",qPrintable(QString(ffmpeg.readAll())));
-        //ffmpeg.closeReadChannel(QProcess::StandardOutput);
-        //ffmpeg.closeReadChannel(QProcess::StandardError);
-
-        //qInfo("QProcess ffmpeg: wait");
-        //if(!ffmpeg.waitForFinished(-1)) return false;
+        if(!ffmpeg.waitForFinished(-1)) return false;
 
         qInfo("QProcess ffmpeg: end");
-        //QByteArray result=
-        //ffmpeg.readAll();
-
         //cat tuf_*.png | ffmpeg -framerate 24 -f image2pipe -i - ./output.mp4
 
 	return true;
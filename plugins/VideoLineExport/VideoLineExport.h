@@ -26,10 +26,14 @@
 #ifndef _VIDEO_LINE_EXPORT_H
 #define _VIDEO_LINE_EXPORT_H
 
+#include <QColor>
 #include <QString>
+#include <QVector>
 
 #include "ExportFilter.h"
 
+class QImage;
+
 
 /*
 const int BUFFER_SIZE = 50*1024;
@@ -84,10 +88,50 @@ private:
 	void ProcessBBNotes(VideoLineNoteVector &nv, int cutPos);
         */
 
-        int posToImg(int tempo,int pos);
-        int imgToPos(int tempo,int img);
+        static const int WI=72;
+        static const int HI=40;
+        static const int FPS=15;
+
+        // what a pattern looks like in the frames
+        struct Segment
+        {
+                int track;
+                QColor color;
+                int first;  // frame
+                int length; // frames
+        } ;
+
+        struct Loop
+        {
+                int first;
+                int last;
+        } ;
+
+        // called on worker threads for each frame
+        struct FrameEncoder
+        {
+                typedef QByteArray result_type;
+
+                const VideoLineExport* exporter;
+                bool y4m;
+
+                QByteArray operator()(int i) const
+                {
+                        return exporter->encodeFrame(i,y4m);
+                }
+        } ;
+
+        int posToImg(int tempo,int pos) const;
+        int imgToPos(int tempo,int img) const;
+        QImage frame(int i) const;
+        QByteArray encodeFrame(int i,bool y4m) const;
 	void error();
 
+        int m_tempo;
+        QVector<Segment> m_segments;
+        QVector<Loop> m_loops;
+        QVector<QRgb> m_background;
+
 
 } ;
 
@@ -156,7 +156,7 @@ void audioFileProcessor::playNote( NotePlayHandle * _n,
 				srcmode = SRC_SINC_MEDIUM_QUALITY;
 				break;
 		}
-		_n->m_pluginData = new handleState( _n->hasDetuningInfo(), srcmode );
+		_n->m_pluginData = m_voices.acquire( _n->hasDetuningInfo(), srcmode );
 		((handleState *)_n->m_pluginData)->setFrameIndex( m_nextPlayStartPoint );
 		((handleState *)_n->m_pluginData)->setBackwards( m_nextPlayBackwards );
 
@@ -201,7 +201,7 @@ void audioFileProcessor::playNote( NotePlayHandle * _n,
 
 void audioFileProcessor::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete (handleState *)_n->m_pluginData;
+	m_voices.release( (handleState *)_n->m_pluginData );
 }
 
 
@@ -213,9 +213,7 @@ void audioFileProcessor::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "src", m_sampleBuffer.audioFile() );
 	if( m_sampleBuffer.audioFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "sampledata",
-						m_sampleBuffer.toBase64( s ) );
+		m_sampleBuffer.saveData( _doc, _this, "sampledata" );
 	}
 	m_reverseModel.saveSettings( _doc, _this, "reversed" );
 	m_loopModel.saveSettings( _doc, _this, "looped" );
@@ -245,9 +243,9 @@ void audioFileProcessor::loadSettings( const QDomElement & _this )
 			Engine::getSong()->collectError( message );
 		}
 	}
-	else if( _this.attribute( "sampledata" ) != "" )
+	else
 	{
-		m_sampleBuffer.loadFromBase64( _this.attribute( "srcdata" ) );
+		m_sampleBuffer.loadData( _this, "sampledata" );
 	}
 
 	m_loopModel.loadSettings( _this, "looped" );
@@ -102,6 +102,8 @@ private:
 	f_cnt_t m_nextPlayStartPoint;
 	bool m_nextPlayBackwards;
 
+	VoicePool<handleState> m_voices;
+
 	friend class AudioFileProcessorView;
 
 } ;
@@ -274,7 +274,7 @@ void bitInvader::playNote( NotePlayHandle * _n,
 			factor = m_normalizeFactor;
 		}
 
-		_n->m_pluginData = new bSynth(
+		_n->m_pluginData = m_voices.acquire(
 					const_cast<float*>( m_graph.samples() ),
 					m_graph.length(),
 					_n,
@@ -305,7 +305,7 @@ void bitInvader::playNote( NotePlayHandle * _n,
 
 void bitInvader::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<bSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<bSynth *>( _n->m_pluginData ) );
 }
 
 
@@ -102,6 +102,8 @@ private:
 	BoolModel m_normalize;
 	
 	float m_normalizeFactor;
+
+	VoicePool<bSynth> m_voices;
 	
 	friend class bitInvaderView;
 } ;
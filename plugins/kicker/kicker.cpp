@@ -33,7 +33,6 @@
 #include "Knob.h"
 #include "Mixer.h"
 #include "NotePlayHandle.h"
-#include "KickerOsc.h"
 
 #include "embed.h"
 
@@ -157,10 +156,6 @@ QString kickerInstrument::nodeName() const
 
 
 
-typedef DspEffectLibrary::Distortion DistFX;
-typedef KickerOsc<DspEffectLibrary::MonoToStereoAdaptor<DistFX> > SweepOsc;
-
-
 void kickerInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
@@ -176,7 +171,7 @@ void kickerInstrument::playNote( NotePlayHandle * _n,
         else
         if(tfp==0)   //||!_n->m_pluginData)
 	{
-		_n->m_pluginData=new SweepOsc
+		_n->m_pluginData=m_voices.acquire
                         (DistFX( m_distModel.value(), m_gainModel.value() ),
                          m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value(),
                          m_endNoteModel.value() ? _n->frequency() : m_endFreqModel.value(),
@@ -221,7 +216,7 @@ void kickerInstrument::deleteNotePluginData( NotePlayHandle* _n )
 	SweepOsc* so=static_cast<SweepOsc*>(_n->m_pluginData);
         if(so)
         {
-                delete so;
+                m_voices.release(so);
                 _n->m_pluginData=NULL;
         }
 }
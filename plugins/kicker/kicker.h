@@ -30,6 +30,7 @@
 #include <QObject>
 #include "Instrument.h"
 #include "InstrumentView.h"
+#include "KickerOsc.h"
 #include "Knob.h"
 #include "LedCheckBox.h"
 #include "TempoSyncKnob.h"
@@ -42,6 +43,10 @@ class kickerInstrumentView;
 class NotePlayHandle;
 
 
+typedef DspEffectLibrary::Distortion DistFX;
+typedef KickerOsc<DspEffectLibrary::MonoToStereoAdaptor<DistFX> > SweepOsc;
+
+
 class kickerInstrument : public Instrument
 {
 	Q_OBJECT
@@ -88,6 +93,8 @@ private:
 
 	IntModel m_versionModel;
 
+	VoicePool<SweepOsc> m_voices;
+
 	friend class kickerInstrumentView;
 
 } ;
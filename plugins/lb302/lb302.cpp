@@ -113,8 +113,8 @@ void lb302Filter::recalc()
 {
 	vcf_e1 = exp(6.109 + 1.5876*(fs->envmod) + 2.1553*(fs->cutoff) - 1.2*(1.0-(fs->reso)));
 	vcf_e0 = exp(5.613 - 0.8*(fs->envmod) + 2.1553*(fs->cutoff) - 0.7696*(1.0-(fs->reso)));
-	vcf_e0*=M_PI/Engine::mixer()->processingSampleRate();
-	vcf_e1*=M_PI/Engine::mixer()->processingSampleRate();
+	vcf_e0*=M_PI/fs->sampleRate;
+	vcf_e1*=M_PI/fs->sampleRate;
 	vcf_e1 -= vcf_e0;
 
 	vcf_rescoeff = exp(-1.20 + 3.455*(fs->reso));
@@ -230,14 +230,14 @@ void lb302Filter3Pole::envRecalc()
 	w = vcf_e0 + vcf_c0;
 	k = (fs->cutoff > 0.975)?0.975:fs->cutoff;
 	kfco = 50.f + (k)*((2300.f-1600.f*(fs->envmod))+(w) *
-	                   (700.f+1500.f*(k)+(1500.f+(k)*(Engine::mixer()->processingSampleRate()/2.f-6000.f)) *
+	                   (700.f+1500.f*(k)+(1500.f+(k)*(fs->sampleRate/2.f-6000.f)) *
 	                   (fs->envmod)) );
 	//+iacc*(.3+.7*kfco*kenvmod)*kaccent*kaccurve*2000
 
 
 #ifdef LB_24_IGNORE_ENVELOPE
 	// kfcn = fs->cutoff;
-	kfcn = 2.0 * kfco / Engine::mixer()->processingSampleRate();
+	kfcn = 2.0 * kfco / fs->sampleRate;
 #else
 	kfcn = w;
 #endif
@@ -289,7 +289,8 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	vca_decay(0.99897516),
 	vca_a0(0.5),
 	vca_a(0.),
-	vca_mode(never_played)
+	vca_mode(never_played),
+	m_oversampler( Engine::mixer()->currentQualitySettings().sampleRateMultiplier() )
 {
 
 	connect( Engine::mixer(), SIGNAL( sampleRateChanged( ) ),
@@ -328,6 +329,7 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	fs.reso = 0;
 	fs.envdecay = 0;
 	fs.dist = 0;
+	fs.sampleRate = sampleRate();
 
 	vcf_envpos = ENVINC;
 
@@ -405,10 +407,11 @@ void lb302Synth::filterChanged()
 	fs.reso   = vcf_res_knob.value();
 	fs.envmod = vcf_mod_knob.value();
 	fs.dist   = LB_DIST_RATIO*dist_knob.value();
+	fs.sampleRate = sampleRate();
 
 	float d = 0.2 + (2.3*vcf_dec_knob.value());
 
-	d *= Engine::mixer()->processingSampleRate();                                // d *= smpl rate
+	d *= fs.sampleRate;                                // d *= smpl rate
 	fs.envdecay = pow(0.1, 1.0/d * ENVINC);    // decay is 0.1 to the 1/d * ENVINC
 	                                           // vcf_envdecay is now adjusted for both
 	                                           // sampling rate and ENVINC
@@ -453,13 +456,22 @@ void lb302Synth::recalcFilter()
 	vcf_envpos = ENVINC; // Trigger filter update in process()
 }
 
-inline float GET_INC(float freq) {
-	return freq/Engine::mixer()->processingSampleRate();  // TODO: Use actual sampling rate.
+inline float GET_INC(float freq, float sampleRate) {
+	return freq/sampleRate;
+}
+
+float lb302Synth::sampleRate() const
+{
+	return Engine::mixer()->processingSampleRate() * m_oversampler.factor();
 }
 
 int lb302Synth::process(sampleFrame *outbuf, const int size)
 {
-	const float sampleRatio = 44100.f / Engine::mixer()->processingSampleRate();
+	const int factor = m_oversampler.factor();
+	const float sampleRatio = 44100.f / fs.sampleRate;
+	// tuned per sample at the mixer rate
+	const float attack = 1.0f - powf(1.0f - vca_attack, 1.0f / factor);
+	const float decayCoeff = powf(vca_decay, 1.0f / factor);
 	float w;
 	float samp;
 
@@ -479,7 +491,7 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 	{
 		//printf("  playing new note..\n");
 		lb302Note note;
-		note.vco_inc = GET_INC( true_freq );
+		note.vco_inc = GET_INC( true_freq, fs.sampleRate );
 		note.dead = deadToggle.value();
 		initNote(&note);
 
@@ -494,7 +506,7 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 	for( int i=0; i<size; i++ ) 
 	{
 		// start decay if we're past release
-		if( i >= release_frame )
+		if( i >= release_frame * factor )
 		{
 			vca_mode = decay;
 		}
@@ -637,12 +649,12 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 
 		// Handle Envelope
 		if(vca_mode==attack) {
-			vca_a+=(vca_a0-vca_a)*vca_attack;
-			if(sample_cnt>=0.5*Engine::mixer()->processingSampleRate())
+			vca_a+=(vca_a0-vca_a)*attack;
+			if(sample_cnt>=0.5*fs.sampleRate)
 				vca_mode = idle;
 		}
 		else if(vca_mode == decay) {
-			vca_a *= vca_decay;
+			vca_a *= decayCoeff;
 
 			// the following line actually speeds up processing
 			if(vca_a < (1/65536.0)) {
@@ -761,7 +773,7 @@ void lb302Synth::processNote( NotePlayHandle * _n )
 			m_playingNote = _n;
 			if ( slideToggle.value() ) 
 			{
-				vco_slideinc = GET_INC( _n->frequency() );
+				vco_slideinc = GET_INC( _n->frequency(), fs.sampleRate );
 			}
 		}
 
@@ -771,10 +783,10 @@ void lb302Synth::processNote( NotePlayHandle * _n )
 			true_freq = _n->frequency();
 
 			if( slideToggle.value() ) {
-				vco_slidebase = GET_INC( true_freq );			// The REAL frequency
+				vco_slidebase = GET_INC( true_freq, fs.sampleRate );			// The REAL frequency
 			}
 			else {
-				vco_inc = GET_INC( true_freq );
+				vco_inc = GET_INC( true_freq, fs.sampleRate );
 			}
 		}
 }
@@ -783,6 +795,14 @@ void lb302Synth::processNote( NotePlayHandle * _n )
 
 void lb302Synth::play( sampleFrame * _working_buffer )
 {
+	const int factor = Engine::mixer()->currentQualitySettings().
+							sampleRateMultiplier();
+	if( factor != m_oversampler.factor() )
+	{
+		m_oversampler.setFactor( factor );
+		filterChanged();
+	}
+
 	m_notesMutex.lock();
 	while( ! m_notes.isEmpty() )
 	{
@@ -792,7 +812,8 @@ void lb302Synth::play( sampleFrame * _working_buffer )
 	
 	const fpp_t frames = Engine::mixer()->framesPerPeriod();
 
-	process( _working_buffer, frames );
+	process( m_oversampler.buffer(), frames * m_oversampler.factor() );
+	m_oversampler.down( _working_buffer, frames );
 	instrumentTrack()->processAudioBuffer( _working_buffer, frames, NULL );
 //	release_frame = 0; //removed for issue # 1432
 }
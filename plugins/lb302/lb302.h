@@ -38,6 +38,7 @@
 #include "LedCheckBox.h"
 #include "Knob.h"
 #include "NotePlayHandle.h"
+#include "Oversampler.h"
 #include <QMutex>
 
 static const int NUM_FILTERS = 2;
@@ -53,6 +54,7 @@ class lb302FilterKnobState
 	float envmod;
 	float envdecay;
 	float dist;
+	float sampleRate;	// the voice runs oversampled
 };
 
 
@@ -248,11 +250,17 @@ private:
 
 	int process(sampleFrame *outbuf, const int size);
 
+	// rate of the voice, the distortion of the filter would alias at
+	// the rate of the mixer
+	float sampleRate() const;
+
 	friend class lb302SynthView;
 
 	NotePlayHandle * m_playingNote;
 	NotePlayHandleList m_notes;
 	QMutex m_notesMutex;
+
+	Oversampler m_oversampler;
 } ;
 
 
@@ -1037,7 +1037,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		_n->m_pluginData = new MonstroSynth( this, _n );
+		_n->m_pluginData = m_voices.acquire( this, _n );
 	}
 
 	MonstroSynth * ms = static_cast<MonstroSynth *>( _n->m_pluginData );
@@ -1051,7 +1051,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 void MonstroInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<MonstroSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<MonstroSynth *>( _n->m_pluginData ) );
 }
 
 
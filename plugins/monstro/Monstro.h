@@ -559,6 +559,8 @@ private:
 	FloatModel	m_sub3lfo1;
 	FloatModel	m_sub3lfo2;
 
+	VoicePool<MonstroSynth> m_voices;
+
 	friend class MonstroSynth;
 	friend class MonstroView;
 
@@ -236,7 +236,7 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 		Oscillator * oscs_l[m_numOscillators];
 		Oscillator * oscs_r[m_numOscillators];
 
-		_n->m_pluginData = new oscPtr;
+		_n->m_pluginData = m_voices.acquire();
 
 		for( int i = m_numOscillators - 1; i >= 0; --i )
 		{
@@ -330,7 +330,7 @@ void organicInstrument::deleteNotePluginData( NotePlayHandle * _n )
 	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
 						_n->m_pluginData )->oscRight );
 	
-	delete static_cast<oscPtr *>( _n->m_pluginData );
+	m_voices.release( static_cast<oscPtr *>( _n->m_pluginData ) );
 }
 
 /*float inline organicInstrument::foldback(float in, float threshold)
@@ -158,6 +158,8 @@ private:
 		float phaseOffsetRight[NUM_OSCILLATORS];		
 	} ;
 
+	VoicePool<oscPtr> m_voices;
+
 	const IntModel m_modulationAlgo;
 
 	FloatModel  m_fx1Model;
@@ -217,6 +217,8 @@ private:
 
 	IntModel m_waveFormModel;
 
+	VoicePool<SfxrSynth> m_voices;
+
 	friend class sfxrInstrumentView;
 	friend class SfxrSynth;
 };
@@ -19,6 +19,8 @@
 
 #include "sid.h"
 #include <math.h>
+#include <mutex>
+#include <vector>
 
 
 const int cSID::FIR_N = 125;
@@ -32,6 +34,44 @@ const int cSID::FIXP_SHIFT = 16;
 const int cSID::FIXP_MASK = 0xffff;
 
 
+// ----------------------------------------------------------------------------
+// FIR tables calculated by prepare_fir(). A table only depends on the
+// sampling parameters and takes tens of thousands of Bessel function
+// evaluations, so it is calculated once and kept for all chips and notes.
+// ----------------------------------------------------------------------------
+struct FirTable
+{
+  double clock_freq;
+  double sample_freq;
+  double pass_freq;
+  double filter_scale;
+  sampling_method method;
+  int fir_N;
+  int fir_RES;
+  short* fir;
+};
+
+static std::vector<FirTable> fir_tables;
+static std::mutex fir_tables_mutex;
+
+// The table for the given parameters, 0 if there is none yet. Must be
+// called with fir_tables_mutex held.
+static const FirTable* find_fir_table(double clock_freq, sampling_method method,
+				      double sample_freq, double pass_freq,
+				      double filter_scale)
+{
+  for (size_t t = 0; t < fir_tables.size(); t++) {
+    const FirTable& table = fir_tables[t];
+    if (table.clock_freq == clock_freq && table.sample_freq == sample_freq &&
+        table.pass_freq == pass_freq && table.filter_scale == filter_scale &&
+        table.method == method) {
+      return &table;
+    }
+  }
+  return 0;
+}
+
+
 // ----------------------------------------------------------------------------
 // Constructor.
 // ----------------------------------------------------------------------------
@@ -60,7 +100,6 @@ cSID::cSID()
 cSID::~cSID()
 {
   delete[] sample;
-  delete[] fir;
 }
 
 
@@ -444,37 +483,29 @@ double cSID::I0(double x)
 // E.g. for a 44.1kHz sampling rate the end of passband frequency is limited
 // to slightly below 20kHz. This constraint ensures that the FIR table is
 // not overfilled.
+//
+// For resampling the FIR table has to be calculated by prepare_fir() with
+// the same parameters beforehand, false is returned otherwise.
 // ----------------------------------------------------------------------------
 bool cSID::set_sampling_parameters(double clock_freq, sampling_method method,
 				  double sample_freq, double pass_freq,
 				  double filter_scale)
 {
-  // Check resampling constraints.
+  FirTable table = FirTable();
+
   if (method == SAMPLE_RESAMPLE_INTERPOLATE || method == SAMPLE_RESAMPLE_FAST)
   {
-    // Check whether the sample ring buffer would overfill.
-    if (FIR_N*clock_freq/sample_freq >= RINGSIZE) {
+    if (!check_resampling(clock_freq, sample_freq, pass_freq, filter_scale)) {
       return false;
     }
 
-    // The default passband limit is 0.9*sample_freq/2 for sample
-    // frequencies below ~ 44.1kHz, and 20kHz for higher sample frequencies.
-    if (pass_freq < 0) {
-      pass_freq = 20000;
-      if (2*pass_freq/sample_freq >= 0.9) {
-	pass_freq = 0.9*sample_freq/2;
-      }
-    }
-    // Check whether the FIR table would overfill.
-    else if (pass_freq > 0.9*sample_freq/2) {
-      return false;
-    }
-
-    // The filter scaling is only included to avoid clipping, so keep
-    // it sane.
-    if (filter_scale < 0.9 || filter_scale > 1.0) {
+    std::lock_guard<std::mutex> lock(fir_tables_mutex);
+    const FirTable* found = find_fir_table(clock_freq, method, sample_freq,
+					   pass_freq, filter_scale);
+    if (!found) {
       return false;
     }
+    table = *found;
   }
 
   clock_frequency = clock_freq;
@@ -490,12 +521,90 @@ bool cSID::set_sampling_parameters(double clock_freq, sampling_method method,
   if (method != SAMPLE_RESAMPLE_INTERPOLATE && method != SAMPLE_RESAMPLE_FAST)
   {
     delete[] sample;
-    delete[] fir;
     sample = 0;
     fir = 0;
     return true;
   }
 
+  fir_N = table.fir_N;
+  fir_RES = table.fir_RES;
+  fir = table.fir;
+
+  // Allocate sample buffer.
+  if (!sample) {
+    sample = new short[RINGSIZE*2];
+  }
+  // Clear sample buffer.
+  for (int j = 0; j < RINGSIZE*2; j++) {
+    sample[j] = 0;
+  }
+  sample_index = 0;
+
+  return true;
+}
+
+
+// ----------------------------------------------------------------------------
+// Check of the resampling constraints of set_sampling_parameters(). A
+// negative pass_freq is replaced by the default end of passband frequency.
+// ----------------------------------------------------------------------------
+bool cSID::check_resampling(double clock_freq, double sample_freq,
+			    double& pass_freq, double filter_scale)
+{
+  // Check whether the sample ring buffer would overfill.
+  if (FIR_N*clock_freq/sample_freq >= RINGSIZE) {
+    return false;
+  }
+
+  // The default passband limit is 0.9*sample_freq/2 for sample
+  // frequencies below ~ 44.1kHz, and 20kHz for higher sample frequencies.
+  if (pass_freq < 0) {
+    pass_freq = 20000;
+    if (2*pass_freq/sample_freq >= 0.9) {
+      pass_freq = 0.9*sample_freq/2;
+    }
+  }
+  // Check whether the FIR table would overfill.
+  else if (pass_freq > 0.9*sample_freq/2) {
+    return false;
+  }
+
+  // The filter scaling is only included to avoid clipping, so keep
+  // it sane.
+  if (filter_scale < 0.9 || filter_scale > 1.0) {
+    return false;
+  }
+
+  return true;
+}
+
+
+// ----------------------------------------------------------------------------
+// Calculation of the FIR table for resampling with the given parameters.
+// The table is kept for all chips. This is slow, so it should be done when
+// the sampling parameters change and not in a render thread.
+// ----------------------------------------------------------------------------
+bool cSID::prepare_fir(double clock_freq, sampling_method method,
+		       double sample_freq, double pass_freq,
+		       double filter_scale)
+{
+  if (method != SAMPLE_RESAMPLE_INTERPOLATE && method != SAMPLE_RESAMPLE_FAST)
+  {
+    return true;
+  }
+
+  if (!check_resampling(clock_freq, sample_freq, pass_freq, filter_scale)) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(fir_tables_mutex);
+    if (find_fir_table(clock_freq, method, sample_freq, pass_freq,
+		       filter_scale)) {
+      return true;
+    }
+  }
+
   const double pi = 3.1415926535897932385;
 
   // 16 bits -> -96dB stopband attenuation.
@@ -523,7 +632,7 @@ bool cSID::set_sampling_parameters(double clock_freq, sampling_method method,
 
   // The filter length is equal to the filter order + 1.
   // The filter length must be an odd number (sinc is symmetric about x = 0).
-  fir_N = int(N*f_cycles_per_sample) + 1;
+  int fir_N = int(N*f_cycles_per_sample) + 1;
   fir_N |= 1;
 
   // We clamp the filter table resolution to 2^n, making the fixpoint
@@ -531,11 +640,10 @@ bool cSID::set_sampling_parameters(double clock_freq, sampling_method method,
   int res = method == SAMPLE_RESAMPLE_INTERPOLATE ?
     FIR_RES_INTERPOLATE : FIR_RES_FAST;
   int n = (int)ceil(log(res/f_cycles_per_sample)/log(2));
-  fir_RES = 1 << n;
+  int fir_RES = 1 << n;
 
   // Allocate memory for FIR tables.
-  delete[] fir;
-  fir = new short[fir_N*fir_RES];
+  short* fir = new short[fir_N*fir_RES];
 
   // Calculate fir_RES FIR tables for linear interpolation.
   for (int i = 0; i < fir_RES; i++) {
@@ -557,15 +665,17 @@ bool cSID::set_sampling_parameters(double clock_freq, sampling_method method,
     }
   }
 
-  // Allocate sample buffer.
-  if (!sample) {
-    sample = new short[RINGSIZE*2];
-  }
-  // Clear sample buffer.
-  for (int j = 0; j < RINGSIZE*2; j++) {
-    sample[j] = 0;
+  // The lock isn't held while calculating, another thread may have added
+  // the same table meanwhile.
+  std::lock_guard<std::mutex> lock(fir_tables_mutex);
+  if (find_fir_table(clock_freq, method, sample_freq, pass_freq,
+		     filter_scale)) {
+    delete[] fir;
+    return true;
   }
-  sample_index = 0;
+  FirTable table = { clock_freq, sample_freq, pass_freq, filter_scale,
+                     method, fir_N, fir_RES, fir };
+  fir_tables.push_back(table);
 
   return true;
 }
@@ -38,6 +38,9 @@ public:
   bool set_sampling_parameters(double clock_freq, sampling_method method,
 			       double sample_freq, double pass_freq = -1,
 			       double filter_scale = 0.97);
+  static bool prepare_fir(double clock_freq, sampling_method method,
+			  double sample_freq, double pass_freq = -1,
+			  double filter_scale = 0.97);
   void adjust_sampling_frequency(double sample_freq);
 
   void fc_default(const fc_point*& points, int& count);
@@ -87,6 +90,8 @@ public:
 
 protected:
   static double I0(double x);
+  static bool check_resampling(double clock_freq, double sample_freq,
+			       double& pass_freq, double filter_scale);
   RESID_INLINE int clock_fast(cycle_count& delta_t, short* buf, int n,
 			      int interleave);
   RESID_INLINE int clock_interpolate(cycle_count& delta_t, short* buf, int n,
@@ -139,7 +144,8 @@ protected:
   // Ring buffer with overflow for contiguous storage of RINGSIZE samples.
   short* sample;
 
-  // FIR_RES filter tables (FIR_N*FIR_RES).
+  // FIR_RES filter tables (FIR_N*FIR_RES), shared by all chips with the
+  // same sampling parameters.
   short* fir;
 };
 
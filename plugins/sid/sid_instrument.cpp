@@ -46,8 +46,6 @@
 #define C64_PAL_CYCLES_PER_SEC  985248
 
 #define NUMSIDREGS 0x19
-#define SIDWRITEDELAY 9 // lda $xxxx,x 4 cycles, sta $d400,x 5 cycles
-#define SIDWAVEDELAY 4 // and $xxxx,x 4 cycles extra
 
 unsigned char sidorder[] =
   {0x15,0x16,0x18,0x17,
@@ -118,6 +116,16 @@ voiceObject::~voiceObject()
 }
 
 
+// the chip of a note and what was last written to it
+struct sidVoice
+{
+	cSID sid;
+	unsigned char sidreg[NUMSIDREGS];
+} ;
+
+
+
+
 sidInstrument::sidInstrument( InstrumentTrack * _instrument_track ) :
 	Instrument( _instrument_track, &sid_plugin_descriptor ),
 	// filter	
@@ -128,12 +136,19 @@ sidInstrument::sidInstrument( InstrumentTrack * _instrument_track ) :
 	// misc
 	m_voice3OffModel( false, this, tr( "Voice 3 off" ) ),
 	m_volumeModel( 15.0f, 0.0f, 15.0f, 1.0f, this, tr( "Volume" ) ),
-	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) )
+	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) ),
+	m_voices( 32 )
 {
 	for( int i = 0; i < 3; ++i )
 	{
 		m_voice[i] = new voiceObject( this, i );
 	}
+
+	connect( Engine::mixer(), SIGNAL( sampleRateChanged() ),
+			this, SLOT( prepareSampling() ) );
+	connect( Engine::mixer(), SIGNAL( qualitySettingsChanged() ),
+			this, SLOT( prepareSampling() ) );
+	prepareSampling();
 }
 
 
@@ -246,70 +261,58 @@ f_cnt_t sidInstrument::desiredReleaseFrames() const
 
 
 
-static int sid_fillbuffer(unsigned char* sidreg, cSID *sid, int tdelta, short *ptr, int samples)
+// draft quality keeps SAMPLE_FAST. The resampling FIR of the best quality
+// is calculated by prepareSampling() and shared by all chips.
+static sampling_method samplingMethod()
 {
-  int tdelta2;
-  int result;
-  int total = 0;
-  int c;
-//  customly added
-  int residdelay = 0;
+	switch( Engine::mixer()->currentQualitySettings().interpolation )
+	{
+		case Mixer::qualitySettings::Interpolation_Linear:
+			return SAMPLE_FAST;
+		case Mixer::qualitySettings::Interpolation_SincFastest:
+		case Mixer::qualitySettings::Interpolation_SincMedium:
+			return SAMPLE_INTERPOLATE;
+		case Mixer::qualitySettings::Interpolation_SincBest:
+			return SAMPLE_RESAMPLE_INTERPOLATE;
+	}
+	return SAMPLE_FAST;
+}
 
-  int badline = rand() % NUMSIDREGS;
 
-  for (c = 0; c < NUMSIDREGS; c++)
-  {
-    unsigned char o = sidorder[c];
 
-  	// Extra delay for loading the waveform (and mt_chngate,x)
-  	if ((o == 4) || (o == 11) || (o == 18))
-  	{
-  	  tdelta2 = SIDWAVEDELAY;
-      result = sid->clock(tdelta2, ptr, samples);
-      total += result;
-      ptr += result;
-      samples -= result;
-      tdelta -= SIDWAVEDELAY;
-    }
 
-    // Possible random badline delay once per writing
-    if ((badline == c) && (residdelay))
-  	{
-      tdelta2 = residdelay;
-      result = sid->clock(tdelta2, ptr, samples);
-      total += result;
-      ptr += result;
-      samples -= result;
-      tdelta -= residdelay;
-    }
+// the mixer is stopped while its quality or sample rate changes, so the
+// slow FIR calculation happens here instead of in the first note
+void sidInstrument::prepareSampling()
+{
+	cSID::prepare_fir( C64_PAL_CYCLES_PER_SEC, samplingMethod(),
+				Engine::mixer()->processingSampleRate() );
+}
+
+
 
-    sid->write(o, sidreg[o]);
 
-    tdelta2 = SIDWRITEDELAY;
-    result = sid->clock(tdelta2, ptr, samples);
-    total += result;
-    ptr += result;
-    samples -= result;
-    tdelta -= SIDWRITEDELAY;
+// Writes the registers which changed since the last period at its
+// beginning, so the chip is clocked in one go. Per register writes
+// in player timing only moved them by a few hundred cycles.
+static int sid_fillbuffer(unsigned char* sidreg, sidVoice *voice, int tdelta, short *ptr, int samples)
+{
+  for (int c = 0; c < NUMSIDREGS; c++)
+  {
+    unsigned char o = sidorder[c];
+    if (sidreg[o] != voice->sidreg[o])
+    {
+      voice->sid.write(o, sidreg[o]);
+      voice->sidreg[o] = sidreg[o];
+    }
   }
 
-  result = sid->clock(tdelta, ptr, samples);
-  total += result;
-  ptr += result;
-  samples -= result;
+  cycle_count delta_t = tdelta;
+  int total = voice->sid.clock(delta_t, ptr, samples);
 
-  if(samples>0)
+  if(total<samples)
   {
-	  memset(ptr,0,sizeof(short)*samples);
-	  /*
-	  qWarning("sid_instrument: %d samples missing (tdelta=%d)",samples,tdelta);
-	  result = sid->clock(tdelta, ptr, samples);
-	  total += result;
-	  ptr += result;
-	  samples -= result;
-	  tdelta = 0;
-	  qWarning("              : %d samples missing (tdelta=%d)",samples,tdelta);
-	  */
+	  memset(ptr+total,0,sizeof(short)*(samples-total));
   }
 
   return total;
@@ -328,17 +331,26 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
-		cSID *sid = new cSID();
-		sid->set_sampling_parameters( clockrate, SAMPLE_FAST, samplerate );
+		sidVoice *voice = m_voices.acquire();
+		cSID *sid = &voice->sid;
+		// without a prepared FIR (e.g. an unsupported sample rate) the
+		// chip interpolates
+		if( !sid->set_sampling_parameters( clockrate, samplingMethod(), samplerate ) )
+		{
+			sid->set_sampling_parameters( clockrate, SAMPLE_INTERPOLATE, samplerate );
+		}
 		sid->set_chip_model( MOS8580 );
 		sid->enable_filter( true );
 		sid->reset();
-		_n->m_pluginData = sid;
+		// reset() cleared the registers
+		memset( voice->sidreg, 0, sizeof( voice->sidreg ) );
+		_n->m_pluginData = voice;
 	}
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
 
-	cSID *sid = static_cast<cSID *>( _n->m_pluginData );
+	sidVoice *voice = static_cast<sidVoice *>( _n->m_pluginData );
+	cSID *sid = &voice->sid;
 	int delta_t = clockrate * frames / samplerate + 4;
 	short buf[frames];
 	unsigned char sidreg[NUMSIDREGS];
@@ -441,7 +453,7 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 	sidreg[24] = data8&0x00FF;
 
-	int num = sid_fillbuffer(sidreg,sid,delta_t,buf,frames);
+	int num = sid_fillbuffer(sidreg,voice,delta_t,buf,frames);
 	if(num!=frames) qWarning("sidInstrument: not enough samples: %d/%d",num,frames);
 
 	for( fpp_t frame = 0; frame < frames; ++frame )
@@ -461,7 +473,7 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 void sidInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<cSID *>( _n->m_pluginData );
+	m_voices.release( static_cast<sidVoice *>( _n->m_pluginData ) );
 }
 
 
@@ -33,6 +33,7 @@
 #include "Knob.h"
 
 
+struct sidVoice;
 class sidInstrumentView;
 class NotePlayHandle;
 class automatableButtonGroup;
@@ -107,6 +108,9 @@ public:
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
+private slots:
+	void prepareSampling();
+
 /*public slots:
 	void updateKnobHint();
 	void updateKnobToolTip();*/
@@ -126,6 +130,9 @@ private:
 
 	IntModel m_chipModel;
 
+	// a chip is some 17 kB, fewer of them are set aside
+	VoicePool<sidVoice> m_voices;
+
 	friend class sidInstrumentView;
 
 } ;
@@ -300,7 +300,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 		m.lock();
 		if( p < 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = m_voices.acquire( freq,
 						vel,
 						m_stickModel.value(),
 						m_hardnessModel.value(),
@@ -313,7 +313,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 		}
 		else if( p == 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = m_voices.acquire( freq,
 						vel,
 						p,
 						m_lfoDepthModel.value(),
@@ -326,7 +326,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 		}
 		else
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = m_voices.acquire( freq,
 						vel,
 						m_pressureModel.value(),
 						m_motionModel.value(),
@@ -368,7 +368,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 
 void malletsInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<malletsSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<malletsSynth *>( _n->m_pluginData ) );
 }
 
 
@@ -181,6 +181,7 @@ private:
 
 	bool m_filesMissing;
 
+	VoicePool<malletsSynth> m_voices;
 
 	friend class malletsInstrumentView;
 
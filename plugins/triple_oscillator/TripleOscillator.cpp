@@ -354,7 +354,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 
 		}
 
-		_n->m_pluginData = new oscPtr;
+		_n->m_pluginData = m_voices.acquire();
 		static_cast<oscPtr *>( _n->m_pluginData )->oscLeft = oscs_l[0];
 		static_cast< oscPtr *>( _n->m_pluginData )->oscRight =
 								oscs_r[0];
@@ -383,7 +383,7 @@ void TripleOscillator::deleteNotePluginData( NotePlayHandle * _n )
 						_n->m_pluginData )->oscLeft );
 	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
 						_n->m_pluginData )->oscRight );
-	delete static_cast<oscPtr *>( _n->m_pluginData );
+	m_voices.release( static_cast<oscPtr *>( _n->m_pluginData ) );
 	_n->m_pluginData = NULL; //TMP ???
 }
 
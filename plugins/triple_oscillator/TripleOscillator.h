@@ -129,6 +129,7 @@ private:
 		Oscillator * oscRight;
 	} ;
 
+	VoicePool<oscPtr> m_voices;
 
 	friend class TripleOscillatorView;
 
@@ -277,9 +277,10 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 {
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		_n->m_pluginData = new stringContainer( _n->frequency(),
+		// __sampleLength by value, it has no definition to refer to
+		_n->m_pluginData = m_voices.acquire( _n->frequency(),
 				Engine::mixer()->processingSampleRate(),
-						__sampleLength );
+						int( __sampleLength ) );
 		
 		for( int i = 0; i < 9; ++i )
 		{
@@ -334,7 +335,7 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 
 void vibed::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<stringContainer *>( _n->m_pluginData );
+	m_voices.release( static_cast<stringContainer *>( _n->m_pluginData ) );
 }
 
 
@@ -31,6 +31,7 @@
 #include "PixmapButton.h"
 #include "LedCheckBox.h"
 #include "nine_button_selector.h"
+#include "string_container.h"
 
 class vibedView;
 class NotePlayHandle;
@@ -77,6 +78,8 @@ private:
 
 	static const int __sampleLength = 128;
 
+	VoicePool<stringContainer> m_voices;
+
 	friend class vibedView;
 } ;
 
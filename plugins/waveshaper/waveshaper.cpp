@@ -25,6 +25,8 @@
 
 
 #include "waveshaper.h"
+#include "Engine.h"
+#include "Mixer.h"
 #include "lmms_math.h"
 #include "embed.h"
 #include "interpolation.h"
@@ -89,56 +91,71 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 	const float *inputPtr = inputBuffer ? &( inputBuffer->values()[ 0 ] ) : &input;
 	const float *outputPtr = outputBufer ? &( outputBufer->values()[ 0 ] ) : &output;
 
+	// the shaper makes harmonics, which would fold back at the base rate
+	const int factor = Engine::mixer()->currentQualitySettings().
+						sampleRateMultiplier();
+	if( factor != m_oversampler.factor() )
+	{
+		m_oversampler.setFactor( factor );
+	}
+	sampleFrame * buf = m_oversampler.up( _buf, _frames );
+
 	for( fpp_t f = 0; f < _frames; ++f )
 	{
                 float w0, d0, w1, d1;
                 computeWetDryLevels(f, _frames, smoothBegin, smoothEnd,
                                     w0, d0, w1, d1);
 
-		sample_t s[2] = { _buf[f][0],_buf[f][1] };
-
-
-		for(int i=0; i <= 1; ++i )
+		for( int o = 0; o < m_oversampler.factor(); ++o, ++buf )
 		{
-                        // apply input gain
-                        s[i] *= *inputPtr;
-
-                        // clip if clip enabled
-                        if( clip )
-                                s[i] = qBound( -1.0f, s[i], 1.0f );
+			sample_t s[2] = { buf[0][0], buf[0][1] };
 
-                        // start effect
-			const int lookup = static_cast<int>( qAbs( s[i] ) * 200.0f );
-			const float frac = fraction( qAbs( s[i] ) * 200.0f );
-			const float posneg = s[i] < 0 ? -1.0f : 1.0f;
 
-			if( lookup < 1 )
+			for(int i=0; i <= 1; ++i )
 			{
-				s[i] = frac * samples[0] * posneg;
-			}
-			else if( lookup < 200 )
-			{
-				s[i] = linearInterpolate( samples[ lookup - 1 ],
-						samples[ lookup ], frac )
-						* posneg;
-			}
-			else
-			{
-				s[i] *= samples[199];
+				// apply input gain
+				s[i] *= *inputPtr;
+
+				// clip if clip enabled
+				if( clip )
+					s[i] = qBound( -1.0f, s[i], 1.0f );
+
+				// start effect
+				const int lookup = static_cast<int>( qAbs( s[i] ) * 200.0f );
+				const float frac = fraction( qAbs( s[i] ) * 200.0f );
+				const float posneg = s[i] < 0 ? -1.0f : 1.0f;
+
+				if( lookup < 1 )
+				{
+					s[i] = frac * samples[0] * posneg;
+				}
+				else if( lookup < 200 )
+				{
+					s[i] = linearInterpolate( samples[ lookup - 1 ],
+							samples[ lookup ], frac )
+							* posneg;
+				}
+				else
+				{
+					s[i] *= samples[199];
+				}
+
+				// apply output gain
+				s[i] *= *outputPtr;
 			}
 
-                        // apply output gain
-                        s[i] *= *outputPtr;
+			// mix wet/dry signals, the dry one is oversampled as
+			// well so both are delayed alike
+			buf[0][0] = d0 * buf[0][0] + w0 * s[0];
+			buf[0][1] = d1 * buf[0][1] + w1 * s[1];
 		}
 
-                // mix wet/dry signals
-                _buf[f][0] = d0 * _buf[f][0] + w0 * s[0];
-                _buf[f][1] = d1 * _buf[f][1] + w1 * s[1];
-
 		outputPtr += outputInc;
 		inputPtr += inputInc;
 	}
 
+	m_oversampler.down( _buf, _frames );
+
 	return true;
 }
 
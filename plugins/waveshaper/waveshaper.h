@@ -28,6 +28,7 @@
 #define _WAVESHAPER_H
 
 #include "Effect.h"
+#include "Oversampler.h"
 #include "waveshaper_controls.h"
 
 
@@ -50,6 +51,7 @@ public:
 private:
 
 	waveShaperControls m_wsControls;
+	Oversampler m_oversampler;
 
 	friend class waveShaperControls;
 
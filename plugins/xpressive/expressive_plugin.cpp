@@ -108,6 +108,7 @@ Expressive::Expressive(InstrumentTrack* instrument_track) :
 }
 
 Expressive::~Expressive() {
+	qDeleteAll(m_programs);
 }
 
 void Expressive::saveSettings(QDomDocument & _doc, QDomElement & _this) {
@@ -202,31 +203,20 @@ void Expressive::playNote(NotePlayHandle* nph, sampleFrame* working_buffer) {
 
 	if (nph->totalFramesPlayed() == 0 || nph->m_pluginData == NULL) {
 
-		ExprFront *exprO1 = new ExprFront(m_outputExpression[0].constData());
-		ExprFront *exprO2 = new ExprFront(m_outputExpression[1].constData());
-
-		auto init_expression_step1 = [this, nph](ExprFront* e) {
-			e->add_constant("key", nph->key());
-			e->add_constant("bnote", nph->instrumentTrack()->baseNote());
-			e->add_constant("srate", Engine::mixer()->processingSampleRate());
-			e->add_constant("v", nph->getVolume() / 255.0);
-			e->add_constant("tempo", Engine::getSong()->getTempo());
-			e->add_variable("A1", m_A1);
-			e->add_variable("A2", m_A2);
-			e->add_variable("A3", m_A3);
-		};
-		init_expression_step1(exprO1);
-		init_expression_step1(exprO2);
-
 		m_W1.setInterpolate(m_interpolateW1.value());
 		m_W2.setInterpolate(m_interpolateW2.value());
 		m_W3.setInterpolate(m_interpolateW3.value());
-		nph->m_pluginData = new ExprSynth(&m_W1, &m_W2, &m_W3, exprO1, exprO2, nph,
-				Engine::mixer()->processingSampleRate(), &m_panning1, &m_panning2, m_relTransition.value());
-	}
-
 
+		ExprProgram *program = acquireProgram();
+		ExprNoteValues &values = program->values();
+		values.key = nph->key();
+		values.bnote = nph->instrumentTrack()->baseNote();
+		values.v = nph->getVolume() / 255.0;
+		values.tempo = Engine::getSong()->getTempo();
 
+		nph->m_pluginData = m_voices.acquire(program, nph,
+				Engine::mixer()->processingSampleRate(), &m_panning1, &m_panning2, m_relTransition.value());
+	}
 
 	ExprSynth *ps = static_cast<ExprSynth*>(nph->m_pluginData);
 	const fpp_t frames = nph->framesLeftForCurrentPeriod();
@@ -238,7 +228,47 @@ void Expressive::playNote(NotePlayHandle* nph, sampleFrame* working_buffer) {
 }
 
 void Expressive::deleteNotePluginData(NotePlayHandle* nph) {
-	delete static_cast<ExprSynth *>(nph->m_pluginData);
+	ExprSynth *ps = static_cast<ExprSynth *>(nph->m_pluginData);
+	if (ps != NULL)
+	{
+		releaseProgram(ps->program());
+	}
+	m_voices.release(ps);
+}
+
+ExprProgram* Expressive::acquireProgram() {
+	const sample_rate_t sample_rate = Engine::mixer()->processingSampleRate();
+	ExprProgram *program = NULL;
+	QVector<ExprProgram *> stale;
+
+	m_programsMutex.lock();
+	while (program == NULL && !m_programs.isEmpty())
+	{
+		ExprProgram *p = m_programs.takeLast();
+		if (p->matches(m_outputExpression[0], m_outputExpression[1],
+				&m_W1, &m_W2, &m_W3, sample_rate))
+		{
+			program = p;
+		}
+		else
+		{
+			stale.append(p);
+		}
+	}
+	m_programsMutex.unlock();
+
+	qDeleteAll(stale);
+	if (program == NULL)
+	{
+		program = new ExprProgram(m_outputExpression[0], m_outputExpression[1],
+				&m_W1, &m_W2, &m_W3, m_A1, m_A2, m_A3, sample_rate);
+	}
+	return program;
+}
+
+void Expressive::releaseProgram(ExprProgram* program) {
+	QMutexLocker lock(&m_programsMutex);
+	m_programs.append(program);
 }
 
 PluginView * Expressive::instantiateView(QWidget* parent) {
@@ -26,7 +26,9 @@
 #ifndef EXPRESSIVE_PLUGIN_H
 #define EXPRESSIVE_PLUGIN_H
 
+#include <QMutex>
 #include <QPlainTextEdit>
+#include <QVector>
 
 #include "Graph.h"
 #include "Instrument.h"
@@ -103,6 +105,11 @@ public:
 	BoolModel& exprValid() { return m_exprValid; }
 	static void smooth(float smoothness,const graphModel* in,graphModel* out);
 protected:
+	// a compiled program for a new note, from the ones of ended notes if
+	// the expressions are still the same
+	ExprProgram* acquireProgram();
+	void releaseProgram(ExprProgram* program);
+
 	
 protected slots:
 
@@ -135,6 +142,10 @@ private:
 	WaveSample m_W1, m_W2, m_W3;
 
 	BoolModel m_exprValid;
+
+	VoicePool<ExprSynth> m_voices;
+	QVector<ExprProgram *> m_programs;
+	QMutex m_programsMutex;
 	
 } ;
 
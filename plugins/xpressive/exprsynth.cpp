@@ -25,16 +25,20 @@
 
 #include "exprsynth.h"
 
+#include <deque>
 #include <string>
 #include <vector>
 #include <math.h>
 #include <cstdlib>
+#include <cstring>
 #include <random>
 
 #include "expressive_plugin.h"
 
+#include "Engine.h"
 #include "interpolation.h"
 #include "lmms_math.h"
+#include "Mixer.h"
 #include "NotePlayHandle.h"
 
 
@@ -91,6 +95,14 @@ struct IntegrateFunction : public exprtk::ifunction<T>
 		clearArray(m_counters,max_counters);
 	}
 
+	void reset()
+	{
+		m_nCounters = 0;
+		m_nCountersCalls = 0;
+		m_cc = 0;
+		clearArray(m_counters, m_max_counters);
+	}
+
 	inline T operator()(const T& x)
 	{
 		if (*m_frame == 0)
@@ -142,6 +154,12 @@ struct LastSampleFunction : public exprtk::ifunction<T>
 		clearArray(m_samples, history_size);
 	}
 
+	void reset()
+	{
+		m_pivot_last = m_history_size - 1;
+		clearArray(m_samples, m_history_size);
+	}
+
 	inline T operator()(const T& x)
 	{
 		if (!std::isnan(x) && !std::isinf(x))
@@ -320,7 +338,7 @@ struct RandomVectorFunction : public exprtk::ifunction<float>
 	}
 
 	const int data_size=sizeof(random_data)/sizeof(int);
-	const unsigned int m_rseed;
+	unsigned int m_rseed;
 };
 
 namespace SimpleRandom {
@@ -343,7 +361,8 @@ public:
 	ExprFrontData():
 	m_rand_vec(SimpleRandom::generator()),
 	m_integ_func(NULL),
-	m_last_func(500)
+	m_last_func(500),
+	m_frame_dependent(true)
 	{}
 	~ExprFrontData()
 	{
@@ -369,6 +388,7 @@ public:
 	RandomVectorFunction m_rand_vec;
 	IntegrateFunction<float> *m_integ_func;
 	LastSampleFunction<float> m_last_func;
+	bool m_frame_dependent;
 };
 
 
@@ -543,8 +563,27 @@ bool ExprFront::compile()
 		sstore.disable_all_assignment_ops();
 		sstore.disable_all_control_structures();
 		parser_t parser(sstore);
+		parser.dec().collect_variables() = true;
+		parser.dec().collect_functions() = true;
 	
 		m_valid=parser.compile(m_data->m_expression_string, m_data->m_expression);
+
+		// whatever changes from one frame to the next, names are lower case
+		static const char* const frame_symbols[] = {
+			"t", "f", "rel", "trel", "integrate", "last", "rand" };
+		std::deque<parser_t::dependent_entity_collector::symbol_t> symbols;
+		parser.dec().symbols(symbols);
+		m_data->m_frame_dependent = false;
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{
+			for (const char* name : frame_symbols)
+			{
+				if (symbols[i].first == name)
+				{
+					m_data->m_frame_dependent = true;
+				}
+			}
+		}
 	}
 	catch(...)
 	{
@@ -568,6 +607,21 @@ float ExprFront::evaluate()
 	return 0;
 	
 }
+bool ExprFront::dependsOnFrame() const
+{
+	return m_data->m_frame_dependent;
+}
+
+void ExprFront::reset()
+{
+	m_data->m_rand_vec.m_rseed = SimpleRandom::generator();
+	m_data->m_last_func.reset();
+	if (m_data->m_integ_func)
+	{
+		m_data->m_integ_func->reset();
+	}
+}
+
 bool ExprFront::add_variable(const char* name, float& ref)
 {
 	try
@@ -656,15 +710,78 @@ void ExprFront::setIntegrate(const unsigned int* const frameCounter, const unsig
 	}
 }
 
-ExprSynth::ExprSynth(const WaveSample *gW1, const WaveSample *gW2, const WaveSample *gW3,
-	ExprFront *exprO1, ExprFront *exprO2,
-	NotePlayHandle *nph, const sample_rate_t sample_rate,
+ExprProgram::ExprProgram(const QByteArray& o1, const QByteArray& o2,
+	const WaveSample *gW1, const WaveSample *gW2, const WaveSample *gW3,
+	float& a1, float& a2, float& a3, const sample_rate_t sample_rate):
+	m_exprO1(o1.constData()),
+	m_exprO2(o2.constData()),
+	m_sourceO1(o1),
+	m_sourceO2(o2),
+	m_interpolateW1(gW1->m_interpolate),
+	m_interpolateW2(gW2->m_interpolate),
+	m_interpolateW3(gW3->m_interpolate),
+	m_sample_rate(sample_rate)
+{
+	memset(&m_values, 0, sizeof(m_values));
+	m_values.srate = sample_rate;
+	const fpp_t frames = Engine::mixer()->framesPerPeriod();
+	m_blockO1 = MM_ALLOC(float, frames);
+	m_blockO2 = MM_ALLOC(float, frames);
+
+	auto init_expression = [&](ExprFront * e) {
+		e->add_variable("key", m_values.key);
+		e->add_variable("bnote", m_values.bnote);
+		e->add_variable("srate", m_values.srate);
+		e->add_variable("v", m_values.v);
+		e->add_variable("tempo", m_values.tempo);
+		e->add_variable("A1", a1);
+		e->add_variable("A2", a2);
+		e->add_variable("A3", a3);
+		e->add_cyclic_vector("W1", gW1->m_samples, gW1->m_length, gW1->m_interpolate);
+		e->add_cyclic_vector("W2", gW2->m_samples, gW2->m_length, gW2->m_interpolate);
+		e->add_cyclic_vector("W3", gW3->m_samples, gW3->m_length, gW3->m_interpolate);
+		e->add_variable("t", m_values.t);
+		e->add_variable("f", m_values.f);
+		e->add_variable("rel", m_values.rel);
+		e->add_variable("trel", m_values.trel);
+		e->setIntegrate(&m_values.frame, sample_rate);
+		e->compile();
+	};
+	init_expression(&m_exprO1);
+	init_expression(&m_exprO2);
+}
+
+ExprProgram::~ExprProgram()
+{
+	MM_FREE(m_blockO1);
+	MM_FREE(m_blockO2);
+}
+
+bool ExprProgram::matches(const QByteArray& o1, const QByteArray& o2,
+	const WaveSample *gW1, const WaveSample *gW2, const WaveSample *gW3,
+	const sample_rate_t sample_rate) const
+{
+	return m_sourceO1 == o1 && m_sourceO2 == o2 &&
+		m_interpolateW1 == gW1->m_interpolate &&
+		m_interpolateW2 == gW2->m_interpolate &&
+		m_interpolateW3 == gW3->m_interpolate &&
+		m_sample_rate == sample_rate;
+}
+
+void ExprProgram::reset()
+{
+	m_values.t = 0;
+	m_values.rel = 0;
+	m_values.trel = 0;
+	m_values.frame = 0;
+	m_exprO1.reset();
+	m_exprO2.reset();
+}
+
+ExprSynth::ExprSynth(ExprProgram *program, NotePlayHandle *nph,
+	const sample_rate_t sample_rate,
 	const FloatModel* pan1, const FloatModel* pan2, float rel_trans):
-	m_exprO1(exprO1),
-	m_exprO2(exprO2),
-	m_W1(gW1),
-	m_W2(gW2),
-	m_W3(gW3),
+	m_program(program),
 	m_nph(nph),
 	m_sample_rate(sample_rate),
 	m_pan1(pan1),
@@ -673,37 +790,47 @@ ExprSynth::ExprSynth(const WaveSample *gW1, const WaveSample *gW2, const WaveSam
 {
 	m_note_sample = 0;
 	m_note_rel_sample = 0;
-	m_note_rel_sec = 0;
-	m_note_sample_sec = 0;
 	m_released = 0;
 	m_frequency = m_nph->frequency();
 	m_rel_inc = 1000.0 / (m_sample_rate * m_rel_transition);//rel_transition in ms. compute how much increment in each frame
-
-	auto init_expression_step2 = [this](ExprFront * e) {
-		e->add_cyclic_vector("W1", m_W1->m_samples,m_W1->m_length, m_W1->m_interpolate);
-		e->add_cyclic_vector("W2", m_W2->m_samples,m_W2->m_length, m_W2->m_interpolate);
-		e->add_cyclic_vector("W3", m_W3->m_samples,m_W3->m_length, m_W3->m_interpolate);
-		e->add_variable("t", m_note_sample_sec);
-		e->add_variable("f", m_frequency);
-		e->add_variable("rel",m_released);
-		e->add_variable("trel",m_note_rel_sec);
-		e->setIntegrate(&m_note_sample,m_sample_rate);
-		e->compile();
-	};
-	init_expression_step2(m_exprO1);
-	init_expression_step2(m_exprO2);
-
+	m_program->reset();
 }
 
 ExprSynth::~ExprSynth()
 {
-	if (m_exprO1)
+}
+
+void ExprSynth::evaluateBlock(ExprFront *expr, float *out, fpp_t frames,
+	float freq_inc, bool is_released)
+{
+	ExprNoteValues & values = m_program->values();
+	expression_t *rawExpr = &(expr->getData()->m_expression);
+	LastSampleFunction<float> *last_func = &expr->getData()->m_last_func;
+
+	if (!expr->dependsOnFrame())
 	{
-		delete m_exprO1;
+		// reads nothing that changes within the period, e.g. only the
+		// key, the velocity and A1-A3
+		const float value = rawExpr->value();
+		for (fpp_t frame = 0; frame < frames ; ++frame)
+		{
+			out[frame] = value;
+		}
+		return;
 	}
-	if (m_exprO2)
+
+	for (fpp_t frame = 0; frame < frames ; ++frame)
 	{
-		delete m_exprO2;
+		values.frame = m_note_sample + frame;
+		values.t = values.frame / (float)m_sample_rate;
+		values.f = m_frequency + frame * freq_inc;
+		if (is_released)
+		{
+			values.rel = fmin(m_released + (frame + 1) * m_rel_inc, 1);
+			values.trel = (values.frame - m_note_rel_sample) / (float)m_sample_rate;
+		}
+		out[frame] = rawExpr->value();
+		last_func->setLastSample(out[frame]);
 	}
 }
 
@@ -711,78 +838,67 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 {
 	try
 	{
-		bool o1_valid = m_exprO1->isValid();
-		bool o2_valid = m_exprO2->isValid();
+		ExprFront *exprO1 = m_program->exprO1();
+		ExprFront *exprO2 = m_program->exprO2();
+		bool o1_valid = exprO1->isValid();
+		bool o2_valid = exprO2->isValid();
 		if (!o1_valid && !o2_valid)
 		{
 			return;
 		}
-		float o1 = 0, o2 = 0;
 		float pn1 = m_pan1->value() * 0.5;
 		float pn2 = m_pan2->value() * 0.5;
 		const float new_freq = m_nph->frequency();
 		const float freq_inc = (new_freq - m_frequency) / frames;
 		const bool is_released = m_nph->isReleased();
-	
-		expression_t *o1_rawExpr = &(m_exprO1->getData()->m_expression);
-		expression_t *o2_rawExpr = &(m_exprO2->getData()->m_expression);
-		LastSampleFunction<float> * last_func1 = &m_exprO1->getData()->m_last_func;
-		LastSampleFunction<float> * last_func2 = &m_exprO2->getData()->m_last_func;
+
 		if (is_released && m_note_rel_sample == 0)
 		{
 			m_note_rel_sample = m_note_sample;
 		}
+
+		// each expression over the whole period, then the mix of both
+		float *o1 = m_program->blockO1();
+		float *o2 = m_program->blockO2();
+		if (o1_valid)
+		{
+			evaluateBlock(exprO1, o1, frames, freq_inc, is_released);
+		}
+		if (o2_valid)
+		{
+			evaluateBlock(exprO2, o2, frames, freq_inc, is_released);
+		}
+
 		if (o1_valid && o2_valid)
 		{
+			const float l1 = -pn1 + 0.5, r1 = pn1 + 0.5;
+			const float l2 = -pn2 + 0.5, r2 = pn2 + 0.5;
 			for (fpp_t frame = 0; frame < frames ; ++frame)
 			{
-				if (is_released && m_released < 1)
-				{
-					m_released = fmin(m_released+m_rel_inc, 1);
-				}
-				o1 = o1_rawExpr->value();
-				o2 = o2_rawExpr->value();
-				last_func1->setLastSample(o1);
-				last_func2->setLastSample(o2);
-				buf[frame][0] = (-pn1 + 0.5) * o1 + (-pn2 + 0.5) * o2;
-				buf[frame][1] = ( pn1 + 0.5) * o1 + ( pn2 + 0.5) * o2;
-				m_note_sample++;
-				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
-				if (is_released)
-				{
-					m_note_rel_sec = (m_note_sample - m_note_rel_sample) / (float)m_sample_rate;
-				}
-				m_frequency += freq_inc;
+				buf[frame][0] = l1 * o1[frame] + l2 * o2[frame];
+				buf[frame][1] = r1 * o1[frame] + r2 * o2[frame];
 			}
 		}
 		else
 		{
-			
 			if (o2_valid)
 			{
-				o1_rawExpr = o2_rawExpr;
-				last_func1 = last_func2;
+				o1 = o2;
 				pn1 = pn2;
 			}
+			const float l1 = -pn1 + 0.5, r1 = pn1 + 0.5;
 			for (fpp_t frame = 0; frame < frames ; ++frame)
 			{
-				if (is_released && m_released < 1)
-				{
-					m_released = fmin(m_released+m_rel_inc, 1);
-				}
-				o1 = o1_rawExpr->value();
-				last_func1->setLastSample(o1);
-				buf[frame][0] = (-pn1 + 0.5) * o1;
-				buf[frame][1] = ( pn1 + 0.5) * o1;
-				m_note_sample++;
-				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
-				if (is_released)
-				{
-					m_note_rel_sec = (m_note_sample - m_note_rel_sample) / (float)m_sample_rate;
-				}
-				m_frequency += freq_inc;
+				buf[frame][0] = l1 * o1[frame];
+				buf[frame][1] = r1 * o1[frame];
 			}
 		}
+
+		m_note_sample += frames;
+		if (is_released)
+		{
+			m_released = fmin(m_released + frames * m_rel_inc, 1);
+		}
 		m_frequency = new_freq;
 	}
 	catch(...)
@@ -43,6 +43,11 @@ public:
 	~ExprFront();
 	bool compile();
 	inline bool isValid() { return m_valid; }
+	// false if the expression gives the same value for every frame of a
+	// period, i.e. reads neither the time nor anything else of the frame
+	bool dependsOnFrame() const;
+	// forgets what integrate() and last() have seen so far
+	void reset();
 	float evaluate();
 	bool add_variable(const char* name, float & ref);
 	bool add_constant(const char* name, float  ref);
@@ -84,24 +89,70 @@ public:
 	bool m_interpolate;
 };
 
+// the values the output expressions read besides A1-A3
+struct ExprNoteValues
+{
+	float t, f, rel, trel;
+	float key, bnote, srate, v, tempo;
+	unsigned int frame;
+};
+
+// Both output expressions, compiled against one set of ExprNoteValues.
+// Compiling is by far the most expensive part of starting a note, so the
+// instrument keeps the programs of the notes that ended and hands them to
+// the next ones, as long as the expressions didn't change.
+class ExprProgram
+{
+	MM_OPERATORS
+public:
+	ExprProgram(const QByteArray& o1, const QByteArray& o2,
+			const WaveSample* gW1, const WaveSample* gW2, const WaveSample* gW3,
+			float& a1, float& a2, float& a3, const sample_rate_t sample_rate);
+	~ExprProgram();
+
+	bool matches(const QByteArray& o1, const QByteArray& o2,
+			const WaveSample* gW1, const WaveSample* gW2, const WaveSample* gW3,
+			const sample_rate_t sample_rate) const;
+	// for a new note
+	void reset();
+
+	ExprNoteValues& values() { return m_values; }
+	ExprFront* exprO1() { return &m_exprO1; }
+	ExprFront* exprO2() { return &m_exprO2; }
+	float* blockO1() { return m_blockO1; }
+	float* blockO2() { return m_blockO2; }
+
+private:
+	ExprNoteValues m_values;
+	ExprFront m_exprO1, m_exprO2;
+	const QByteArray m_sourceO1, m_sourceO2;
+	const bool m_interpolateW1, m_interpolateW2, m_interpolateW3;
+	const sample_rate_t m_sample_rate;
+	// what each expression gave over the current period
+	float *m_blockO1, *m_blockO2;
+
+} ;
+
 class ExprSynth
 {
 	MM_OPERATORS
 public:
-	ExprSynth(const WaveSample* gW1, const WaveSample* gW2, const WaveSample* gW3, ExprFront* exprO1, ExprFront* exprO2, NotePlayHandle* nph,
-			const sample_rate_t sample_rate, const FloatModel* pan1, const FloatModel* pan2, float rel_trans);
+	ExprSynth(ExprProgram* program, NotePlayHandle* nph, const sample_rate_t sample_rate,
+			const FloatModel* pan1, const FloatModel* pan2, float rel_trans);
 	virtual ~ExprSynth();
 
 	void renderOutput(fpp_t frames, sampleFrame* buf );
 
+	ExprProgram* program() { return m_program; }
+
 
 private:
-	ExprFront *m_exprO1, *m_exprO2;
-	const WaveSample *m_W1, *m_W2, *m_W3;
+	void evaluateBlock(ExprFront* expr, float* out, fpp_t frames,
+			float freq_inc, bool is_released);
+
+	ExprProgram *m_program;
 	unsigned int m_note_sample;
 	unsigned int m_note_rel_sample;
-	float m_note_sample_sec;
-	float m_note_rel_sec;
 	float m_frequency;
 	float m_released;
 	NotePlayHandle* m_nph;
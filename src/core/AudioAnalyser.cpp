@@ -0,0 +1,215 @@
+/*
+ * AudioAnalyser.cpp - analysis of effect signals away from the audio threads
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioAnalyser.h"
+
+#include <cstring>
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+
+// how often the analysers are looked at, views don't update faster anyway
+static const unsigned long ANALYSIS_INTERVAL = 20; // ms
+
+
+// Runs as long as there are active analysers and is started again by the
+// next one becoming active.
+class AnalysisThread : public QThread
+{
+public:
+	static AnalysisThread * inst()
+	{
+		static AnalysisThread * s_thread = new AnalysisThread;
+		return s_thread;
+	}
+
+	void add( AudioAnalyser * _a )
+	{
+		QMutexLocker locker( &m_mutex );
+		m_analysers.append( _a );
+		if( !m_running )
+		{
+			// the previous run may still be on its way out
+			wait();
+			m_running = true;
+			start( QThread::LowestPriority );
+		}
+	}
+
+	// once this returns, _a isn't processed anymore
+	void remove( AudioAnalyser * _a )
+	{
+		QMutexLocker locker( &m_mutex );
+		m_analysers.removeOne( _a );
+	}
+
+
+protected:
+	virtual void run()
+	{
+		m_mutex.lock();
+		while( !m_analysers.isEmpty() )
+		{
+			for( AudioAnalyser * a : m_analysers )
+			{
+				a->process();
+			}
+			// nobody wakes us, this only sleeps without the lock
+			m_interval.wait( &m_mutex, ANALYSIS_INTERVAL );
+		}
+		m_running = false;
+		m_mutex.unlock();
+	}
+
+
+private:
+	AnalysisThread() :
+		m_running( false )
+	{
+		setObjectName( "analysis" );
+	}
+
+	QMutex m_mutex;
+	QWaitCondition m_interval;
+	QList<AudioAnalyser *> m_analysers;
+	bool m_running;
+
+} ;
+
+
+
+
+AudioAnalyser::AudioAnalyser( int _frames, int _hop ) :
+	m_frames( _frames ),
+	m_hop( _hop ),
+	m_size( 1 ),
+	m_written( 0 ),
+	m_analysed( 0 ),
+	m_active( 0 ),
+	m_results( 0 )
+{
+	// room for the window being read while the next hops come in
+	while( m_size < 4 * qMax( m_frames, m_hop ) )
+	{
+		m_size <<= 1;
+	}
+	m_ring = new float[m_size];
+	m_input = new float[m_frames];
+	memset( m_ring, 0, m_size * sizeof( float ) );
+	memset( m_input, 0, m_frames * sizeof( float ) );
+}
+
+
+
+
+AudioAnalyser::~AudioAnalyser()
+{
+	setActive( false );
+	delete[] m_ring;
+	delete[] m_input;
+}
+
+
+
+
+void AudioAnalyser::setActive( bool _active )
+{
+	if( _active == isActive() )
+	{
+		return;
+	}
+
+	if( _active )
+	{
+		// only what comes in from now on counts
+		m_analysed = m_written.load();
+		m_active.store( 1 );
+		AnalysisThread::inst()->add( this );
+	}
+	else
+	{
+		m_active.store( 0 );
+		AnalysisThread::inst()->remove( this );
+	}
+}
+
+
+
+
+void AudioAnalyser::push( const sampleFrame * _buf, const fpp_t _frames,
+							ChannelModes _mode )
+{
+	if( !isActive() )
+	{
+		return;
+	}
+
+	const quint32 mask = m_size - 1;
+	const quint32 w = m_written.load();
+	switch( _mode )
+	{
+		case MergeChannels:
+			for( fpp_t f = 0; f < _frames; ++f )
+			{
+				m_ring[( w + f ) & mask] =
+					( _buf[f][0] + _buf[f][1] ) * 0.5f;
+			}
+			break;
+		case LeftChannel:
+			for( fpp_t f = 0; f < _frames; ++f )
+			{
+				m_ring[( w + f ) & mask] = _buf[f][0];
+			}
+			break;
+		case RightChannel:
+			for( fpp_t f = 0; f < _frames; ++f )
+			{
+				m_ring[( w + f ) & mask] = _buf[f][1];
+			}
+			break;
+	}
+	m_written.storeRelease( w + _frames );
+}
+
+
+
+
+void AudioAnalyser::process()
+{
+	const quint32 w = m_written.loadAcquire();
+	if( w - m_analysed < (quint32) m_hop )
+	{
+		return;
+	}
+	m_analysed = w;
+
+	const quint32 mask = m_size - 1;
+	for( int i = 0; i < m_frames; ++i )
+	{
+		m_input[i] = m_ring[( w - m_frames + i ) & mask];
+	}
+	analyse( m_input );
+	m_results.ref();
+}
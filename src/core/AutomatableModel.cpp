@@ -24,6 +24,8 @@
 
 #include "AutomatableModel.h"
 
+#include <QDataStream>
+
 #include "AutomationPattern.h"
 #include "ControllerConnection.h"
 #include "Engine.h"
@@ -217,6 +219,32 @@ void AutomatableModel::loadSettings( const QDomElement& element, const QString&
 
 
 
+bool AutomatableModel::saveJournalData( QDataStream& out ) const
+{
+	// controller connections are only journalled with the full state
+	if( m_controllerConnection != NULL )
+	{
+		return false;
+	}
+	out << m_value << static_cast<qint8>( m_scaleType );
+	return true;
+}
+
+
+
+
+void AutomatableModel::restoreJournalData( QDataStream& in )
+{
+	float value;
+	qint8 scaleType;
+	in >> value >> scaleType;
+	setScaleType( static_cast<ScaleType>( scaleType ) );
+	setValue( value );
+}
+
+
+
+
 void AutomatableModel::setValue( const float value )
 {
 	const float oldval = m_value;
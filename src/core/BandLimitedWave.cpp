@@ -27,8 +27,11 @@
 
 #include <QDataStream>
 
+#ifndef LMMS_HAVE_BUILTIN_WAVETABLES
+// otherwise defined in the generated BandLimitedWaveData.cpp
 WaveMipMap BandLimitedWave::s_waveforms[4] = {  };
 bool BandLimitedWave::s_wavesGenerated = false;
+#endif
 QString BandLimitedWave::s_wavetableDir = "";
 
 
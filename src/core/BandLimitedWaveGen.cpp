@@ -0,0 +1,145 @@
+/*
+ * BandLimitedWaveGen.cpp - build-time generator for the band-limited
+ *                          wavetables compiled into LMMS
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Reads the QDataStream-serialized mipmaps from data/wavetables (big
+// endian doubles, table after table) and writes a C++ source defining
+// BandLimitedWave::s_waveforms as initialized data, so the tables are
+// mapped in with the binary instead of being loaded at startup.
+//
+// This tool is built for the host and must not depend on Qt. The
+// layout constants below must match BandLimitedWave.h.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const int MAXLEN = 11;
+static const int MAXTBL = 23;
+static const int MIPMAPSIZE = 2 << ( MAXLEN + 1 );
+static const int MIPMAPSIZE3 = 3 << ( MAXLEN + 1 );
+
+static int tlen( int _table )
+{
+	return ( _table % 2 == 0 ? 2 : 3 ) << ( _table / 2 );
+}
+
+
+static bool readDouble( FILE * _f, double & _v )
+{
+	unsigned char b[8];
+	if( fread( b, 1, 8, _f ) != 8 )
+	{
+		return false;
+	}
+	unsigned long long u = 0;
+	for( int i = 0; i < 8; ++i )
+	{
+		u = ( u << 8 ) | b[i];
+	}
+	union { unsigned long long u; double d; } c;
+	c.u = u;
+	_v = c.d;
+	return true;
+}
+
+
+static void writeArray( FILE * _out, const std::vector<float> & _data )
+{
+	fprintf( _out, "\t\t{" );
+	for( size_t i = 0; i < _data.size(); ++i )
+	{
+		if( i % 6 == 0 )
+		{
+			fprintf( _out, "\n\t\t\t" );
+		}
+		fprintf( _out, "%.9ef,", _data[i] );
+	}
+	fprintf( _out, "\n\t\t}" );
+}
+
+
+int main( int argc, char * * argv )
+{
+	if( argc < 3 )
+	{
+		fprintf( stderr, "usage: %s output.cpp table.bin...\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	FILE * out = fopen( argv[1], "w" );
+	if( out == NULL )
+	{
+		fprintf( stderr, "%s: can not write %s\n", argv[0], argv[1] );
+		return EXIT_FAILURE;
+	}
+
+	fprintf( out, "// Generated by BandLimitedWaveGen. Do not edit.\n\n"
+			"#include \"BandLimitedWave.h\"\n\n"
+			"bool BandLimitedWave::s_wavesGenerated = true;\n\n"
+			"WaveMipMap BandLimitedWave::s_waveforms[%d] =\n{\n",
+								argc - 2 );
+
+	for( int w = 2; w < argc; ++w )
+	{
+		FILE * in = fopen( argv[w], "rb" );
+		if( in == NULL )
+		{
+			fprintf( stderr, "%s: can not read %s\n", argv[0], argv[w] );
+			fclose( out );
+			remove( argv[1] );
+			return EXIT_FAILURE;
+		}
+
+		std::vector<float> data( MIPMAPSIZE, 0.0f );
+		std::vector<float> data3( MIPMAPSIZE3, 0.0f );
+		for( int t = 0; t <= MAXTBL; ++t )
+		{
+			std::vector<float> & d = t % 2 == 0 ? data : data3;
+			for( int ph = 0; ph < tlen( t ); ++ph )
+			{
+				double v;
+				if( !readDouble( in, v ) )
+				{
+					fprintf( stderr, "%s: %s is truncated\n",
+							argv[0], argv[w] );
+					fclose( in );
+					fclose( out );
+					remove( argv[1] );
+					return EXIT_FAILURE;
+				}
+				d[tlen( t ) + ph] = static_cast<float>( v );
+			}
+		}
+		fclose( in );
+
+		fprintf( out, "\t// %s\n\t{\n", argv[w] );
+		writeArray( out, data );
+		fprintf( out, ",\n" );
+		writeArray( out, data3 );
+		fprintf( out, "\n\t},\n" );
+	}
+
+	fprintf( out, "};\n" );
+	fclose( out );
+	return EXIT_SUCCESS;
+}
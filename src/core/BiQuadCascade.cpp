@@ -0,0 +1,282 @@
+/*
+ * BiQuadCascade.cpp - a chain of stereo biquads processed a buffer at a time
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "BiQuadCascade.h"
+
+#include <cstring>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+
+enum Coefficients
+{
+	A1, A2, B0, B1, B2, NumCoefficients
+} ;
+
+
+static inline void toArray( const BiQuadCoefficients & _c, float * _a )
+{
+	_a[A1] = _c.a1;
+	_a[A2] = _c.a2;
+	_a[B0] = _c.b0;
+	_a[B1] = _c.b1;
+	_a[B2] = _c.b2;
+}
+
+
+
+
+BiQuadCascade::BiQuadCascade() :
+	m_stageCount( 0 )
+{
+	memset( m_stages, 0, sizeof( m_stages ) );
+	for( int i = 0; i < MaxStages; ++i )
+	{
+		m_stages[i].fresh = true;
+	}
+}
+
+
+
+
+void BiQuadCascade::setStage( int _stage, const BiQuadCoefficients & _coeffs )
+{
+	m_stages[_stage].target = _coeffs;
+	if( _stage >= m_stageCount )
+	{
+		m_stageCount = _stage + 1;
+	}
+}
+
+
+
+
+void BiQuadCascade::setActive( int _stage, bool _active )
+{
+	Stage & s = m_stages[_stage];
+	if( _active && !s.active )
+	{
+		s.fresh = true;
+	}
+	s.active = _active;
+	if( _stage >= m_stageCount )
+	{
+		m_stageCount = _stage + 1;
+	}
+}
+
+
+
+
+void BiQuadCascade::process( sampleFrame * _buf, const fpp_t _frames )
+{
+	if( _frames <= 0 )
+	{
+		return;
+	}
+
+	Stage * chain[MaxStages];
+	int count = 0;
+	for( int i = 0; i < m_stageCount; ++i )
+	{
+		Stage & s = m_stages[i];
+		if( !s.active )
+		{
+			continue;
+		}
+		if( s.fresh )
+		{
+			s.current = s.target;
+			memset( s.z1, 0, sizeof( s.z1 ) );
+			memset( s.z2, 0, sizeof( s.z2 ) );
+			s.fresh = false;
+		}
+		chain[count++] = &s;
+	}
+
+	int i = 0;
+#ifdef __SSE__
+	for( ; i + 1 < count; i += 2 )
+	{
+		processStages( *chain[i], *chain[i + 1], _buf, _frames );
+	}
+#endif
+	for( ; i < count; ++i )
+	{
+		processStage( *chain[i], _buf, _frames );
+	}
+}
+
+
+
+
+void BiQuadCascade::clearHistory()
+{
+	for( int i = 0; i < MaxStages; ++i )
+	{
+		m_stages[i].fresh = true;
+	}
+}
+
+
+
+
+void BiQuadCascade::processStage( Stage & _s, sampleFrame * _buf,
+							const fpp_t _frames )
+{
+	float c[NumCoefficients];
+	float inc[NumCoefficients];
+	float target[NumCoefficients];
+	toArray( _s.current, c );
+	toArray( _s.target, target );
+	for( int k = 0; k < NumCoefficients; ++k )
+	{
+		inc[k] = ( target[k] - c[k] ) / _frames;
+	}
+
+	float z1[DEFAULT_CHANNELS];
+	float z2[DEFAULT_CHANNELS];
+	memcpy( z1, _s.z1, sizeof( z1 ) );
+	memcpy( z2, _s.z2, sizeof( z2 ) );
+
+	for( fpp_t f = 0; f < _frames; ++f )
+	{
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			const float x = _buf[f][ch];
+			const float y = z1[ch] + c[B0] * x;
+			z1[ch] = c[B1] * x + z2[ch] - c[A1] * y;
+			z2[ch] = c[B2] * x - c[A2] * y;
+			_buf[f][ch] = y;
+		}
+		for( int k = 0; k < NumCoefficients; ++k )
+		{
+			c[k] += inc[k];
+		}
+	}
+
+	memcpy( _s.z1, z1, sizeof( z1 ) );
+	memcpy( _s.z2, z2, sizeof( z2 ) );
+	_s.current = _s.target;
+}
+
+
+
+
+#ifdef __SSE__
+
+static inline __m128 biQuadStep( const __m128 _x, __m128 & _z1, __m128 & _z2,
+							const __m128 * _c )
+{
+	const __m128 y = _mm_add_ps( _z1, _mm_mul_ps( _c[B0], _x ) );
+	_z1 = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( _c[B1], _x ), _z2 ),
+						_mm_mul_ps( _c[A1], y ) );
+	_z2 = _mm_sub_ps( _mm_mul_ps( _c[B2], _x ), _mm_mul_ps( _c[A2], y ) );
+	return y;
+}
+
+
+// lanes 0 and 1 take the low half of _a, 2 and 3 the high half of _b
+static inline __m128 halves( const __m128 _a, const __m128 _b )
+{
+	return _mm_shuffle_ps( _a, _b, _MM_SHUFFLE( 3, 2, 1, 0 ) );
+}
+
+
+// The left and right channel of _s1 are in lanes 0 and 1, the ones of _s2
+// in lanes 2 and 3, one frame behind, since _s2 needs the output of _s1.
+void BiQuadCascade::processStages( Stage & _s1, Stage & _s2,
+				sampleFrame * _buf, const fpp_t _frames )
+{
+	float c1[NumCoefficients], t1[NumCoefficients];
+	float c2[NumCoefficients], t2[NumCoefficients];
+	toArray( _s1.current, c1 );
+	toArray( _s1.target, t1 );
+	toArray( _s2.current, c2 );
+	toArray( _s2.target, t2 );
+
+	__m128 c[NumCoefficients];
+	__m128 inc[NumCoefficients];
+	for( int k = 0; k < NumCoefficients; ++k )
+	{
+		c[k] = _mm_setr_ps( c1[k], c1[k], c2[k], c2[k] );
+		const float i1 = ( t1[k] - c1[k] ) / _frames;
+		const float i2 = ( t2[k] - c2[k] ) / _frames;
+		inc[k] = _mm_setr_ps( i1, i1, i2, i2 );
+	}
+
+	__m128 z1 = _mm_setr_ps( _s1.z1[0], _s1.z1[1], _s2.z1[0], _s2.z1[1] );
+	__m128 z2 = _mm_setr_ps( _s1.z2[0], _s1.z2[1], _s2.z2[0], _s2.z2[1] );
+	const __m128 zero = _mm_setzero_ps();
+
+	// the first frame only goes through _s1
+	__m128 x = _mm_loadl_pi( zero, (const __m64 *) _buf[0] );
+	__m128 n1 = z1;
+	__m128 n2 = z2;
+	__m128 y = biQuadStep( x, n1, n2, c );
+	z1 = halves( n1, z1 );
+	z2 = halves( n2, z2 );
+	for( int k = 0; k < NumCoefficients; ++k )
+	{
+		c[k] = halves( _mm_add_ps( c[k], inc[k] ), c[k] );
+	}
+
+	for( fpp_t f = 1; f < _frames; ++f )
+	{
+		x = _mm_movelh_ps( _mm_loadl_pi( zero,
+					(const __m64 *) _buf[f] ), y );
+		y = biQuadStep( x, z1, z2, c );
+		_mm_storeh_pi( (__m64 *) _buf[f - 1], y );
+		for( int k = 0; k < NumCoefficients; ++k )
+		{
+			c[k] = _mm_add_ps( c[k], inc[k] );
+		}
+	}
+
+	// and the last one only through _s2
+	x = _mm_movelh_ps( zero, y );
+	n1 = z1;
+	n2 = z2;
+	y = biQuadStep( x, n1, n2, c );
+	z1 = halves( z1, n1 );
+	z2 = halves( z2, n2 );
+	_mm_storeh_pi( (__m64 *) _buf[_frames - 1], y );
+
+	float z[4];
+	_mm_storeu_ps( z, z1 );
+	_s1.z1[0] = z[0];
+	_s1.z1[1] = z[1];
+	_s2.z1[0] = z[2];
+	_s2.z1[1] = z[3];
+	_mm_storeu_ps( z, z2 );
+	_s1.z2[0] = z[0];
+	_s1.z2[1] = z[1];
+	_s2.z2[0] = z[2];
+	_s2.z2[1] = z[3];
+
+	_s1.current = _s1.target;
+	_s2.current = _s2.target;
+}
+
+#endif
@@ -33,6 +33,7 @@
 #include <QFileInfo>
 #include <QLocale>
 #include <QMessageBox>
+#include <QSet>
 #include <QTextStream>
 
 #include "base64.h"
@@ -41,6 +42,7 @@
 #include "embed.h"
 #include "GuiApplication.h"
 #include "PluginFactory.h"
+#include "ProjectBundle.h"
 #include "ProjectVersion.h"
 #include "SongEditor.h"
 #include "TextFloat.h"
@@ -100,11 +102,15 @@ DataFile::LocaleHelper::~LocaleHelper()
 
 int DataFile::seed_count=0;
 
+QList<DataFile*> DataFile::s_bundles;
+
 DataFile::DataFile( Type type ) :
 	QDomDocument( "lmms-project" ),
 	m_content(),
 	m_head(),
-	m_type( type )
+	m_type( type ),
+	m_deferBinaryData( false ),
+	m_bundle( NULL )
 {
 	DataFile::seed_count++;
 	if(DataFile::seed_count>1) qWarning("DataFile::seed_count>1");
@@ -132,7 +138,9 @@ DataFile::DataFile( Type type ) :
 DataFile::DataFile( const QString & _fileName ) :
 	QDomDocument(),
 	m_content(),
-	m_head()
+	m_head(),
+	m_deferBinaryData( false ),
+	m_bundle( NULL )
 {
 	DataFile::seed_count++;
 	if(DataFile::seed_count>1) qWarning("DataFile::seed_count>1");
@@ -155,6 +163,22 @@ DataFile::DataFile( const QString & _fileName ) :
 		return;
 	}
 
+	if( ProjectBundle::isBundle( _fileName ) )
+	{
+		// the chunks stay mapped while the project is restored
+		inFile.close();
+		m_bundle = new ProjectBundle;
+		if( m_bundle->open( _fileName ) )
+		{
+			s_bundles.append( this );
+			loadData( m_bundle->chunk( "project" ), _fileName );
+			return;
+		}
+		delete m_bundle;
+		m_bundle = NULL;
+		inFile.open( QIODevice::ReadOnly );
+	}
+
 	loadData( inFile.readAll(), _fileName );
 }
 
@@ -164,7 +188,9 @@ DataFile::DataFile( const QString & _fileName ) :
 DataFile::DataFile( const QByteArray & _data ) :
 	QDomDocument(),
 	m_content(),
-	m_head()
+	m_head(),
+	m_deferBinaryData( false ),
+	m_bundle( NULL )
 {
 	DataFile::seed_count++;
 	if(DataFile::seed_count>1) qWarning("DataFile::seed_count>1");
@@ -178,6 +204,9 @@ DataFile::DataFile( const QByteArray & _data ) :
 
 DataFile::~DataFile()
 {
+	s_bundles.removeAll( this );
+	delete m_bundle;
+
 	DataFile::seed_count--;
 	if(DataFile::seed_count>1) qWarning("DataFile::seed_count>1");
 	//qSetGlobalQHashSeed(-1);
@@ -191,7 +220,8 @@ bool DataFile::validate( QString extension )
 	switch( m_type )
 	{
 	case Type::SongProject:
-		if( extension == "mmp" || extension == "mmpz" )
+		if( extension == "mmp" || extension == "mmpz" ||
+						extension == "mmpb" )
 		{
 			return true;
 		}
@@ -210,6 +240,7 @@ bool DataFile::validate( QString extension )
 		break;
 	case Type::UnknownType:
 		if (! ( extension == "mmp" || extension == "mpt" || extension == "mmpz" ||
+				extension == "mmpb" ||
 				extension == "xpf" || extension == "xml" ||
 				( extension == "xiz" && ! pluginFactory->pluginSupportingExtension(extension).isNull()) ||
 				extension == "sf2" || extension == "pat" || extension == "mid" ||
@@ -240,7 +271,8 @@ QString DataFile::nameWithExtension( const QString & _fn ) const
 		case SongProject:
 			if( _fn.section( '.', -1 ) != "mmp" &&
 					_fn.section( '.', -1 ) != "mpt" &&
-					_fn.section( '.', -1 ) != "mmpz" )
+					_fn.section( '.', -1 ) != "mmpz" &&
+					_fn.section( '.', -1 ) != "mmpb" )
 			{
 				if( ConfigManager::inst()->value( "app",
 						"nommpz" ).toInt() == 0 )
@@ -290,6 +322,13 @@ bool DataFile::writeFile( const QString& filename )
 	const QString fullNameTemp = fullName + ".new";
 	const QString fullNameBak = fullName + ".bak";
 
+	if( fullName.section( '.', -1 ) == "mmpb" )
+	{
+		return writeBundle( fullName );
+	}
+
+	encodeBinaryData();
+
 	QFile outfile( fullNameTemp );
 
 	if( !outfile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
@@ -349,6 +388,174 @@ bool DataFile::writeFile( const QString& filename )
 
 
 
+void DataFile::addBinaryData( QDomElement& elem, const QString& attr,
+				quint64 tag, const QByteArray& data,
+				const std::function<QString()>& encode )
+{
+	if( !m_deferBinaryData )
+	{
+		elem.setAttribute( attr, encode() );
+		return;
+	}
+
+	BinaryData b;
+	b.elem = elem;
+	b.attr = attr;
+	b.tag = tag;
+	b.data = data;
+	b.encode = encode;
+	m_binaryData.append( b );
+}
+
+
+
+
+void DataFile::setBundleFiles( const QStringList& files )
+{
+	m_bundleChunks.clear();
+	for( int i = 0; i < files.size(); ++i )
+	{
+		const QHash<QString, quint64> chunks =
+					ProjectBundle::chunkTags( files[i] );
+		if( i == 0 )
+		{
+			m_bundleChunks = chunks;
+			continue;
+		}
+		// only what all of them have
+		QHash<QString, quint64>::iterator it = m_bundleChunks.begin();
+		while( it != m_bundleChunks.end() )
+		{
+			QHash<QString, quint64>::const_iterator other =
+						chunks.constFind( it.key() );
+			if( other == chunks.constEnd() || other.value() != it.value() )
+			{
+				it = m_bundleChunks.erase( it );
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+}
+
+
+
+
+bool DataFile::hasChunk( quint64 tag ) const
+{
+	QHash<QString, quint64>::const_iterator it =
+		m_bundleChunks.constFind( "data/" + QString::number( tag, 16 ) );
+	return m_deferBinaryData && it != m_bundleChunks.constEnd() &&
+								it.value() == tag;
+}
+
+
+
+
+QByteArray DataFile::binaryData( const QDomElement& elem )
+{
+	if( !elem.hasAttribute( "datachunk" ) )
+	{
+		return QByteArray();
+	}
+
+	const QDomDocument doc = elem.ownerDocument();
+	for( DataFile* dataFile : s_bundles )
+	{
+		if( *dataFile == doc )
+		{
+			return dataFile->m_bundle->chunk( "data/" +
+					elem.attribute( "datachunk" ) );
+		}
+	}
+	return QByteArray();
+}
+
+
+
+
+// Only chunks not yet in the file are written, so saving again after
+// small changes costs little more than writing the document itself.
+// There is no backup file, an interrupted write leaves the previous
+// save intact.
+bool DataFile::writeBundle( const QString& fileName )
+{
+	QList<ProjectBundle::Chunk> chunks;
+	QSet<quint64> tags;
+	for( BinaryData& b : m_binaryData )
+	{
+		const QString key = QString::number( b.tag, 16 );
+		b.elem.removeAttribute( b.attr );
+		b.elem.setAttribute( "datachunk", key );
+		if( !tags.contains( b.tag ) )
+		{
+			tags.insert( b.tag );
+			ProjectBundle::Chunk c = { "data/" + key, b.tag, b.data };
+			chunks << c;
+		}
+	}
+
+	QString xml;
+	QTextStream ts( &xml );
+	write( ts );
+	ts.flush();
+	const QByteArray project = xml.toUtf8();
+	ProjectBundle::Chunk c = { "project",
+				ProjectBundle::fingerprint( project ), project };
+	chunks.prepend( c );
+
+	// leave the document as it was for other formats
+	for( BinaryData& b : m_binaryData )
+	{
+		b.elem.removeAttribute( "datachunk" );
+		if( !b.encoded.isNull() )
+		{
+			b.elem.setAttribute( b.attr, b.encoded );
+		}
+	}
+
+	if( ProjectBundle::write( fileName, chunks ) )
+	{
+		return true;
+	}
+
+	if( gui )
+	{
+		QMessageBox::critical( NULL,
+			SongEditor::tr( "Could not write file" ),
+			SongEditor::tr( "Could not open %1 for writing. You probably are not permitted to "
+							"write to this file. Please make sure you have write-access to "
+							"the file and try again." ).arg( fileName ) );
+	}
+	return false;
+}
+
+
+
+
+void DataFile::encodeBinaryData()
+{
+	for( BinaryData& b : m_binaryData )
+	{
+		if( b.encoded.isNull() )
+		{
+			if( !b.encode )
+			{
+				qWarning( "DataFile: no data for chunk %llx outside "
+						"of its bundle", b.tag );
+				continue;
+			}
+			b.encoded = b.encode();
+			b.elem.setAttribute( b.attr, b.encoded );
+		}
+	}
+}
+
+
+
+
 DataFile::Type DataFile::type( const QString& typeName )
 {
 	for( int i = 0; i < TypeCount; ++i )
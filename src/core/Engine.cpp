@@ -35,6 +35,7 @@
 #include "ProjectJournal.h"
 #include "Song.h"
 #include "BandLimitedWave.h"
+#include "WaveForm.h"
 //#include "Backtrace.h"
 
 
@@ -89,6 +90,7 @@ void LmmsCore::init( bool renderOnly )
         t1.waitForFinished();
 	emit engine->initProgress(tr("Generating math functions"));
         t1b.waitForFinished();
+        WaveForm::startLoader();
         emit engine->initProgress(tr("Initializing data structures"));
         t2.waitForFinished();
 	emit engine->initProgress(tr("Initializing Ladspa effects"));
@@ -130,12 +132,15 @@ void LmmsCore::init( bool renderOnly )
 
 void LmmsCore::init1()
 {
+	// no-op when the wavetables are compiled in, otherwise
 	// generate (load from file) bandlimited wavetables
 	BandLimitedWave::generateWaves();
 }
 
 void LmmsCore::init1b()
 {
+        // tabulate now rather than on first use in the audio thread
+        WaveForm::buildFunctionTables();
         /*
 	init_fastsqrtf01();
         init_fastnsinf01();
@@ -193,6 +198,8 @@ void LmmsCore::destroy()
 	s_mixer->stopProcessing();
 	qWarning("Engine::destroy processing stopped");
 
+	WaveForm::stopLoader();
+
 	PresetPreviewPlayHandle::cleanup();
 
 	s_song->clearProject();
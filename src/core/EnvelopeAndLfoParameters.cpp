@@ -22,6 +22,9 @@
  *
  */
 
+#include <climits>
+#include <cstring>
+
 #include <QDomElement>
 
 #include "EnvelopeAndLfoParameters.h"
@@ -41,15 +44,26 @@ const f_cnt_t minimumFrames = 1;
 EnvelopeAndLfoParameters::LfoInstances * EnvelopeAndLfoParameters::s_lfoInstances = NULL;
 
 
+// LFOs are free running, every voice reads the same shape for a period.
+// It is rendered here once, between two periods, instead of by whichever
+// voice needs it first while the others wait for the parameter lock.
 void EnvelopeAndLfoParameters::LfoInstances::trigger()
 {
 	QMutexLocker m( &m_lfoListMutex );
 	for( LfoList::Iterator it = m_lfos.begin();
 							it != m_lfos.end(); ++it )
 	{
-		( *it )->m_lfoFrame +=
-				Engine::mixer()->framesPerPeriod();
-		( *it )->m_bad_lfoShapeData = true;
+		EnvelopeAndLfoParameters * lfo = *it;
+		QMutexLocker p( &lfo->m_paramMutex );
+		lfo->m_lfoFrame += Engine::mixer()->framesPerPeriod();
+		if( lfo->m_used && !lfo->m_lfoAmountIsZero )
+		{
+			lfo->updateLfoShapeData();
+		}
+		else
+		{
+			lfo->m_bad_lfoShapeData = true;
+		}
 	}
 }
 
@@ -103,10 +117,13 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_valueForZeroAmount( _value_for_zero_amount ),
 	m_pahdFrames( 0 ),
 	m_rFrames( 0 ),
-	m_pahdEnv( NULL ),
-	m_rEnv( NULL ),
-	m_pahdBufSize( 0 ),
-	m_rBufSize( 0 ),
+	m_predelayFrames( 0 ),
+	m_attackFrames( 0 ),
+	m_holdFrames( 0 ),
+	m_decayFrames( 0 ),
+	m_attackStep( 0.0f ),
+	m_decayStep( 0.0f ),
+	m_releaseStep( 0.0f ),
 	m_lfoPredelayModel( 0.0, 0.0, 1.0, 0.001, this, tr( "LFO Predelay" ) ),
 	m_lfoAttackModel( 0.0, 0.0, 1.0, 0.001, this, tr( "LFO Attack" ) ),
 	m_lfoSpeedModel( 0.1, 0.001, 1.0, 0.0001,
@@ -187,8 +204,6 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 	m_lfoWaveModel.disconnect( this );
 	m_x100Model.disconnect( this );
 
-	delete[] m_pahdEnv;
-	delete[] m_rEnv;
 	delete[] m_lfoShapeData;
 
 	instances()->remove( this );
@@ -280,9 +295,70 @@ inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
 	{
 		*_buf++ = m_lfoShapeData[offset] * _frame * lafI;
 	}
-	for( ; offset < _frames; ++offset )
+	memcpy( _buf, m_lfoShapeData + offset,
+				( _frames - offset ) * sizeof( float ) );
+}
+
+
+
+
+inline float EnvelopeAndLfoParameters::envSegment( f_cnt_t _frame,
+					float & _step, f_cnt_t & _end ) const
+{
+	const float amsum = m_amount + m_amountAdd;
+
+	_end = m_predelayFrames;
+	if( _frame < _end )
+	{
+		_step = 0.0f;
+		return m_amountAdd;
+	}
+	_end += m_attackFrames;
+	if( _frame < _end )
+	{
+		_step = m_attackStep;
+		return m_amountAdd +
+			( _frame - m_predelayFrames ) * m_attackStep;
+	}
+	_end += m_holdFrames;
+	if( _frame < _end )
 	{
-		*_buf++ = m_lfoShapeData[offset];
+		_step = 0.0f;
+		return amsum;
+	}
+	_end += m_decayFrames;
+	if( _frame < _end )
+	{
+		_step = m_decayStep;
+		return amsum +
+			( _frame - ( _end - m_decayFrames ) ) * m_decayStep;
+	}
+	_end = INT_MAX;
+	_step = 0.0f;
+	return m_sustainLevel;
+}
+
+
+
+
+// _buf holds the LFO level and gets the combined level
+inline void EnvelopeAndLfoParameters::applyEnvRamp( float * _buf,
+			fpp_t _frames, float _level, float _step,
+						bool _control ) const
+{
+	if( _control )
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			_buf[f] = ( _level + f * _step ) * ( 0.5f + _buf[f] );
+		}
+	}
+	else
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			_buf[f] += _level + f * _step;
+		}
 	}
 }
 
@@ -302,35 +378,39 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 
 	fillLfoLevel( _buf, _frame, _frames );
 
-	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
+	const bool control = m_controlEnvAmountModel.value();
+	fpp_t offset = 0;
+	float step;
+	f_cnt_t end;
+
+	// one linear ramp per envelope segment touched by this period
+	while( offset < _frames && _frame < _release_begin )
 	{
-		float env_level;
-		if( _frame < _release_begin )
-		{
-			if( _frame < m_pahdFrames )
-			{
-				env_level = m_pahdEnv[_frame];
-			}
-			else
-			{
-				env_level = m_sustainLevel;
-			}
-		}
-		else if( ( _frame - _release_begin ) < m_rFrames )
-		{
-			env_level = m_rEnv[_frame - _release_begin] *
-				( ( _release_begin < m_pahdFrames ) ?
-				m_pahdEnv[_release_begin] : m_sustainLevel );
-		}
-		else
+		const float level = envSegment( _frame, step, end );
+		const fpp_t n = static_cast<fpp_t>( qMin<f_cnt_t>(
+				_frames - offset,
+				qMin( end, _release_begin ) - _frame ) );
+		applyEnvRamp( _buf + offset, n, level, step, control );
+		offset += n;
+		_frame += n;
+	}
+
+	if( offset < _frames )
+	{
+		const float releaseLevel = envSegment( _release_begin, step,
+									end );
+		const f_cnt_t r = _frame - _release_begin;
+		if( r < m_rFrames )
 		{
-			env_level = 0.0f;
+			const fpp_t n = static_cast<fpp_t>( qMin<f_cnt_t>(
+					_frames - offset, m_rFrames - r ) );
+			const float s = m_releaseStep * releaseLevel;
+			applyEnvRamp( _buf + offset, n, ( m_rFrames - r ) * s,
+							-s, control );
+			offset += n;
 		}
-
-		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
-			env_level * ( 0.5f + *_buf ) :
-			env_level + *_buf;
+		applyEnvRamp( _buf + offset, _frames - offset, 0.0f, 0.0f,
+								control );
 	}
 }
 
@@ -452,61 +532,13 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 		m_rFrames = minimumFrames;
 	}
 
-	// if the buffers are too small, make bigger ones - so we only alloc new memory when necessary
-	if( m_pahdBufSize < m_pahdFrames )
-	{
-		sample_t * tmp = m_pahdEnv;
-		m_pahdEnv = new sample_t[m_pahdFrames];
-		delete[] tmp;
-		m_pahdBufSize = m_pahdFrames;
-	}
-	if( m_rBufSize < m_rFrames )
-	{
-		sample_t * tmp = m_rEnv;
-		m_rEnv = new sample_t[m_rFrames];
-		delete[] tmp;
-		m_rBufSize = m_rFrames;
-	}
-
-	const float aa = m_amountAdd;
-	for( f_cnt_t i = 0; i < predelay_frames; ++i )
-	{
-		m_pahdEnv[i] = aa;
-	}
-
-	f_cnt_t add = predelay_frames;
-
-	const float afI = ( 1.0f / attack_frames ) * m_amount;
-	for( f_cnt_t i = 0; i < attack_frames; ++i )
-	{
-		m_pahdEnv[add+i] = i * afI + aa;
-	}
-
-	add += attack_frames;
-	const float amsum = m_amount + m_amountAdd;
-	for( f_cnt_t i = 0; i < hold_frames; ++i )
-	{
-		m_pahdEnv[add + i] = amsum;
-	}
-
-	add += hold_frames;
-	const float dfI = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
-	for( f_cnt_t i = 0; i < decay_frames; ++i )
-	{
-/*
-		m_pahdEnv[add + i] = ( m_sustainLevel + ( 1.0f -
-						(float)i / decay_frames ) *
-						( 1.0f - m_sustainLevel ) ) *
-							m_amount + m_amountAdd;
-*/
-		m_pahdEnv[add + i] = amsum + i*dfI;
-	}
-
-	const float rfI = ( 1.0f / m_rFrames ) * m_amount;
-	for( f_cnt_t i = 0; i < m_rFrames; ++i )
-	{
-		m_rEnv[i] = (float)( m_rFrames - i ) * rfI;
-	}
+	m_predelayFrames = predelay_frames;
+	m_attackFrames = attack_frames;
+	m_holdFrames = hold_frames;
+	m_decayFrames = decay_frames;
+	m_attackStep = ( 1.0f / attack_frames ) * m_amount;
+	m_decayStep = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
+	m_releaseStep = ( 1.0f / m_rFrames ) * m_amount;
 
 	// save this calculation in real-time-part
 	m_sustainLevel = m_sustainLevel * m_amount + m_amountAdd;
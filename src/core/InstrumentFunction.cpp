@@ -356,6 +356,7 @@ bool InstrumentFunctionNoteStacking::processNote(NotePlayHandle* _n)
 
     const int         base_note_key = _n->key();
     const ChordTable& chord_table   = ChordTable::getInstance();
+    PlayHandleList    subNotes;
     // we add chord-subnotes to note if either note is a base-note and
     // arpeggio is not used or note is part of an arpeggio
     // at the same time we only add sub-notes if nothing of the note was
@@ -400,17 +401,19 @@ bool InstrumentFunctionNoteStacking::processNote(NotePlayHandle* _n)
 
                     // create sub-note-play-handle, only note is
                     // different
-                    Engine::mixer()->addPlayHandle(
-                            NotePlayHandleManager::acquire(
-                                    _n->instrumentTrack(), _n->offset(),
-                                    _n->frames(), subnote, _n, -1,
-                                    NotePlayHandle::OriginNoteStacking,
-                                    _n->generation() + 1));
+                    subNotes.append(NotePlayHandleManager::acquire(
+                            _n->instrumentTrack(), _n->offset(),
+                            _n->frames(), subnote, _n, -1,
+                            NotePlayHandle::OriginNoteStacking,
+                            _n->generation() + 1));
                 }
             }
         }
     }
 
+    // the whole chord enters the mixer at once
+    Engine::mixer()->addPlayHandles(subNotes);
+
     return true;
 }
 
@@ -543,6 +546,7 @@ bool InstrumentFunctionArpeggio::processNote(NotePlayHandle* _n)
                                        ? cnphv.first()->noteOffset()
                                        : _n->noteOffset();
 
+    PlayHandleList subNotes;
     while(frames_processed < Engine::mixer()->framesPerPeriod())
     {
         const f_cnt_t remaining_frames_for_cur_arp
@@ -679,7 +683,7 @@ bool InstrumentFunctionArpeggio::processNote(NotePlayHandle* _n)
 
             // create sub-note-play-handle, only ptr to note is different
             // and is_arp_note=true
-            Engine::mixer()->addPlayHandle(NotePlayHandleManager::acquire(
+            subNotes.append(NotePlayHandleManager::acquire(
                     _n->instrumentTrack(), frames_processed, gated_frames,
                     subnote, _n, -1, NotePlayHandle::OriginArpeggio,
                     _n->generation() + 1));
@@ -690,6 +694,9 @@ bool InstrumentFunctionArpeggio::processNote(NotePlayHandle* _n)
         cur_frame += arp_frames;
     }
 
+    // all steps starting in this period are added in one go
+    Engine::mixer()->addPlayHandles(subNotes);
+
     // make sure note is handled as arp-base-note, even
     // if we didn't add a sub-note so far
     if(m_arpModeModel.value() != FreeMode)
@@ -98,6 +98,19 @@ static int ffs( int i )
 
 
 void * LocklessAllocator::alloc()
+{
+	void * ptr = tryAlloc();
+	if( ptr == NULL )
+	{
+		fprintf( stderr, "LocklessAllocator: No free space\n" );
+	}
+	return ptr;
+}
+
+
+
+
+void * LocklessAllocator::tryAlloc()
 {
 	int available;
 	do
@@ -105,7 +118,6 @@ void * LocklessAllocator::alloc()
 		available = m_available;
 		if( !available )
 		{
-			fprintf( stderr, "LocklessAllocator: No free space\n" );
 			return NULL;
 		}
 	}
@@ -132,6 +144,15 @@ void * LocklessAllocator::alloc()
 
 
 
+bool LocklessAllocator::contains( const void * ptr ) const
+{
+	const ptrdiff_t diff = (const char *)ptr - m_pool;
+	return diff >= 0 && (size_t) diff < m_capacity * m_elementSize;
+}
+
+
+
+
 void LocklessAllocator::free( void * ptr )
 {
 	ptrdiff_t diff = (char *)ptr - m_pool;
@@ -62,7 +62,7 @@
 
 #include "denormals.h"
 
-//typedef LocklessList<PlayHandle *>::Element LocklessListElement;
+typedef LocklessList<PlayHandle *>::Element LocklessListElement;
 
 
 static __thread bool s_renderingThread;
@@ -70,6 +70,18 @@ static __thread bool s_renderingThread;
 
 
 
+static void deletePlayHandle( PlayHandle * _ph )
+{
+	if( _ph->type() == PlayHandle::TypeNotePlayHandle )
+	{
+		NotePlayHandleManager::release( (NotePlayHandle*) _ph );
+	}
+	else delete _ph;
+}
+
+
+
+
 Mixer::Mixer( bool renderOnly ) :
 	m_renderOnly( renderOnly ),
 	m_framesPerPeriod( DEFAULT_BUFFER_SIZE ),
@@ -79,7 +91,8 @@ Mixer::Mixer( bool renderOnly ) :
 	m_writeBuf( NULL ),
 	m_workers(),
 	m_numWorkers( QThread::idealThreadCount()-1 ),
-	m_newPlayHandles(),// PlayHandle::MaxNumber ),
+	m_newPlayHandles( PlayHandle::MaxNumber ),
+	m_removalRequested( 0 ),
 	m_qualitySettings( qualitySettings::Mode_Draft ),
 	m_masterGain( 1.0f ),
 	m_isProcessing( false ),
@@ -187,6 +200,14 @@ Mixer::~Mixer()
 	}
 	delete m_fifo;
 
+	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
+	{
+		LocklessListElement * next = e->next;
+		deletePlayHandle( e->value );
+		m_newPlayHandles.free( e );
+		e = next;
+	}
+
 	delete m_audioDev;
 
 	delete m_midiClient;
@@ -237,6 +258,10 @@ void Mixer::startProcessing( bool _needs_fifo )
 
 	m_audioDev->startProcessing();
 
+	// the load of the previous device says nothing about this one and an
+	// export must not start with degraded voices
+	m_overloadManager.reset();
+
 	m_isProcessing = true;
 }
 
@@ -301,7 +326,7 @@ sample_rate_t Mixer::inputSampleRate() const
 
 sample_rate_t Mixer::processingSampleRate() const
 {
-	return outputSampleRate() * m_qualitySettings.sampleRateMultiplier();
+	return outputSampleRate();
 }
 
 
@@ -309,7 +334,8 @@ sample_rate_t Mixer::processingSampleRate() const
 
 bool Mixer::criticalXRuns() const
 {
-	return cpuLoad() >= 95 && Engine::getSong()->isExporting() == false;
+	return m_overloadManager.level() == OverloadManager::LevelCritical &&
+				Engine::getSong()->isExporting() == false;
 }
 
 
@@ -418,26 +444,10 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 		clearInternal();
 	}
 
-	// remove all play-handles that have to be deleted and delete
-	// them if they still exist...
-	// maybe this algorithm could be optimized...
-	ConstPlayHandleList::Iterator it_rem = m_playHandlesToRemove.begin();
-	while( it_rem != m_playHandlesToRemove.end() )
+	// remove all play-handles that have to be deleted
+	if( m_removalRequested.fetchAndStoreOrdered( 0 ) )
 	{
-		PlayHandleList::Iterator it = qFind( m_playHandles.begin(), m_playHandles.end(), *it_rem );
-
-		if( it != m_playHandles.end() )
-		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			m_playHandles.erase( it );
-		}
-
-		it_rem = m_playHandlesToRemove.erase( it_rem );
+		removePlayHandles( false );
 	}
 
 	// rotate buffers
@@ -459,47 +469,31 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	song->processNextBuffer();
 
 	// add all play-handles that have to be added
-	/*
-	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
+	const int newVoices = admitNewPlayHandles();
+
+	// make room for the new notes before rendering them, exports take
+	// as long as they need
+	if( !song->isExporting() )
 	{
-		m_playHandles += e->value;
-		LocklessListElement * next = e->next;
-		m_newPlayHandles.free( e );
-		e = next;
+		m_overloadManager.enforce( m_playHandles, newVoices );
 	}
-	*/
-	while(!m_newPlayHandles.isEmpty())
-		m_playHandles.append(m_newPlayHandles.takeFirst());
 
 	// STAGE 1: run and render all play handles
-	MixerWorkerThread::fillJobQueue<PlayHandleList>( m_playHandles );
-	MixerWorkerThread::startAndWaitForJobs();
-
-	// removed all play handles which are done
-	for( PlayHandleList::Iterator it = m_playHandles.begin();
-						it != m_playHandles.end(); )
+	int voices = 0;
+	for( const PlayHandle * ph : m_playHandles )
 	{
-		if( ( *it )->affinityMatters() &&
-			( *it )->affinity() != QThread::currentThread() )
+		if( ph->type() == PlayHandle::TypeNotePlayHandle )
 		{
-			++it;
-			continue;
-		}
-		if( ( *it )->isFinished() )
-		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
-		}
-		else
-		{
-			++it;
+			++voices;
 		}
 	}
+	MicroTimer voicesTimer;
+	MixerWorkerThread::fillJobQueue<PlayHandleList>( m_playHandles );
+	MixerWorkerThread::startAndWaitForJobs();
+	const int voicesUs = voicesTimer.elapsed();
+
+	// removed all play handles which are done
+	removePlayHandles( true );
 
 	// STAGE 2: process effects of all instrument- and sampletracks
 	MixerWorkerThread::fillJobQueue<QVector<AudioPort *> >( m_audioPorts );
@@ -510,7 +504,11 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	fxMixer->masterMix( m_writeBuf );
 
 
-	emit nextAudioBuffer( m_readBuf );
+	// nobody needs to see what is exported, don't pay for the signal
+	if( !song->isExporting() )
+	{
+		emit nextAudioBuffer( m_readBuf );
+	}
 
 	runChangesInModel();
 
@@ -522,6 +520,9 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	s_renderingThread = false;
 
 	m_profiler.finishPeriod( processingSampleRate(), m_framesPerPeriod );
+	m_overloadManager.finishPeriod( m_profiler.lastPeriod(), voicesUs,
+			voices, (int)( m_framesPerPeriod * 1000000.0f /
+						processingSampleRate() ) );
 
 	return m_readBuf;
 }
@@ -539,24 +540,15 @@ void Mixer::clear()
 
 void Mixer::clearNewPlayHandles()
 {
-        requestChangeInModel();
-	while(!m_newPlayHandles.isEmpty())
-        {
-                PlayHandle* ph=m_newPlayHandles.takeFirst();
-                NotePlayHandle* nph=dynamic_cast<NotePlayHandle*>(ph);
-                if(nph) NotePlayHandleManager::release(nph);
-                else delete ph;
-        }
-
-        /*
-        for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
-        {
-                LocklessListElement * next = e->next;
-                m_newPlayHandles.free( e );
-                e = next;
-        }
-        */
-        doneChangeInModel();
+	requestChangeInModel();
+	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
+	{
+		LocklessListElement * next = e->next;
+		deletePlayHandle( e->value );
+		m_newPlayHandles.free( e );
+		e = next;
+	}
+	doneChangeInModel();
 }
 
 
@@ -573,9 +565,76 @@ void Mixer::clearInternal()
 		// during the whole lifetime of an instrument
 		if( ( *it )->type() != PlayHandle::TypeInstrumentPlayHandle )
 		{
-			m_playHandlesToRemove.push_back( *it );
+			( *it )->requestRemoval();
+		}
+	}
+	m_removalRequested.store( 1 );
+}
+
+
+
+
+int Mixer::admitNewPlayHandles()
+{
+	// the list comes newest first, turn it around so handles are
+	// rendered in the order they were added
+	LocklessListElement * first = NULL;
+	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
+	{
+		LocklessListElement * next = e->next;
+		e->next = first;
+		first = e;
+		e = next;
+	}
+
+	int notes = 0;
+	for( LocklessListElement * e = first; e; )
+	{
+		PlayHandle * ph = e->value;
+		LocklessListElement * next = e->next;
+		m_newPlayHandles.free( e );
+		e = next;
+
+		if( ph->isRemovalRequested() )
+		{
+			deletePlayHandle( ph );
+			continue;
+		}
+		ph->audioPort()->addPlayHandle( ph );
+		m_playHandles.append( ph );
+		if( ph->type() == PlayHandle::TypeNotePlayHandle )
+		{
+			++notes;
+		}
+	}
+	return notes;
+}
+
+
+
+
+void Mixer::removePlayHandles( bool _finished )
+{
+	int kept = 0;
+	for( int i = 0; i < m_playHandles.size(); ++i )
+	{
+		PlayHandle * ph = m_playHandles.at( i );
+		// handles created in another thread are deleted there
+		const bool done = ph->isRemovalRequested() ||
+			( _finished && ph->isFinished() &&
+				( !ph->affinityMatters() ||
+				ph->affinity() == QThread::currentThread() ) );
+		if( done )
+		{
+			ph->audioPort()->removePlayHandle( ph );
+			deletePlayHandle( ph );
+		}
+		else
+		{
+			m_playHandles[kept++] = ph;
 		}
 	}
+	m_playHandles.erase( m_playHandles.begin() + kept, m_playHandles.end() );
 }
 
 
@@ -719,24 +778,28 @@ void Mixer::removeAudioPort( AudioPort * _port )
 
 bool Mixer::addPlayHandle( PlayHandle* _ph )
 {
-	bool r;
-
-	if(criticalXRuns())
+	// notes make room for themselves by stealing other voices, see
+	// OverloadManager
+	if( ( criticalXRuns() &&
+		_ph->type() != PlayHandle::TypeNotePlayHandle ) ||
+		!m_newPlayHandles.push( _ph ) )
 	{
-		//if( handle->type() == PlayHandle::TypeNotePlayHandle )
-		//	NotePlayHandleManager::release( (NotePlayHandle*)handle );
-		//else delete handle;
-		m_playHandlesToRemove.push_back( _ph );
-		r=false;
+		deletePlayHandle( _ph );
+		return false;
 	}
-	else
+	return true;
+}
+
+
+
+
+bool Mixer::addPlayHandles( const PlayHandleList& _handles )
+{
+	bool r = true;
+	for( PlayHandle* ph : _handles )
 	{
-		//m_newPlayHandles.push( handle );
-		m_newPlayHandles.push_back( _ph );
-		_ph->audioPort()->addPlayHandle( _ph );
-		r=true;
+		r = addPlayHandle( ph ) && r;
 	}
-
 	return r;
 }
 
@@ -749,60 +812,23 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 	if( _ph->affinityMatters() &&
 	    _ph->affinity() == QThread::currentThread() )
 	{
-		_ph->audioPort()->removePlayHandle( _ph );
-		/*
-		bool removedFromList = false;
-		// Check m_newPlayHandles first because doing it the other way around
-		// creates a race condition
-		for( LocklessListElement * e = m_newPlayHandles.first(),
-			     * ePrev = NULL; e; ePrev = e, e = e->next )
-		{
-			if( e->value == _ph )
-			{
-				if( ePrev )
-				{
-					ePrev->next = e->next;
-				}
-				else
-				{
-					m_newPlayHandles.setFirst( e->next );
-				}
-				m_newPlayHandles.free( e );
-				removedFromList = true;
-				break;
-			}
-		}
-
-		// Now check m_playHandles
-		PlayHandleList::Iterator it = qFind( m_playHandles.begin(),
-						     m_playHandles.end(), _ph );
-		if( it != m_playHandles.end() )
-		{
-			m_playHandles.erase( it );
-			removedFromList = true;
-		}
+		// it may not have made it into m_playHandles yet
+		admitNewPlayHandles();
+		const int i = m_playHandles.indexOf( _ph );
 		// Only deleting PlayHandles that were actually found in the list
 		// "fixes crash when previewing a preset under high load"
 		// (See tobydox's 2008 commit 4583e48)
-		if ( removedFromList )
-		{
-			if( _ph->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) _ph );
-			}
-			else delete _ph;
-		}
-		*/
-		if(m_newPlayHandles.removeOne(_ph) || m_playHandles.removeOne(_ph))
+		if( i >= 0 )
 		{
-			if( _ph->type() == PlayHandle::TypeNotePlayHandle )
-				NotePlayHandleManager::release( (NotePlayHandle*) _ph );
-			else delete _ph;
+			_ph->audioPort()->removePlayHandle( _ph );
+			m_playHandles.removeAt( i );
+			deletePlayHandle( _ph );
 		}
 	}
 	else
 	{
-		m_playHandlesToRemove.push_back( _ph );
+		_ph->requestRemoval();
+		m_removalRequested.storeRelease( 1 );
 	}
 	doneChangeInModel();
 }
@@ -813,24 +839,15 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 void Mixer::removePlayHandlesOfTypes( Track * _track, const quint8 types )
 {
 	requestChangeInModel();
-	PlayHandleList::Iterator it = m_playHandles.begin();
-	while( it != m_playHandles.end() )
+	admitNewPlayHandles();
+	for( PlayHandle * ph : m_playHandles )
 	{
-		if( ( *it )->isFromTrack( _track ) && ( ( *it )->type() & types ) )
-		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
-		}
-		else
+		if( ph->isFromTrack( _track ) && ( ph->type() & types ) )
 		{
-			++it;
+			ph->requestRemoval();
 		}
 	}
+	removePlayHandles( false );
 	doneChangeInModel();
 }
 
@@ -24,24 +24,275 @@
 
 #include "MixerProfiler.h"
 
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+
+// events a thread can record before the writer gets to them
+static const int TRACE_RING_SIZE = 32768;
+static const unsigned long TRACE_DRAIN_INTERVAL = 20; // ms
+
+static const QString PERIOD_NAME = "period";
+
+
+struct TraceEvent
+{
+	qint64 begin;
+	qint64 end;
+	const char* category;
+	QString name;
+} ;
+
+
+// Events of one thread. Only that thread writes, only the writer reads.
+// Rings are kept for the lifetime of the process since the threads hold
+// on to them.
+class TraceRing
+{
+public:
+	TraceRing( int _thread, const QString& _threadName ) :
+		m_write( 0 ),
+		m_read( 0 ),
+		m_dropped( 0 ),
+		m_thread( _thread ),
+		m_threadName( _threadName )
+	{
+	}
+
+	void push( const char* _category, const QString& _name,
+						qint64 _begin, qint64 _end )
+	{
+		const int w = m_write.load();
+		if( w - m_read.loadAcquire() >= TRACE_RING_SIZE )
+		{
+			m_dropped.ref();
+			return;
+		}
+		TraceEvent& e = m_events[w % TRACE_RING_SIZE];
+		e.begin = _begin;
+		e.end = _end;
+		e.category = _category;
+		// the slot was emptied by the writer, nothing is freed here
+		e.name = _name;
+		m_write.storeRelease( w + 1 );
+	}
+
+	TraceEvent m_events[TRACE_RING_SIZE];
+	QAtomicInt m_write;
+	QAtomicInt m_read;
+	QAtomicInt m_dropped;
+	const int m_thread;
+	const QString m_threadName;
+
+} ;
+
+
+static QMutex s_ringsMutex;
+static QList<TraceRing*> s_rings;
+static thread_local TraceRing* t_ring = NULL;
+
+
+
+
+// Takes the events off the rings and writes them to the output file, so
+// the audio threads never touch the file.
+class ProfilerWriter : public QThread
+{
+public:
+	ProfilerWriter( const QString& _file ) :
+		m_file( _file ),
+		m_chrome( _file.endsWith( ".json", Qt::CaseInsensitive ) ),
+		m_first( true ),
+		m_namedThreads( 0 ),
+		m_quit( 0 )
+	{
+		setObjectName( "profiler writer" );
+		if( !m_file.open( QFile::WriteOnly | QFile::Truncate ) )
+		{
+			qWarning( "MixerProfiler: Can not write %s",
+						qPrintable( _file ) );
+			return;
+		}
+		if( m_chrome )
+		{
+			m_file.write( "[\n" );
+		}
+
+		// whatever was recorded before doesn't belong here
+		QMutexLocker locker( &s_ringsMutex );
+		for( TraceRing* r : s_rings )
+		{
+			while( r->m_read.load() != r->m_write.loadAcquire() )
+			{
+				take( r );
+			}
+		}
+	}
+
+	virtual ~ProfilerWriter()
+	{
+		m_quit.store( 1 );
+		wait();
+		if( !m_file.isOpen() )
+		{
+			return;
+		}
+		drain();
+		if( m_chrome )
+		{
+			m_file.write( "\n]\n" );
+		}
+		m_file.close();
+	}
+
+	bool isOpen() const
+	{
+		return m_file.isOpen();
+	}
+
+	bool isChrome() const
+	{
+		return m_chrome;
+	}
+
+
+protected:
+	virtual void run()
+	{
+		while( !m_quit.load() )
+		{
+			drain();
+			msleep( TRACE_DRAIN_INTERVAL );
+		}
+	}
+
+
+private:
+	static TraceEvent take( TraceRing* _r )
+	{
+		const int read = _r->m_read.load();
+		TraceEvent& slot = _r->m_events[read % TRACE_RING_SIZE];
+		TraceEvent e = slot;
+		slot.name = QString();
+		_r->m_read.storeRelease( read + 1 );
+		return e;
+	}
+
+	static QString escaped( QString _s )
+	{
+		_s.replace( '\\', "\\\\" );
+		_s.replace( '"', "\\\"" );
+		for( int i = 0; i < _s.size(); ++i )
+		{
+			if( _s[i].unicode() < 0x20 )
+			{
+				_s[i] = ' ';
+			}
+		}
+		return _s;
+	}
+
+	void drain()
+	{
+		if( !m_file.isOpen() )
+		{
+			return;
+		}
+
+		QMutexLocker locker( &s_ringsMutex );
+		for( ; m_chrome && m_namedThreads < s_rings.size();
+							++m_namedThreads )
+		{
+			const TraceRing* r = s_rings[m_namedThreads];
+			write( QString( "{\"name\":\"thread_name\",\"ph\":\"M\","
+					"\"pid\":1,\"tid\":%1,"
+					"\"args\":{\"name\":\"%2\"}}" ).
+					arg( r->m_thread ).
+					arg( escaped( r->m_threadName ) ) );
+		}
+
+		for( TraceRing* r : s_rings )
+		{
+			while( r->m_read.load() != r->m_write.loadAcquire() )
+			{
+				const TraceEvent e = take( r );
+				if( m_chrome )
+				{
+					write( QString( "{\"name\":\"%1\",\"cat\":\"%2\","
+						"\"ph\":\"X\",\"pid\":1,\"tid\":%3,"
+						"\"ts\":%4,\"dur\":%5}" ).
+						arg( escaped( e.name ) ).
+						arg( e.category ).
+						arg( r->m_thread ).
+						arg( e.begin / 1000.0, 0, 'f', 3 ).
+						arg( ( e.end - e.begin ) / 1000.0,
+								0, 'f', 3 ) );
+				}
+				else if( e.name == PERIOD_NAME )
+				{
+					m_file.write( QString( "%1\n" ).arg(
+						( e.end - e.begin ) / 1000 ).
+								toLatin1() );
+				}
+			}
+			const int dropped = r->m_dropped.fetchAndStoreOrdered( 0 );
+			if( dropped > 0 )
+			{
+				qWarning( "MixerProfiler: %d events of thread "
+						"%d were lost", dropped,
+								r->m_thread );
+			}
+		}
+	}
+
+	void write( const QString& _event )
+	{
+		if( !m_first )
+		{
+			m_file.write( ",\n" );
+		}
+		m_first = false;
+		m_file.write( _event.toUtf8() );
+	}
+
+	QFile m_file;
+	const bool m_chrome;
+	bool m_first;
+	int m_namedThreads;
+	QAtomicInt m_quit;
+
+} ;
+
+
+
 
 MixerProfiler::MixerProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
-	m_outputFile()
+	m_lastPeriod( 0 ),
+	m_clock(),
+	m_periodBegin( 0 ),
+	m_tracing( false ),
+	m_writer( NULL )
 {
+	m_clock.start();
 }
 
 
 
 MixerProfiler::~MixerProfiler()
 {
+	m_tracing = false;
+	delete m_writer;
 }
 
 
 void MixerProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
 {
 	int periodElapsed = m_periodTimer.elapsed();
+	m_lastPeriod = periodElapsed;
 
 	const float newCpuLoad = periodElapsed / 10000.0f * sampleRate / framesPerPeriod;
 	m_cpuLoad = qBound<int>( 0, ( newCpuLoad * 0.1f + m_cpuLoad * 0.9f ), 100 );
@@ -49,9 +300,9 @@ void MixerProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPerio
         //const float d=float(framesPerPeriod)/float(sampleRate);
         //m_cpuLoad = qBound<int>( 0, int( newCpuLoad * d + m_cpuLoad * (1.f-d) ), 100 );
 
-	if( m_outputFile.isOpen() )
+	if( m_writer != NULL )
 	{
-		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
+		traceNode( "mixer", PERIOD_NAME, m_periodBegin );
 	}
 }
 
@@ -59,8 +310,32 @@ void MixerProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPerio
 
 void MixerProfiler::setOutputFile( const QString& outputFile )
 {
-	m_outputFile.close();
-	m_outputFile.setFileName( outputFile );
-	m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
+	m_tracing = false;
+	delete m_writer;
+	m_writer = new ProfilerWriter( outputFile );
+	if( !m_writer->isOpen() )
+	{
+		delete m_writer;
+		m_writer = NULL;
+		return;
+	}
+	m_tracing = m_writer->isChrome();
+	m_writer->start( QThread::LowPriority );
 }
 
+
+
+void MixerProfiler::traceNode( const char* category, const QString& name,
+								qint64 begin )
+{
+	const qint64 end = traceTime();
+	if( t_ring == NULL )
+	{
+		QMutexLocker locker( &s_ringsMutex );
+		QThread* thread = QThread::currentThread();
+		t_ring = new TraceRing( s_rings.size(), thread != NULL ?
+					thread->objectName() : QString() );
+		s_rings.append( t_ring );
+	}
+	t_ring->push( category, name, begin, end );
+}
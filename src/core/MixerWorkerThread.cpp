@@ -28,6 +28,7 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include "ThreadableJob.h"
+#include "Engine.h"
 #include "Mixer.h"
 
 MixerWorkerThread::JobQueue MixerWorkerThread::globalJobQueue;
@@ -71,6 +72,7 @@ void MixerWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 
 void MixerWorkerThread::JobQueue::run()
 {
+	MixerProfiler & profiler = Engine::mixer()->profiler();
 	bool processedJob = true;
 	while( processedJob && (int) m_itemsDone < (int) m_queueSize )
 	{
@@ -80,7 +82,17 @@ void MixerWorkerThread::JobQueue::run()
 			ThreadableJob * job = m_items[i].fetchAndStoreOrdered( NULL );
 			if( job )
 			{
-				job->process();
+				if( profiler.isTracing() )
+				{
+					const qint64 begin = profiler.traceTime();
+					job->process();
+					profiler.traceNode( job->traceCategory(),
+							job->traceName(), begin );
+				}
+				else
+				{
+					job->process();
+				}
 				processedJob = true;
 				m_itemsDone.fetchAndAddOrdered( 1 );
 			}
@@ -24,6 +24,46 @@
 
 #include "Model.h"
 
+#include <QThread>
+
+
+QAtomicPointer<Model> Model::s_changedModels;
+Model * Model::s_flushedModels = NULL;
+
+
+Model::~Model()
+{
+	if( m_changeQueued.loadAcquire() == 0 )
+	{
+		return;
+	}
+
+	// deleted by a slot while its changes are being flushed
+	for( Model * * p = &s_flushedModels; *p != NULL;
+						p = &( *p )->m_nextChanged )
+	{
+		if( *p == this )
+		{
+			*p = m_nextChanged;
+			return;
+		}
+	}
+
+	// take this model off the stack, the others go back on
+	Model * m = s_changedModels.fetchAndStoreOrdered( NULL );
+	while( m != NULL )
+	{
+		Model * next = m->m_nextChanged;
+		if( m != this )
+		{
+			pushChanged( m );
+		}
+		m = next;
+	}
+}
+
+
+
 
 QString Model::fullDisplayName() const
 {
@@ -55,3 +95,68 @@ void Model::setFrequentlyUpdated(const bool _b)
 }
 
 
+
+void Model::trackChanges()
+{
+	connect( this, SIGNAL( dataChanged() ), this, SLOT( markChanged() ),
+		Qt::ConnectionType( Qt::DirectConnection | Qt::UniqueConnection ) );
+	connect( this, SIGNAL( propertiesChanged() ), this, SLOT( markChanged() ),
+		Qt::ConnectionType( Qt::DirectConnection | Qt::UniqueConnection ) );
+}
+
+
+
+
+void Model::markChanged()
+{
+	if( QThread::currentThread() == thread() )
+	{
+		emit changed();
+		return;
+	}
+
+	// queued once until the next flush, no matter how often it changes
+	if( m_changeQueued.testAndSetOrdered( 0, 1 ) )
+	{
+		pushChanged( this );
+	}
+}
+
+
+
+
+void Model::pushChanged( Model * _m )
+{
+	Model * head;
+	do
+	{
+		head = s_changedModels.loadAcquire();
+		_m->m_nextChanged = head;
+	}
+	while( !s_changedModels.testAndSetOrdered( head, _m ) );
+}
+
+
+
+
+void Model::flushChanges()
+{
+	if( s_flushedModels != NULL )
+	{
+		// called from one of the slots, the outer call goes on
+		return;
+	}
+
+	// the whole stack is taken at once, so there's no ABA problem. The
+	// models keep their flag until they're emitted, so ~Model() unlinks
+	// them if one of the slots deletes them.
+	s_flushedModels = s_changedModels.fetchAndStoreOrdered( NULL );
+	while( s_flushedModels != NULL )
+	{
+		// after resetting the flag the model may be pushed again
+		Model * m = s_flushedModels;
+		s_flushedModels = m->m_nextChanged;
+		m->m_changeQueued.storeRelease( 0 );
+		emit m->changed();
+	}
+}
@@ -31,6 +31,9 @@
 #include "DetuningHelper.h"
 
 
+QAtomicInt Note::s_revision;
+
+
 Note::Note( const MidiTime & length, const MidiTime & pos,
 	    int key, volume_t volume, panning_t panning,
 	    DetuningHelper * detuning ) :
@@ -97,6 +100,7 @@ Note::~Note()
 void Note::setLength( const MidiTime & length )
 {
 	m_length = length;
+	s_revision.ref();
 }
 
 
@@ -105,6 +109,7 @@ void Note::setLength( const MidiTime & length )
 void Note::setPos( const MidiTime & pos )
 {
 	m_pos = pos;
+	s_revision.ref();
 }
 
 
@@ -114,6 +119,7 @@ void Note::setKey( const int key )
 {
 	const int k = qBound( 0, key, NumKeys - 1 );
 	m_key = k;
+	s_revision.ref();
 }
 
 
@@ -123,6 +129,7 @@ void Note::setVolume( volume_t volume )
 {
 	const volume_t v = qBound( MinVolume, volume, MaxVolume );
 	m_volume = v;
+	s_revision.ref();
 }
 
 
@@ -132,6 +139,7 @@ void Note::setPanning( panning_t panning )
 {
 	const panning_t p = qBound( PanningLeft, panning, PanningRight );
 	m_panning = p;
+	s_revision.ref();
 }
 
 
@@ -24,6 +24,9 @@
  */
 
 #include "NotePlayHandle.h"
+
+#include <cstring>
+
 #include "DetuningHelper.h"
 //#include "InstrumentSoundShaping.h"
 #include "InstrumentTrack.h"
@@ -68,6 +71,8 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_parent( parent ),
 	m_hadChildren( false ),
 	m_muted( false ),
+	m_stolen( false ),
+	m_stealDone( false ),
 	m_bbTrack( NULL ),
 	m_origTempo( Engine::getSong()->getTempo() ),
 	m_origBaseNote( instrumentTrack->baseNote() ),
@@ -228,6 +233,16 @@ int NotePlayHandle::midiKey() const
 
 void NotePlayHandle::play( sampleFrame * _working_buffer )
 {
+	// nothing heard yet, nothing to fade
+	if( m_stolen && ( m_muted || m_totalFramesPlayed == 0 ) )
+	{
+		lock();
+		noteOff( 0 );
+		m_stealDone = true;
+		unlock();
+		return;
+	}
+
 	if( m_muted )
 	{
 		return;
@@ -251,6 +266,13 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		? Engine::mixer()->framesPerPeriod() - offset()
 		: Engine::mixer()->framesPerPeriod();
 
+	// a stolen note is released right away, so the instrument sees the
+	// note off and single-streamed ones stop it themselves
+	if( m_stolen && m_released == false )
+	{
+		noteOff( 0 );
+	}
+
 	// check if we start release during this period
 	if( m_released == false &&
 		instrumentTrack()->isSustainPedalPressed() == false &&
@@ -277,6 +299,24 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		m_instrumentTrack->playNote( this, _working_buffer );
 	}
 
+	if( m_stolen )
+	{
+		// fade out over this period, this is the last one
+		if( ! ( m_instrumentTrack->instrument()->flags() & Instrument::IsSingleStreamed ) &&
+			_working_buffer != NULL )
+		{
+			const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+			const f_cnt_t start = fpp - framesThisPeriod;
+			for( f_cnt_t f = start; f < fpp; ++f )
+			{
+				const float gain = 1.0f - (float)( f - start ) / framesThisPeriod;
+				_working_buffer[f][0] *= gain;
+				_working_buffer[f][1] *= gain;
+			}
+		}
+		m_stealDone = true;
+	}
+
 	if( m_released && (!instrumentTrack()->isSustainPedalPressed() ||
 		m_releaseStarted) )
 	{
@@ -580,6 +620,10 @@ void NotePlayHandle::resize( const bpm_t _new_tempo )
 }
 
 
+QMutex NotePlayHandleManager::s_poolMutex;
+QVector<NotePlayHandle*> NotePlayHandleManager::s_pool;
+
+
 NotePlayHandle * NotePlayHandleManager::acquire(InstrumentTrack* instrumentTrack,
 						const f_cnt_t offset,
 						const f_cnt_t frames,
@@ -589,7 +633,23 @@ NotePlayHandle * NotePlayHandleManager::acquire(InstrumentTrack* instrumentTrack
 						const NotePlayHandle::Origin origin,
 						const int generation)
 {
-	NotePlayHandle* nph=MM_ALLOC(NotePlayHandle,1);
+	NotePlayHandle* nph=NULL;
+	s_poolMutex.lock();
+	if( !s_pool.isEmpty() )
+	{
+		nph=s_pool.takeLast();
+	}
+	s_poolMutex.unlock();
+
+	if( nph != NULL )
+	{
+		// same state as fresh memory from MM_ALLOC
+		memset( (void*)nph, 0, sizeof( NotePlayHandle ) );
+	}
+	else
+	{
+		nph=MM_ALLOC(NotePlayHandle,1);
+	}
         //NotePlayHandle* nph=s_singleton->allocate();
 	new( (void*)nph ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin, generation );
 	return nph;
@@ -601,6 +661,14 @@ void NotePlayHandleManager::release( NotePlayHandle * _nph )
         //_nph->~NotePlayHandle();
         //s_singleton->deallocate(_nph);
         //NotePlayHandleManager::free(_nph);
+	s_poolMutex.lock();
+	if( s_pool.size() < MaxPooled )
+	{
+		s_pool.append( _nph );
+		s_poolMutex.unlock();
+		return;
+	}
+	s_poolMutex.unlock();
 	MM_FREE(_nph);
 }
 
@@ -0,0 +1,268 @@
+/*
+ * OverloadManager.cpp - keeps the mixer within its time budget
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "OverloadManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QVarLengthArray>
+
+#include <samplerate.h>
+
+#include "NotePlayHandle.h"
+
+
+// share of the budget a period is predicted to take
+static const float DEGRADED_LOAD = 0.8f;
+static const float CRITICAL_LOAD = 0.95f;
+// going back a level needs some distance, so the level doesn't flap
+static const float NORMAL_AGAIN_LOAD = 0.65f;
+// what a critical period is brought down to
+static const float TARGET_LOAD = 0.9f;
+
+static const int DEGRADED_VOICES_PER_TRACK = 32;
+static const int CRITICAL_VOICES_PER_TRACK = 12;
+
+
+struct TrackVoices
+{
+	const InstrumentTrack * track;
+	int voices;
+} ;
+
+
+static inline bool isCandidate( const NotePlayHandle * _n )
+{
+	// a note with sub-notes stays as long as they do
+	return !_n->isStolen() && !_n->isMasterNote() && !_n->isFinished();
+}
+
+
+// whether _a is the better voice to steal than _b
+static inline bool mattersLess( const NotePlayHandle * _a,
+						const NotePlayHandle * _b )
+{
+	if( _a->isReleased() != _b->isReleased() )
+	{
+		return _a->isReleased();
+	}
+	if( _a->getVolume() != _b->getVolume() )
+	{
+		return _a->getVolume() < _b->getVolume();
+	}
+	return _a->totalFramesPlayed() > _b->totalFramesPlayed();
+}
+
+
+
+
+OverloadManager::OverloadManager() :
+	m_periodCost( 0 ),
+	m_voiceCost( 0 ),
+	m_budget( 0 ),
+	m_level( LevelNormal )
+{
+}
+
+
+
+
+void OverloadManager::reset()
+{
+	m_periodCost = 0;
+	m_voiceCost = 0;
+	m_budget = 0;
+	m_level = LevelNormal;
+}
+
+
+
+
+void OverloadManager::finishPeriod( int _periodUs, int _voicesUs,
+						int _voices, int _budgetUs )
+{
+	m_budget = _budgetUs;
+
+	// spikes count right away, the way down is smoothed
+	m_periodCost = _periodUs > m_periodCost ? _periodUs :
+				m_periodCost * 0.7f + _periodUs * 0.3f;
+
+	if( _voices > 0 )
+	{
+		const float cost = (float) _voicesUs / _voices;
+		m_voiceCost = m_voiceCost > 0 ?
+				m_voiceCost * 0.9f + cost * 0.1f : cost;
+	}
+}
+
+
+
+
+void OverloadManager::enforce( const PlayHandleList & _handles,
+							int _newVoices )
+{
+	if( m_budget <= 0 )
+	{
+		return;
+	}
+
+	const float predicted = ( m_periodCost + _newVoices * m_voiceCost ) /
+								m_budget;
+
+	Levels level = LevelNormal;
+	if( predicted > CRITICAL_LOAD )
+	{
+		level = LevelCritical;
+	}
+	else if( predicted > DEGRADED_LOAD )
+	{
+		level = LevelDegraded;
+	}
+	if( level < m_level )
+	{
+		const float down = m_level == LevelCritical ?
+					DEGRADED_LOAD : NORMAL_AGAIN_LOAD;
+		level = predicted > down ? m_level : (Levels)( m_level - 1 );
+	}
+	m_level = level;
+
+	if( m_level == LevelNormal )
+	{
+		return;
+	}
+
+	// voice limit of each track
+	QVarLengthArray<TrackVoices, 64> tracks;
+	int voices = 0;
+	for( const PlayHandle * ph : _handles )
+	{
+		if( ph->type() != PlayHandle::TypeNotePlayHandle )
+		{
+			continue;
+		}
+		const NotePlayHandle * n = (const NotePlayHandle *) ph;
+		if( !isCandidate( n ) )
+		{
+			continue;
+		}
+		++voices;
+		int t = 0;
+		while( t < tracks.size() && tracks[t].track != n->instrumentTrack() )
+		{
+			++t;
+		}
+		if( t == tracks.size() )
+		{
+			const TrackVoices tv = { n->instrumentTrack(), 0 };
+			tracks.append( tv );
+		}
+		++tracks[t].voices;
+	}
+
+	const int limit = m_level == LevelCritical ?
+			CRITICAL_VOICES_PER_TRACK : DEGRADED_VOICES_PER_TRACK;
+	int stolen = 0;
+	for( const TrackVoices & tv : tracks )
+	{
+		if( tv.voices > limit )
+		{
+			steal( _handles, tv.track, tv.voices - limit );
+			stolen += tv.voices - limit;
+		}
+	}
+
+	// and whatever still doesn't fit, but never more than a quarter of
+	// the voices at once, the prediction may be off
+	if( m_level == LevelCritical && m_voiceCost > 0 )
+	{
+		const int excess = (int) ceilf( ( predicted - TARGET_LOAD ) *
+						m_budget / m_voiceCost ) - stolen;
+		steal( _handles, NULL, qMin( excess, ( voices - stolen ) / 4 ) );
+	}
+}
+
+
+
+
+int OverloadManager::interpolation( int _requested ) const
+{
+	switch( m_level )
+	{
+		case LevelDegraded:
+			if( _requested == SRC_SINC_BEST_QUALITY ||
+				_requested == SRC_SINC_MEDIUM_QUALITY )
+			{
+				return SRC_SINC_FASTEST;
+			}
+			break;
+		case LevelCritical:
+			if( _requested == SRC_SINC_BEST_QUALITY ||
+				_requested == SRC_SINC_MEDIUM_QUALITY ||
+				_requested == SRC_SINC_FASTEST )
+			{
+				return SRC_LINEAR;
+			}
+			break;
+		default:
+			break;
+	}
+	return _requested;
+}
+
+
+
+
+void OverloadManager::steal( const PlayHandleList & _handles,
+				const InstrumentTrack * _track, int _count )
+{
+	if( _count <= 0 )
+	{
+		return;
+	}
+
+	QVarLengthArray<NotePlayHandle *, 256> candidates;
+	for( PlayHandle * ph : _handles )
+	{
+		if( ph->type() != PlayHandle::TypeNotePlayHandle )
+		{
+			continue;
+		}
+		NotePlayHandle * n = (NotePlayHandle *) ph;
+		if( isCandidate( n ) &&
+			( _track == NULL || n->instrumentTrack() == _track ) )
+		{
+			candidates.append( n );
+		}
+	}
+
+	// the _count voices that matter least end up in front, in no order
+	if( _count < candidates.size() )
+	{
+		std::nth_element( candidates.begin(), candidates.begin() + _count,
+						candidates.end(), mattersLess );
+	}
+	for( int i = 0; i < qMin( _count, candidates.size() ); ++i )
+	{
+		candidates[i]->steal();
+	}
+}
@@ -0,0 +1,230 @@
+/*
+ * Oversampler.cpp - runs a nonlinear processor at a multiple of the sample rate
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Oversampler.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "Engine.h"
+#include "Mixer.h"
+#include "MemoryManager.h"
+
+
+static const int K = Oversampler::HalfbandTaps;
+
+
+// The odd taps h[2t+1] of a Blackman windowed halfband lowpass, the even
+// ones are 0 except for h[0] = 0.5. The filter is symmetric.
+class HalfbandCoefficients
+{
+public:
+	HalfbandCoefficients()
+	{
+		const double n = 2 * K;
+		double sum = 0;
+		for( int t = 0; t < K; ++t )
+		{
+			const double i = 2 * t + 1;
+			const double window = 0.42 + 0.5 * cos( M_PI * i / n ) +
+						0.08 * cos( 2 * M_PI * i / n );
+			const double sinc = sin( M_PI * i / 2 ) / ( M_PI * i );
+			m_taps[t] = sinc * window;
+			sum += m_taps[t];
+		}
+		// unity gain at DC: 0.5 + 2 * sum
+		for( int t = 0; t < K; ++t )
+		{
+			m_taps[t] *= 0.25 / sum;
+		}
+	}
+
+	float m_taps[K];
+
+} ;
+
+
+static const HalfbandCoefficients s_halfband;
+
+
+
+
+Oversampler::Oversampler( int _factor ) :
+	m_factor( 1 ),
+	m_stageCount( 0 ),
+	m_frames( Engine::mixer()->framesPerPeriod() )
+{
+	m_buffer = MM_ALLOC( sampleFrame, m_frames * MaxFactor );
+	m_scratch = MM_ALLOC( sampleFrame, m_frames * MaxFactor / 2 );
+	m_work = MM_ALLOC( sampleFrame, m_frames * MaxFactor + DownHistory );
+	setFactor( _factor );
+}
+
+
+
+
+Oversampler::~Oversampler()
+{
+	MM_FREE( m_buffer );
+	MM_FREE( m_scratch );
+	MM_FREE( m_work );
+}
+
+
+
+
+void Oversampler::setFactor( int _factor )
+{
+	m_factor = 1;
+	m_stageCount = 0;
+	while( m_factor * 2 <= qBound( 1, _factor, (int) MaxFactor ) )
+	{
+		m_factor *= 2;
+		++m_stageCount;
+	}
+	clear();
+}
+
+
+
+
+void Oversampler::clear()
+{
+	memset( m_stages, 0, sizeof( m_stages ) );
+}
+
+
+
+
+sampleFrame * Oversampler::up( const sampleFrame * _in, const fpp_t _frames )
+{
+	if( m_stageCount == 0 )
+	{
+		if( _in != m_buffer )
+		{
+			memcpy( m_buffer, _in, sizeof( sampleFrame ) * _frames );
+		}
+		return m_buffer;
+	}
+
+	// the last stage has to end up in m_buffer
+	sampleFrame * out = m_stageCount % 2 ? m_buffer : m_scratch;
+	fpp_t frames = _frames;
+	for( int s = 0; s < m_stageCount; ++s )
+	{
+		upStage( m_stages[s], _in, out, frames );
+		_in = out;
+		out = out == m_buffer ? m_scratch : m_buffer;
+		frames *= 2;
+	}
+	return m_buffer;
+}
+
+
+
+
+void Oversampler::down( sampleFrame * _out, const fpp_t _frames )
+{
+	if( m_stageCount == 0 )
+	{
+		if( _out != m_buffer )
+		{
+			memcpy( _out, m_buffer, sizeof( sampleFrame ) * _frames );
+		}
+		return;
+	}
+
+	const sampleFrame * in = m_buffer;
+	fpp_t frames = _frames * m_factor / 2;
+	for( int s = m_stageCount - 1; s > 0; --s )
+	{
+		sampleFrame * out = in == m_buffer ? m_scratch : m_buffer;
+		downStage( m_stages[s], in, out, frames );
+		in = out;
+		frames /= 2;
+	}
+	downStage( m_stages[0], in, _out, _frames );
+}
+
+
+
+
+// y[2m] = x[m-K], y[2m+1] = 2 * sum h[2t+1] * ( x[m-K-t] + x[m-K+1+t] ),
+// i.e. the zeros of the stuffed signal are skipped
+void Oversampler::upStage( Stage & _stage, const sampleFrame * _in,
+					sampleFrame * _out, const fpp_t _frames )
+{
+	const float * h = s_halfband.m_taps;
+
+	memcpy( m_work, _stage.up, sizeof( _stage.up ) );
+	memcpy( m_work + UpHistory, _in, sizeof( sampleFrame ) * _frames );
+
+	for( fpp_t m = 0; m < _frames; ++m )
+	{
+		// m_work[m + UpHistory - K] is x[m-K]
+		const sampleFrame * x = m_work + m + K - 1;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			float sum = 0.0f;
+			for( int t = 0; t < K; ++t )
+			{
+				sum += h[t] * ( x[-t][ch] + x[1 + t][ch] );
+			}
+			_out[2 * m][ch] = x[0][ch];
+			_out[2 * m + 1][ch] = 2.0f * sum;
+		}
+	}
+
+	memcpy( _stage.up, m_work + _frames, sizeof( _stage.up ) );
+}
+
+
+
+
+// y[m] = 0.5 * v[c] + sum h[2t+1] * ( v[c-1-2t] + v[c+1+2t] ) with
+// c = 2m+2-2K, only every other output of the lowpass is computed
+void Oversampler::downStage( Stage & _stage, const sampleFrame * _in,
+					sampleFrame * _out, const fpp_t _frames )
+{
+	const float * h = s_halfband.m_taps;
+
+	memcpy( m_work, _stage.down, sizeof( _stage.down ) );
+	memcpy( m_work + DownHistory, _in, sizeof( sampleFrame ) * _frames * 2 );
+
+	for( fpp_t m = 0; m < _frames; ++m )
+	{
+		// m_work[DownHistory + c] is v[c]
+		const sampleFrame * v = m_work + 2 * m + 2 * K - 1;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			float sum = 0.5f * v[0][ch];
+			for( int t = 0; t < K; ++t )
+			{
+				sum += h[t] * ( v[-1 - 2 * t][ch] +
+							v[1 + 2 * t][ch] );
+			}
+			_out[m][ch] = sum;
+		}
+	}
+
+	memcpy( _stage.down, m_work + _frames * 2, sizeof( _stage.down ) );
+}
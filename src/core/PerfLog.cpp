@@ -28,6 +28,7 @@
 
 #ifdef LMMS_DEBUG_PERFLOG
 
+QMutex                         PerfLog::s_mutex;
 QHash<QString, PerfLog::Entry> PerfLog::s_running;
 QHash<QString, PerfLog::Cumul> PerfLog::s_cumulated;
 
@@ -47,6 +48,7 @@ PerfLog::Cumul::Cumul() :
 
 void PerfLog::begin(const QString& what)
 {
+    QMutexLocker locker(&s_mutex);
     if(s_running.contains(what))
         qWarning("PerfLog::begin already %s", qPrintable(what));
 
@@ -62,6 +64,7 @@ void PerfLog::end(const QString& what, const uint32_t milliseconds)
             qFatal("PerfLog::end sysconf()");
 
     PerfLog::Entry e;
+    QMutexLocker   locker(&s_mutex);
     PerfLog::Entry b = s_running.take(what);
 
     float treal = (e.c - b.c) / (double)clktck;
@@ -84,6 +87,7 @@ void PerfLog::end(const QString& what, const uint32_t milliseconds)
               c.ctsyst, qPrintable(QThread::currentThread()->objectName()));
     }
 #else
+    QMutexLocker locker(&s_mutex);
     s_running.take(what);
     qInfo("PERFLOG | %20s | n/a", qPrintable(what));
 #endif
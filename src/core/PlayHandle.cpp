@@ -23,6 +23,7 @@
  */
 
 #include "PlayHandle.h"
+#include "AudioPort.h"
 #include "BufferManager.h"
 //#include "Engine.h"
 //#include "Mixer.h"
@@ -38,7 +39,8 @@ PlayHandle::PlayHandle(const Type type, f_cnt_t offset) :
 		m_offset(offset),
 		m_affinity(QThread::currentThread()),
 		m_playHandleBuffer( NULL ),//BufferManager::acquire()),
-		m_bufferReleased(true)
+		m_bufferReleased(true),
+		m_removalRequested(false)
 {
 }
 
@@ -49,6 +51,12 @@ PlayHandle::~PlayHandle()
 }
 
 
+QString PlayHandle::traceName() const
+{
+	return m_audioPort != NULL ? m_audioPort->name() : QString();
+}
+
+
 void PlayHandle::doProcessing()
 {
 	if( m_usesBuffer )
@@ -27,9 +27,13 @@
 #include <QApplication>
 //#include <QCoreApplication>
 //#include <QDebug>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QSet>
 #include <QLibrary>
+#include <QStandardPaths>
 
 #include "ConfigManager.h"
 
@@ -44,6 +48,90 @@ qint64 qHash(const QFileInfo& fi)
 	return qHash(fi.absoluteFilePath());
 }
 
+// Libraries in the plugin paths that are not LMMS plugins (like
+// ZynAddSubFxCore) are remembered together with their modification time and
+// size, so they are only loaded when a plugin can't be loaded without them.
+// Libraries which can't be loaded at all are remembered with their error and
+// aren't tried again until they change.
+static const quint32 CACHE_MAGIC = 0x4c4d5043; // "LMPC"
+static const quint32 CACHE_VERSION = 2;
+
+struct LibraryStamp
+{
+	qint64 modified;
+	qint64 size;
+	QString error;
+
+	bool sameFile(const LibraryStamp& other) const
+	{
+		return modified == other.modified && size == other.size;
+	}
+
+	bool operator==(const LibraryStamp& other) const
+	{
+		return sameFile(other) && error == other.error;
+	}
+};
+
+static LibraryStamp stamp(const QFileInfo& file)
+{
+	return LibraryStamp{file.lastModified().toMSecsSinceEpoch(), file.size(), QString()};
+}
+
+static QString cacheFile()
+{
+	const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	return dir.isEmpty() ? QString() : dir + "/plugins.cache";
+}
+
+static QHash<QString, LibraryStamp> loadCache()
+{
+	QHash<QString, LibraryStamp> libraries;
+	QFile file(cacheFile());
+	if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly)) {
+		return libraries;
+	}
+
+	QDataStream in(&file);
+	quint32 magic, version;
+	qint32 count;
+	in >> magic >> version >> count;
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION || count < 0) {
+		return libraries;
+	}
+	for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+	{
+		QString path;
+		LibraryStamp s;
+		in >> path >> s.modified >> s.size >> s.error;
+		libraries.insert(path, s);
+	}
+	if (in.status() != QDataStream::Ok) {
+		libraries.clear();
+	}
+	return libraries;
+}
+
+static void saveCache(const QHash<QString, LibraryStamp>& libraries)
+{
+	const QString fileName = cacheFile();
+	if (fileName.isEmpty() || !QDir().mkpath(QFileInfo(fileName).absolutePath())) {
+		return;
+	}
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning("PluginFactory: Can not write %s", qPrintable(fileName));
+		return;
+	}
+
+	QDataStream out(&file);
+	out << CACHE_MAGIC << CACHE_VERSION << (qint32) libraries.size();
+	for (auto it = libraries.constBegin(); it != libraries.constEnd(); ++it)
+	{
+		out << it.key() << it.value().modified << it.value().size << it.value().error;
+	}
+}
+
 std::unique_ptr<PluginFactory> PluginFactory::s_instance;
 
 PluginFactory::PluginFactory()
@@ -142,23 +230,79 @@ void PluginFactory::discoverPlugins()
 		files.unite(QDir(searchPath).entryInfoList(nameFilters).toSet());
 	}
 
-	// Cheap dependency handling: zynaddsubfx needs ZynAddSubFxCore. By loading
-	// all libraries twice we ensure that libZynAddSubFxCore is found.
+	const QHash<QString, LibraryStamp> cached = loadCache();
+	QHash<QString, LibraryStamp> libraries;
+
+	// Known non-plugin libraries are deferred and known broken ones are
+	// skipped, everything else is tried right away
+	QList<QFileInfo> pending, deferred;
 	for (const QFileInfo& file : files)
 	{
-		QLibrary(file.absoluteFilePath()).load();
+		auto it = cached.constFind(file.absoluteFilePath());
+		if (it == cached.constEnd() || !it->sameFile(stamp(file))) {
+			pending << file;
+		} else if (it->error.isEmpty()) {
+			deferred << file;
+		} else {
+			libraries.insert(file.absoluteFilePath(), *it);
+			m_errors[file.baseName()] = it->error;
+			qWarning("Warning: %s", qPrintable(it->error));
+		}
 	}
 
-	for (const QFileInfo& file : files)
+	// Dependency handling: zynaddsubfx needs ZynAddSubFxCore, which the
+	// dynamic linker only finds once it has been loaded from here. Libraries
+	// that fail to load are retried as long as others succeed, and deferred
+	// libraries are only loaded if nothing else helps.
+	QList<std::shared_ptr<QLibrary>> loaded;
+	QList<QFileInfo> loadedFiles;
+	QHash<QString, QString> errors;
+	while (!pending.isEmpty())
 	{
-		auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
-
-		if (! library->load()) {
-			m_errors[file.baseName()] = library->errorString();
-			qWarning("Warning: %s", qPrintable(library->errorString()));
-			continue;
+		QList<QFileInfo> failed;
+		for (const QFileInfo& file : pending)
+		{
+			auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
+			if (library->load()) {
+				loaded << library;
+				loadedFiles << file;
+			} else {
+				failed << file;
+				errors[file.baseName()] = library->errorString();
+			}
+		}
+		if (failed.size() == pending.size()) {
+			if (deferred.isEmpty()) {
+				break;
+			}
+			failed += deferred;
+			deferred.clear();
 		}
+		pending = failed;
+	}
+
+	for (const QFileInfo& file : pending)
+	{
+		LibraryStamp broken = stamp(file);
+		broken.error = errors.value(file.baseName());
+		libraries.insert(file.absoluteFilePath(), broken);
+		m_errors[file.baseName()] = broken.error;
+		qWarning("Warning: %s", qPrintable(broken.error));
+	}
+
+	// Deferred libraries nobody needed stay known as they are
+	for (const QFileInfo& file : deferred)
+	{
+		libraries.insert(file.absoluteFilePath(), stamp(file));
+	}
+
+	for (int i = 0; i < loaded.size(); ++i)
+	{
+		const QFileInfo& file = loadedFiles.at(i);
+		const std::shared_ptr<QLibrary>& library = loaded.at(i);
+
 		if (library->resolve("lmms_plugin_main") == nullptr) {
+			libraries.insert(file.absoluteFilePath(), stamp(file));
 			continue;
 		}
 
@@ -197,6 +341,10 @@ void PluginFactory::discoverPlugins()
 
 	m_pluginInfos = pluginInfos;
 	m_descriptors = descriptors;
+
+	if (libraries != cached) {
+		saveCache(libraries);
+	}
 }
 
 
@@ -187,7 +187,12 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 
 	s_previewTC->setPreviewNote( m_previewNote );
 
-	Engine::mixer()->addPlayHandle( m_previewNote );
+	if( !Engine::mixer()->addPlayHandle( m_previewNote ) )
+	{
+		// the mixer has already deleted it, this handle just finishes
+		m_previewNote = NULL;
+		s_previewTC->setPreviewNote( NULL );
+	}
 
 	s_previewTC->unlockData();
 	Engine::projectJournal()->setJournalling( j );
@@ -198,6 +203,11 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 
 PresetPreviewPlayHandle::~PresetPreviewPlayHandle()
 {
+	if( m_previewNote == NULL )
+	{
+		return;
+	}
+
 	s_previewTC->lockData();
 	// not muted by other preset-preview-handle?
 	if( !m_previewNote->isMuted() )
@@ -223,7 +233,7 @@ void PresetPreviewPlayHandle::play( sampleFrame * _working_buffer )
 
 bool PresetPreviewPlayHandle::isFinished() const
 {
-	return m_previewNote->isMuted();
+	return m_previewNote == NULL || m_previewNote->isMuted();
 }
 
 
@@ -0,0 +1,420 @@
+/*
+ * ProjectBundle.cpp - chunked project container with incremental writes
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ProjectBundle.h"
+
+#include <QDataStream>
+#include <QSaveFile>
+
+#include "lmmsconfig.h"
+
+#ifndef LMMS_BUILD_WIN32
+#include <unistd.h>
+#endif
+
+
+static const quint32 BUNDLE_MAGIC = 0x4c4d5042; // "LMPB"
+static const quint32 BUNDLE_VERSION = 1;
+
+// the header takes the first page, chunks start on page boundaries
+static const qint64 BUNDLE_PAGE = 4096;
+static const qint64 HEADER_BYTES = 32;
+
+
+static inline qint64 align( qint64 _pos )
+{
+	return ( _pos + BUNDLE_PAGE - 1 ) / BUNDLE_PAGE * BUNDLE_PAGE;
+}
+
+
+
+
+// the chunks and the table must be on disk before the header points to
+// them
+static bool syncFile( QFileDevice & _file )
+{
+	if( !_file.flush() )
+	{
+		return false;
+	}
+#ifndef LMMS_BUILD_WIN32
+	fsync( _file.handle() );
+#endif
+	return true;
+}
+
+
+
+
+ProjectBundle::ProjectBundle() :
+	m_file(),
+	m_map( NULL ),
+	m_table()
+{
+}
+
+
+
+
+ProjectBundle::~ProjectBundle()
+{
+	close();
+}
+
+
+
+
+bool ProjectBundle::isBundle( const QString & _file )
+{
+	QFile file( _file );
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		return false;
+	}
+	QDataStream in( &file );
+	quint32 magic = 0;
+	in >> magic;
+	return magic == BUNDLE_MAGIC;
+}
+
+
+
+
+// FNV-1a, only used to tell chunks apart, not for integrity
+quint64 ProjectBundle::fingerprint( const QByteArray & _data )
+{
+	quint64 h = 14695981039346656037ULL;
+	const uchar * d = (const uchar *) _data.constData();
+	for( int i = 0; i < _data.size(); ++i )
+	{
+		h = ( h ^ d[i] ) * 1099511628211ULL;
+	}
+	return h;
+}
+
+
+
+
+bool ProjectBundle::open( const QString & _file )
+{
+	close();
+
+	m_file.setFileName( _file );
+	if( !m_file.open( QIODevice::ReadOnly ) || !readTable( m_file, m_table ) )
+	{
+		close();
+		return false;
+	}
+
+	m_map = m_file.map( 0, m_file.size() );
+	if( m_map == NULL )
+	{
+		qWarning( "ProjectBundle: Can not map %s", qPrintable( _file ) );
+		close();
+		return false;
+	}
+	return true;
+}
+
+
+
+
+void ProjectBundle::close()
+{
+	if( m_map != NULL )
+	{
+		m_file.unmap( m_map );
+		m_map = NULL;
+	}
+	m_file.close();
+	m_table.clear();
+}
+
+
+
+
+QByteArray ProjectBundle::chunk( const QString & _key ) const
+{
+	Table::const_iterator it = m_table.constFind( _key );
+	if( m_map == NULL || it == m_table.constEnd() )
+	{
+		return QByteArray();
+	}
+	// a view into the map would be left dangling by close() or a later
+	// open(), and the data ends up being kept by the objects loading it
+	return QByteArray( (const char *) m_map + it->offset, it->size );
+}
+
+
+
+
+bool ProjectBundle::write( const QString & _file,
+					const QList<Chunk> & _chunks )
+{
+	QFile file( _file );
+	Table old;
+	if( !file.exists() || !file.open( QIODevice::ReadWrite ) ||
+						!readTable( file, old ) )
+	{
+		file.close();
+		return writeFresh( _file, _chunks );
+	}
+
+	// start over once earlier saves left more garbage than data
+	qint64 live = BUNDLE_PAGE;
+	foreach( const Chunk & c, _chunks )
+	{
+		live += align( c.data.isNull() ? old.value( c.key ).size :
+							c.data.size() );
+	}
+	if( file.size() > 2 * live )
+	{
+		// the chunks kept without data are copied from the old file
+		QList<Chunk> chunks = _chunks;
+		for( Chunk & c : chunks )
+		{
+			if( c.data.isNull() && !readChunk( file, old, c ) )
+			{
+				return false;
+			}
+		}
+		file.close();
+		return writeFresh( _file, chunks );
+	}
+
+	// everything goes behind the current end, nothing the current
+	// table refers to is touched
+	Table table;
+	qint64 pos = align( file.size() );
+	foreach( const Chunk & c, _chunks )
+	{
+		Table::const_iterator it = old.constFind( c.key );
+		if( it != old.constEnd() && it->tag == c.tag &&
+			( c.data.isNull() || it->size == c.data.size() ) )
+		{
+			table.insert( c.key, *it );
+			continue;
+		}
+		if( c.data.isNull() )
+		{
+			qWarning( "ProjectBundle: %s has no chunk %s",
+					qPrintable( _file ), qPrintable( c.key ) );
+			return false;
+		}
+		if( !file.seek( pos ) ||
+			file.write( c.data ) != c.data.size() )
+		{
+			qWarning( "ProjectBundle: Can not write %s",
+							qPrintable( _file ) );
+			return false;
+		}
+		const Entry e = { pos, c.data.size(), c.tag };
+		table.insert( c.key, e );
+		pos = align( pos + c.data.size() );
+	}
+
+	// the new table may only reach the disk after the chunks it lists
+	if( !syncFile( file ) )
+	{
+		qWarning( "ProjectBundle: Can not write %s", qPrintable( _file ) );
+		return false;
+	}
+
+	return writeTable( file, pos, table );
+}
+
+
+
+
+QHash<QString, quint64> ProjectBundle::chunkTags( const QString & _file )
+{
+	QHash<QString, quint64> tags;
+	QFile file( _file );
+	Table table;
+	if( file.open( QIODevice::ReadOnly ) && readTable( file, table ) )
+	{
+		for( Table::const_iterator it = table.constBegin();
+						it != table.constEnd(); ++it )
+		{
+			tags.insert( it.key(), it->tag );
+		}
+	}
+	return tags;
+}
+
+
+
+
+bool ProjectBundle::readTable( QFile & _file, Table & _table )
+{
+	_table.clear();
+	if( !_file.seek( 0 ) )
+	{
+		return false;
+	}
+
+	QDataStream in( &_file );
+	quint32 magic, version;
+	qint64 offset, size;
+	quint64 check;
+	in >> magic >> version >> offset >> size >> check;
+	if( in.status() != QDataStream::Ok || magic != BUNDLE_MAGIC ||
+		version != BUNDLE_VERSION || offset < BUNDLE_PAGE || size < 0 ||
+		offset + size > _file.size() || !_file.seek( offset ) )
+	{
+		return false;
+	}
+
+	const QByteArray data = _file.read( size );
+	if( data.size() != size || fingerprint( data ) != check )
+	{
+		return false;
+	}
+
+	QDataStream table( data );
+	qint32 count;
+	table >> count;
+	for( int i = 0; i < count && table.status() == QDataStream::Ok; ++i )
+	{
+		QString key;
+		Entry e;
+		table >> key >> e.offset >> e.size >> e.tag;
+		if( e.offset < BUNDLE_PAGE || e.size < 0 ||
+					e.offset + e.size > offset )
+		{
+			_table.clear();
+			return false;
+		}
+		_table.insert( key, e );
+	}
+	if( table.status() != QDataStream::Ok )
+	{
+		_table.clear();
+		return false;
+	}
+	return true;
+}
+
+
+
+
+bool ProjectBundle::readChunk( QFile & _file, const Table & _table,
+							Chunk & _chunk )
+{
+	Table::const_iterator it = _table.constFind( _chunk.key );
+	if( it == _table.constEnd() || it->tag != _chunk.tag ||
+							!_file.seek( it->offset ) )
+	{
+		qWarning( "ProjectBundle: %s has no chunk %s",
+			qPrintable( _file.fileName() ), qPrintable( _chunk.key ) );
+		return false;
+	}
+	_chunk.data = _file.read( it->size );
+	if( _chunk.data.size() != it->size )
+	{
+		qWarning( "ProjectBundle: Can not read %s",
+					qPrintable( _file.fileName() ) );
+		return false;
+	}
+	return true;
+}
+
+
+
+
+bool ProjectBundle::writeTable( QFileDevice & _file, qint64 _pos,
+							const Table & _table )
+{
+	QByteArray data;
+	QDataStream table( &data, QIODevice::WriteOnly );
+	table << (qint32) _table.size();
+	for( Table::const_iterator it = _table.constBegin();
+						it != _table.constEnd(); ++it )
+	{
+		table << it.key() << it->offset << it->size << it->tag;
+	}
+
+	if( !_file.seek( _pos ) || _file.write( data ) != data.size() ||
+							!syncFile( _file ) )
+	{
+		qWarning( "ProjectBundle: Can not write %s",
+						qPrintable( _file.fileName() ) );
+		return false;
+	}
+
+	QByteArray header;
+	QDataStream out( &header, QIODevice::WriteOnly );
+	out << BUNDLE_MAGIC << BUNDLE_VERSION << _pos << (qint64) data.size()
+						<< fingerprint( data );
+	Q_ASSERT( header.size() == HEADER_BYTES );
+
+	// the header lies within one sector, so it's replaced as a whole
+	return _file.seek( 0 ) && _file.write( header ) == header.size() &&
+							syncFile( _file );
+}
+
+
+
+
+bool ProjectBundle::writeFresh( const QString & _file,
+					const QList<Chunk> & _chunks )
+{
+	// replaces _file only once everything is written
+	QSaveFile file( _file );
+	if( !file.open( QIODevice::WriteOnly ) )
+	{
+		qWarning( "ProjectBundle: Can not write %s",
+						qPrintable( _file ) );
+		return false;
+	}
+
+	Table table;
+	qint64 pos = BUNDLE_PAGE;
+	foreach( const Chunk & c, _chunks )
+	{
+		if( c.data.isNull() )
+		{
+			qWarning( "ProjectBundle: %s has no chunk %s",
+					qPrintable( _file ), qPrintable( c.key ) );
+			file.cancelWriting();
+			return false;
+		}
+		if( !file.seek( pos ) ||
+			file.write( c.data ) != c.data.size() )
+		{
+			qWarning( "ProjectBundle: Can not write %s",
+							qPrintable( _file ) );
+			file.cancelWriting();
+			return false;
+		}
+		const Entry e = { pos, c.data.size(), c.tag };
+		table.insert( c.key, e );
+		pos = align( pos + c.data.size() );
+	}
+
+	if( !writeTable( file, pos, table ) )
+	{
+		file.cancelWriting();
+		return false;
+	}
+	return file.commit();
+}
@@ -24,6 +24,8 @@
 
 #include <cstdlib>
 
+#include <QDataStream>
+
 #include "ProjectJournal.h"
 #include "Engine.h"
 #include "JournallingObject.h"
@@ -33,10 +35,15 @@ static const int EO_ID_MSB = 1 << 23;
 
 const int ProjectJournal::MAX_UNDO_STATES = 100; // TODO: make this configurable in settings
 
+// every n-th check point is a full XML state even if the object supports
+// compact journal data, so anything the compact data misses gets restored
+static const int FULL_CHECK_POINT_INTERVAL = 32;
+
 ProjectJournal::ProjectJournal() :
 	m_joIDs(),
 	m_undoCheckPoints(),
 	m_redoCheckPoints(),
+	m_compactCheckPoints( 0 ),
 	m_journalling( false )
 {
 }
@@ -60,13 +67,14 @@ void ProjectJournal::undo()
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
+			if( !fitsState( jo, c ) &&
+				!fallBackToFullState( m_undoCheckPoints, c ) )
+			{
+				break;
+			}
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			m_redoCheckPoints.push( swapCheckPoint( jo, c ) );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -85,13 +93,14 @@ void ProjectJournal::redo()
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
+			if( !fitsState( jo, c ) &&
+				!fallBackToFullState( m_redoCheckPoints, c ) )
+			{
+				break;
+			}
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			m_undoCheckPoints.push( swapCheckPoint( jo, c ) );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -117,10 +126,17 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 	{
 		m_redoCheckPoints.clear();
 
-		DataFile dataFile( DataFile::JournalData );
-		jo->saveState( dataFile, dataFile.content() );
+		const bool full =
+			m_compactCheckPoints >= FULL_CHECK_POINT_INTERVAL - 1;
+		const CheckPoint c = saveCheckPoint( jo, full );
+		if( c.kind == CheckPoint::CompactState )
+		{
+			diffPrevious( jo, c );
+		}
+		m_compactCheckPoints = c.kind == CheckPoint::FullState ?
+					0 : m_compactCheckPoints + 1;
 
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
+		m_undoCheckPoints.push( c );
 		if( m_undoCheckPoints.size() > MAX_UNDO_STATES )
 		{
 			m_undoCheckPoints.remove( 0, m_undoCheckPoints.size() - MAX_UNDO_STATES );
@@ -131,6 +147,157 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 
 
 
+ProjectJournal::CheckPoint ProjectJournal::saveCheckPoint(
+					JournallingObject * jo, bool full )
+{
+	if( !full )
+	{
+		QByteArray data;
+		QDataStream out( &data, QIODevice::WriteOnly );
+		if( jo->saveJournalData( out ) )
+		{
+			return CheckPoint( jo->id(), CheckPoint::CompactState,
+									data );
+		}
+	}
+
+	DataFile dataFile( DataFile::JournalData );
+	jo->saveState( dataFile, dataFile.content() );
+	return CheckPoint( jo->id(), CheckPoint::FullState,
+				qCompress( dataFile.toByteArray( 0 ) ) );
+}
+
+
+
+
+ProjectJournal::CheckPoint ProjectJournal::swapCheckPoint(
+				JournallingObject * jo, const CheckPoint & c )
+{
+	CheckPoint back = saveCheckPoint( jo,
+				c.kind == CheckPoint::FullState );
+
+	switch( c.kind )
+	{
+		case CheckPoint::FullState:
+		{
+			DataFile dataFile( qUncompress( c.data ) );
+			jo->restoreState( dataFile.content().firstChildElement() );
+			break;
+		}
+		case CheckPoint::CompactState:
+		{
+			QDataStream in( c.data );
+			jo->restoreJournalData( in );
+			break;
+		}
+		case CheckPoint::Diff:
+		{
+			// undo() and redo() checked the base with fitsState()
+			QDataStream in( c.data );
+			jo->applyJournalDiff( in );
+			break;
+		}
+	}
+
+	// kept as the changes back from the restored state
+	if( back.kind == CheckPoint::CompactState )
+	{
+		QByteArray restored;
+		QDataStream out( &restored, QIODevice::WriteOnly );
+		if( jo->saveJournalData( out ) )
+		{
+			makeDiff( jo, back, restored );
+		}
+	}
+	return back;
+}
+
+
+
+
+bool ProjectJournal::fitsState( JournallingObject * jo, const CheckPoint & c )
+{
+	if( c.kind != CheckPoint::Diff )
+	{
+		return true;
+	}
+	QByteArray data;
+	QDataStream out( &data, QIODevice::WriteOnly );
+	return jo->saveJournalData( out ) && qHash( data ) == c.base;
+}
+
+
+
+
+bool ProjectJournal::fallBackToFullState( CheckPointStack & stack,
+								CheckPoint & c )
+{
+	qWarning( "ProjectJournal: object %d changed without a check point, "
+			"falling back to its last full check point", c.joID );
+
+	// the check points of the object before the full one build on the
+	// rejected diff, so they are dropped as well
+	for( int i = stack.size() - 1; i >= 0; --i )
+	{
+		if( stack[i].joID != c.joID )
+		{
+			continue;
+		}
+		const CheckPoint prev = stack[i];
+		stack.remove( i );
+		if( prev.kind == CheckPoint::FullState )
+		{
+			c = prev;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+bool ProjectJournal::makeDiff( JournallingObject * jo, CheckPoint & c,
+						const QByteArray & from )
+{
+	QByteArray diff;
+	QDataStream out( &diff, QIODevice::WriteOnly );
+	if( !jo->diffJournalData( from, c.data, out ) ||
+					diff.size() >= c.data.size() )
+	{
+		return false;
+	}
+	c.kind = CheckPoint::Diff;
+	c.base = qHash( from );
+	c.data = diff;
+	return true;
+}
+
+
+
+
+void ProjectJournal::diffPrevious( JournallingObject * jo,
+						const CheckPoint & c )
+{
+	// the state following the last check point of the object is the one
+	// it has now, since the editors add one before every change
+	for( int i = m_undoCheckPoints.size() - 1; i >= 0; --i )
+	{
+		CheckPoint & prev = m_undoCheckPoints[i];
+		if( prev.joID == c.joID )
+		{
+			if( prev.kind == CheckPoint::CompactState )
+			{
+				makeDiff( jo, prev, c.data );
+			}
+			return;
+		}
+	}
+}
+
+
+
+
 jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 {
 	jo_id_t id;
@@ -171,6 +338,7 @@ void ProjectJournal::clearJournal()
 {
 	m_undoCheckPoints.clear();
 	m_redoCheckPoints.clear();
+	m_compactCheckPoints = 0;
 
 	for( JoIdMap::Iterator it = m_joIDs.begin(); it != m_joIDs.end(); )
 	{
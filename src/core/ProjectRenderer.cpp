@@ -24,8 +24,13 @@
 
 #include "ProjectRenderer.h"
 
+#include <cmath>
+
 //#include <QFile>
 //#include <QProcess>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
 
 #include "AudioFileAU.h"
 #include "AudioFileFlac.h"
@@ -104,7 +109,8 @@ ProjectRenderer::ProjectRenderer(
       QThread(_rm),
       // QThread(Engine::mixer()),
       m_fileDev(NULL), m_qualitySettings(qualitySettings), m_progress(0),
-      m_abort(false)
+      m_abort(false), m_segment(false), m_writeFrom(0), m_cut(0),
+      m_overlap(0), m_framesRendered(0)
 {
     setObjectName("project renderer " + outputFilename);
     AudioFileDeviceInstantiaton audioEncoderFactory
@@ -152,6 +158,105 @@ QString ProjectRenderer::getFileExtensionFromFormat(ExportFileFormats fmt)
     return fileEncodeDevices[fmt].m_extension;
 }
 
+void ProjectRenderer::setSegment(tick_t writeFrom, tick_t cut, f_cnt_t overlap)
+{
+    m_segment   = true;
+    m_writeFrom = writeFrom;
+    m_cut       = cut;
+    m_overlap   = overlap;
+}
+
+// periods are collected into blocks of at least this many frames before
+// they are handed to the encoder
+static const f_cnt_t OFFLINE_BLOCK_FRAMES = 4096;
+static const int     OFFLINE_QUEUE_BLOCKS = 4;
+
+// Writes rendered blocks from its own thread, so encoding (ogg, mp3, ...)
+// and disk I/O overlap with rendering. The rendering thread waits when
+// all blocks are queued.
+class OfflineEncoder : public QThread
+{
+  public:
+    struct Block
+    {
+        surroundSampleFrame* data;
+        f_cnt_t              frames;
+    };
+
+    OfflineEncoder(AudioFileDevice* dev, f_cnt_t capacity) : m_dev(dev)
+    {
+        for(int i = 0; i < OFFLINE_QUEUE_BLOCKS; ++i)
+        {
+            Block b = {new surroundSampleFrame[capacity], 0};
+            m_free.enqueue(b);
+        }
+    }
+
+    virtual ~OfflineEncoder()
+    {
+        for(const Block& b : m_free)
+            delete[] b.data;
+        for(const Block& b : m_full)
+            delete[] b.data;
+    }
+
+    Block acquire()
+    {
+        QMutexLocker lock(&m_mutex);
+        while(m_free.isEmpty())
+            m_freed.wait(&m_mutex);
+        return m_free.dequeue();
+    }
+
+    void submit(const Block& b)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_full.enqueue(b);
+        m_filled.wakeOne();
+    }
+
+    // writes everything submitted so far and stops the thread
+    void finish()
+    {
+        Block end = {NULL, 0};
+        submit(end);
+        wait();
+    }
+
+  protected:
+    virtual void run()
+    {
+        forever
+        {
+            Block b;
+            {
+                QMutexLocker lock(&m_mutex);
+                while(m_full.isEmpty())
+                    m_filled.wait(&m_mutex);
+                b = m_full.dequeue();
+            }
+            if(b.data == NULL)
+                return;
+
+            // the master gain is applied to the blocks already
+            if(b.frames > 0)
+                m_dev->writeBlock(b.data, b.frames, 1.0f);
+
+            QMutexLocker lock(&m_mutex);
+            m_free.enqueue(b);
+            m_freed.wakeOne();
+        }
+    }
+
+  private:
+    AudioFileDevice* m_dev;
+    QMutex           m_mutex;
+    QWaitCondition   m_freed;
+    QWaitCondition   m_filled;
+    QQueue<Block>    m_free;
+    QQueue<Block>    m_full;
+};
+
 void ProjectRenderer::startProcessing()
 {
     qInfo("ProjectRenderer::startProcessing #1");
@@ -204,21 +309,119 @@ void ProjectRenderer::run()
     tick_t endTick     = exportEndpoints.second.getTicks();
     tick_t lengthTicks = endTick - startTick;
 
+    // a period may come out longer after resampling to the file's rate,
+    // and a block is only closed after the period that filled it
+    const f_cnt_t periodFrames
+            = Engine::mixer()->framesPerPeriod() * m_fileDev->sampleRate()
+                      / Engine::mixer()->processingSampleRate()
+              + 1;
+    OfflineEncoder encoder(m_fileDev, OFFLINE_BLOCK_FRAMES + periodFrames);
+    encoder.start();
+
+    m_framesRendered = 0;
+    m_renderTimer.start();
+
+    // the file may have another rate than the mixer
+    const float fileFramesPerFrame
+            = float(m_fileDev->sampleRate())
+              / Engine::mixer()->processingSampleRate();
+    // frames written so far and where tick m_cut begins in the file
+    f_cnt_t written  = 0;
+    f_cnt_t cutFrame = -1;
+
     // Continually track and emit progress percentage to listeners
-    while(exportPos.getTicks() < endTick
-          && Engine::getSong()->isExporting() == true && !m_abort)
+    bool done = false;
+    while(!done)
     {
-        m_fileDev->processNextBuffer();
-        const int nprog = lengthTicks == 0
-                                  ? 100
-                                  : (exportPos.getTicks() - startTick) * 100
-                                            / lengthTicks;
-        if(m_progress != nprog)
+        OfflineEncoder::Block b = encoder.acquire();
+        b.frames                = 0;
+        while(b.frames < OFFLINE_BLOCK_FRAMES)
         {
-            m_progress = nprog;
-            emit progressChanged(m_progress);
+            if(exportPos.getTicks() >= endTick
+               || Engine::getSong()->isExporting() == false || m_abort)
+            {
+                done = true;
+                break;
+            }
+
+            const tick_t periodTick  = exportPos.getTicks();
+            const float  periodFrame = exportPos.currentFrame();
+            const float  framesPerTick = Engine::framesPerTick();
+
+            fpp_t frames = m_fileDev->renderNextBuffer(b.data + b.frames);
+            if(frames == 0)
+            {
+                done = true;
+                break;
+            }
+
+            if(m_segment)
+            {
+                // where a tick begins in this period
+                auto frameOf = [&](tick_t tick) {
+                    return f_cnt_t(lroundf(
+                            ((tick - periodTick) * framesPerTick - periodFrame)
+                            * fileFramesPerFrame));
+                };
+
+                fpp_t skip = 0;
+                if(periodTick < m_writeFrom)
+                {
+                    skip = qBound<f_cnt_t>(0, frameOf(m_writeFrom), frames);
+                    memmove(b.data + b.frames, b.data + b.frames + skip,
+                            (frames - skip) * sizeof(surroundSampleFrame));
+                }
+                if(m_overlap > 0 && cutFrame < 0)
+                {
+                    const f_cnt_t cut = frameOf(m_cut);
+                    if(cut < frames)
+                    {
+                        cutFrame = written + qMax<f_cnt_t>(cut - skip, 0);
+                    }
+                }
+                frames -= skip;
+                if(cutFrame >= 0 && written + frames >= cutFrame + m_overlap)
+                {
+                    frames = cutFrame + m_overlap - written;
+                    done   = true;
+                }
+                written += frames;
+            }
+
+            // the master volume may be automated, so its gain is applied
+            // to each period instead of to the whole block
+            const float gain = Engine::mixer()->masterGain();
+            if(gain != 1.0f)
+            {
+                surroundSampleFrame* period = b.data + b.frames;
+                for(fpp_t f = 0; f < frames; ++f)
+                {
+                    for(ch_cnt_t ch = 0; ch < SURROUND_CHANNELS; ++ch)
+                    {
+                        period[f][ch] *= gain;
+                    }
+                }
+            }
+            b.frames += frames;
+            if(done)
+            {
+                break;
+            }
+
+            const int nprog = lengthTicks == 0
+                                      ? 100
+                                      : (exportPos.getTicks() - startTick) * 100
+                                                / lengthTicks;
+            if(m_progress != nprog)
+            {
+                m_progress = nprog;
+                emit progressChanged(m_progress);
+            }
         }
+        m_framesRendered += b.frames;
+        encoder.submit(b);
     }
+    encoder.finish();
 
     // notify mixer of the end of processing
     Engine::mixer()->stopProcessing();
@@ -247,7 +450,16 @@ void ProjectRenderer::updateConsoleProgress()
 
     const char* activity = (const char*)"|/-\\";
     memset(buf, 0, sizeof(buf));
-    sprintf(buf, "\r|%s|    %3d%%   %c  ", prog, m_progress, activity[rot]);
+    // how much faster than playback we are
+    const qint64 elapsed = m_renderTimer.isValid() ? m_renderTimer.elapsed() : 0;
+    const double factor
+            = elapsed > 0 && isReady()
+                      ? m_framesRendered * 1000.0
+                                / (m_fileDev->sampleRate() * double(elapsed))
+                      : 0.0;
+
+    snprintf(buf, sizeof(buf), "\r|%s|    %3d%%   %c  %6.1fx  ", prog,
+             m_progress, activity[rot], factor);
     rot = (rot + 1) % 4;
 
     fprintf(stderr, "%s", buf);
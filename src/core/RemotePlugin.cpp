@@ -327,6 +327,9 @@ bool RemotePlugin::process( const sampleFrame * _in_buf,
 		}
 	}
 
+	MixerProfiler & profiler = Engine::mixer()->profiler();
+	const qint64 traceBegin = profiler.traceTime();
+
 	lock();
 	sendMessage( IdStartProcessing );
 
@@ -339,6 +342,12 @@ bool RemotePlugin::process( const sampleFrame * _in_buf,
 	waitForMessage( IdProcessingDone );
 	unlock();
 
+	if( profiler.isTracing() )
+	{
+		profiler.traceNode( "remoteplugin", m_process.program(),
+								traceBegin );
+	}
+
 	const ch_cnt_t outputs = qMin<ch_cnt_t>( m_outputCount,
 							DEFAULT_CHANNELS );
 	if( m_splitChannels )
@@ -40,7 +40,8 @@ RenderManager::RenderManager(const Mixer::qualitySettings& qualitySettings,
       m_qualitySettings(qualitySettings),
       m_oldQualitySettings(Engine::mixer()->currentQualitySettings()),
       m_outputSettings(outputSettings), m_format(fmt),
-      m_outputPath(outputPath), m_activeRenderer(NULL)
+      m_outputPath(outputPath), m_activeRenderer(NULL), m_segment(false),
+      m_segmentWriteFrom(0), m_segmentCut(0), m_segmentOverlap(0)
 {
     Engine::mixer()->storeAudioDevice();
 }
@@ -207,6 +208,14 @@ void RenderManager::renderTracks()
     renderNextTrack();
 }
 
+void RenderManager::setSegment(tick_t writeFrom, tick_t cut, f_cnt_t overlap)
+{
+    m_segment          = true;
+    m_segmentWriteFrom = writeFrom;
+    m_segmentCut       = cut;
+    m_segmentOverlap   = overlap;
+}
+
 // Render the song into a single track
 void RenderManager::renderProject()
 {
@@ -216,6 +225,12 @@ void RenderManager::renderProject()
                                   m_format, m_outputPath, this);
     qInfo("RenderManager::renderProject #2");
 
+    if(m_segment)
+    {
+        m_activeRenderer->setSegment(m_segmentWriteFrom, m_segmentCut,
+                                     m_segmentOverlap);
+    }
+
     if(m_activeRenderer->isReady())
     {
         // pass progress signals through
@@ -0,0 +1,229 @@
+/*
+ * RenderService.cpp - long running headless renderer fed from a spool
+ *                     directory
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RenderService.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include "RenderManager.h"
+#include "Song.h"
+
+static const int POLL_INTERVAL = 500;  // ms
+
+RenderService::RenderService(
+        const QString&                     spoolDir,
+        const Mixer::qualitySettings&      qualitySettings,
+        const OutputSettings&              outputSettings,
+        ProjectRenderer::ExportFileFormats fmt) :
+      m_spool(spoolDir),
+      m_qualitySettings(qualitySettings), m_outputSettings(outputSettings),
+      m_format(fmt), m_manager(NULL), m_loadTime(0), m_progress(0)
+{
+    connect(&m_pollTimer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+RenderService::~RenderService()
+{
+    if(m_manager != NULL)
+    {
+        m_manager->abortProcessing();
+        delete m_manager;
+        finishJob("aborted");
+    }
+}
+
+bool RenderService::start()
+{
+    if(!m_spool.exists())
+    {
+        qCritical("Error: spool directory %s does not exist",
+                  qPrintable(m_spool.path()));
+        return false;
+    }
+
+    qWarning("Serving render jobs from %s",
+             qPrintable(m_spool.absolutePath()));
+    m_pollTimer.start(POLL_INTERVAL);
+    poll();
+    return true;
+}
+
+void RenderService::poll()
+{
+    if(m_manager != NULL)
+    {
+        return;
+    }
+
+    const QStringList jobs = m_spool.entryList(
+            QStringList("*.job"), QDir::Files | QDir::Readable, QDir::Name);
+    for(const QString& job : jobs)
+    {
+        // claiming fails if another service took the job first
+        const QString running = m_spool.filePath(job + ".running");
+        if(!QFile::rename(m_spool.filePath(job), running))
+        {
+            continue;
+        }
+        if(startJob(running))
+        {
+            return;
+        }
+    }
+}
+
+bool RenderService::startJob(const QString& job)
+{
+    m_jobFile  = job;
+    m_jobName  = QFileInfo(job).fileName();
+    m_jobName.chop(QString(".job.running").length());
+    m_progress = 0;
+    m_jobTimer.start();
+
+    QSettings settings(job, QSettings::IniFormat);
+    const QString project = settings.value("project").toString();
+    const bool    tracks  = settings.value("tracks", false).toBool();
+
+    ProjectRenderer::ExportFileFormats fmt = m_format;
+    m_outputPath = settings.value("output").toString();
+    if(settings.contains("format"))
+    {
+        fmt = ProjectRenderer::getFileFormatFromExtension(
+                "." + settings.value("format").toString());
+    }
+    else if(!m_outputPath.isEmpty() && !tracks)
+    {
+        fmt = ProjectRenderer::getFileFormatFromExtension(
+                "." + QFileInfo(m_outputPath).suffix());
+    }
+    if(m_outputPath.isEmpty())
+    {
+        m_outputPath = m_spool.filePath(
+                m_jobName
+                + (tracks ? QString()
+                          : ProjectRenderer::getFileExtensionFromFormat(fmt)));
+    }
+    if(tracks && !QDir().mkpath(m_outputPath))
+    {
+        finishJob("can not create output directory");
+        return false;
+    }
+
+    qWarning("Job %s: loading %s", qPrintable(m_jobName),
+             qPrintable(project));
+    if(project.isEmpty() || !QFileInfo(project).isReadable())
+    {
+        finishJob("can not read project");
+        return false;
+    }
+
+    Engine::getSong()->loadProject(project);
+    m_loadTime = m_jobTimer.elapsed();
+    if(Engine::getSong()->isEmpty())
+    {
+        finishJob("project is empty");
+        return false;
+    }
+    // e.g. samples which could not be loaded
+    if(Engine::getSong()->hasErrors())
+    {
+        finishJob(Engine::getSong()->errorSummary().trimmed());
+        return false;
+    }
+
+    Engine::getSong()->setExportLoop(settings.value("loop", false).toBool());
+
+    m_manager = new RenderManager(m_qualitySettings, m_outputSettings, fmt,
+                                  m_outputPath);
+    connect(m_manager, SIGNAL(progressChanged(int)), this,
+            SLOT(jobProgress(int)));
+    connect(m_manager, SIGNAL(finished()), this, SLOT(jobFinished()));
+
+    if(tracks)
+    {
+        m_manager->renderTracks();
+    }
+    else
+    {
+        m_manager->renderProject();
+    }
+    return true;
+}
+
+void RenderService::jobProgress(int progress)
+{
+    if(progress == m_progress)
+    {
+        return;
+    }
+    m_progress = progress;
+
+    QSettings settings(m_jobFile, QSettings::IniFormat);
+    settings.setValue("result/progress", progress);
+    fprintf(stderr, "Job %s: %d%%\n", qPrintable(m_jobName), progress);
+}
+
+void RenderService::jobFinished()
+{
+    // the manager may still be on the stack of the emitting renderer.
+    // The next job is started by the poll timer, after it is gone and
+    // has given the audio device back to the mixer.
+    m_manager->deleteLater();
+    m_manager = NULL;
+
+    finishJob(QFileInfo(m_outputPath).exists() ? QString()
+                                               : "no output written");
+}
+
+void RenderService::finishJob(const QString& error)
+{
+    const qint64 total = m_jobTimer.elapsed();
+    {
+        QSettings settings(m_jobFile, QSettings::IniFormat);
+        settings.setValue("result/status", error.isEmpty() ? "done" : "failed");
+        if(!error.isEmpty())
+        {
+            settings.setValue("result/error", error);
+        }
+        settings.setValue("result/output", m_outputPath);
+        settings.setValue("result/load_ms", m_loadTime);
+        settings.setValue("result/render_ms", total - m_loadTime);
+        settings.setValue("result/total_ms", total);
+    }
+
+    // <name>.job.running -> <name>.job.done / <name>.job.failed
+    QString finished = m_jobFile;
+    finished.chop(QString(".running").length());
+    finished += error.isEmpty() ? ".done" : ".failed";
+    QFile::remove(finished);
+    QFile::rename(m_jobFile, finished);
+
+    qWarning("Job %s: %s in %lld ms (loading %lld ms)", qPrintable(m_jobName),
+             error.isEmpty() ? "done" : qPrintable(error), total, m_loadTime);
+
+    m_jobFile.clear();
+    m_jobName.clear();
+    m_loadTime = 0;
+}
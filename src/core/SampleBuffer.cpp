@@ -29,11 +29,17 @@
 #include "Backtrace.h"
 
 #include <QBuffer>
+#include <QCoreApplication>
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
 #include <QHash>
 #include <QMessageBox>
+#include <QMutex>
 #include <QPainter>
+#include <QSaveFile>
+#include <QtConcurrent>
 
 #include <sndfile.h>
 
@@ -53,12 +59,14 @@
 #include "SampleBuffer.h"
 
 #include "ConfigManager.h"
+#include "DataFile.h"
 #include "DrumSynth.h"
 #include "endian_handling.h" // REQUIRED
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "Mixer.h"
 #include "FileDialog.h"
+#include "Song.h"
 
 
 SampleBuffer::SampleBuffer( const SampleBuffer& _other ) :
@@ -75,7 +83,8 @@ SampleBuffer::SampleBuffer( const SampleBuffer& _other ) :
 	m_amplification( _other.m_amplification ),
 	m_reversed( _other.m_reversed ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_revision( 0 )
 {
         if(!m_mmapped)
 	{
@@ -106,7 +115,8 @@ SampleBuffer::SampleBuffer( const QString & _audioFile,
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_revision( 0 )
 {
 	if( _isBase64Data == true )
 	{
@@ -139,7 +149,8 @@ SampleBuffer::SampleBuffer( const sampleFrame * _data,
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_revision( 0 )
 {
 	if( _frames > 0 )
 	{
@@ -173,7 +184,8 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames,
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_revision( 0 )
 {
         if( _frames > 0 )
 	{
@@ -207,11 +219,129 @@ void SampleBuffer::sampleRateChanged()
 	update( true );
 }
 
+// shared by the GUI thread and the decoders of preloadAudioFiles()
 static QHash<QString,sampleFrame*> s_mmap_pointer;
 static QHash<QString,QFile*>       s_mmap_file;
+static QMutex                      s_mmapMutex;
+
+// File size and sample length limits
+static const int SAMPLE_FILE_SIZE_MAX = 1024; // MB
+static const int SAMPLE_LENGTH_MAX = 90; // Minutes
+
+static QHash<QString,QFuture<SampleBuffer*> > s_preloaded;
+static QMutex s_preloadedMutex;
+
+// set on the pool threads decoding for preloadAudioFiles(), whose buffers
+// must neither wait for their own entry nor report errors
+static thread_local bool t_preloading = false;
+
+
+static SampleBuffer* preloadAudioFile(QString _filename)
+{
+	// files over the limits are left to update() which reports them
+	if(QFileInfo(_filename).size() > SAMPLE_FILE_SIZE_MAX * 1024 * 1024)
+		return NULL;
+
+	if(!_filename.endsWith(".mp3"))
+	{
+		SF_INFO sf_info;
+		sf_info.format = 0;
+		SNDFILE* snd_file=sf_open(_filename.toUtf8().constData(),SFM_READ,&sf_info);
+		if(snd_file!=NULL)
+		{
+			sf_close(snd_file);
+			if(sf_info.samplerate>0 &&
+			   sf_info.frames / sf_info.samplerate > SAMPLE_LENGTH_MAX * 60)
+				return NULL;
+		}
+	}
+
+	t_preloading=true;
+	SampleBuffer* r=new SampleBuffer(_filename,false,false);
+	t_preloading=false;
+	r->moveToThread(QCoreApplication::instance()->thread());
+	return r;
+}
+
+
+void SampleBuffer::preloadAudioFiles(const QStringList & _files)
+{
+	const QString cchext="."+rawStereoSuffix();
+
+	QMutexLocker locker(&s_preloadedMutex);
+	foreach(const QString& f,_files)
+	{
+		if(f.isEmpty()) continue;
+
+		QString filename=tryToMakeAbsolute(f);
+		// raw caches are mapped, not decoded
+		if(filename.endsWith(cchext) ||
+		   QFile(filename+cchext).exists() ||
+		   s_preloaded.contains(filename) ||
+		   !QFileInfo(filename).isFile())
+			continue;
+
+		s_preloaded.insert(filename,QtConcurrent::run(preloadAudioFile,filename));
+	}
+}
+
+
+void SampleBuffer::clearPreloadedAudioFiles()
+{
+	QMutexLocker locker(&s_preloadedMutex);
+	foreach(QFuture<SampleBuffer*> future,s_preloaded)
+		delete future.result();
+	s_preloaded.clear();
+}
+
+
+bool SampleBuffer::adoptPreloaded(const QString & _filename, bool _keepSettings)
+{
+	QFuture<SampleBuffer*> future;
+	{
+		QMutexLocker locker(&s_preloadedMutex);
+		if(!s_preloaded.contains(_filename)) return false;
+		future=s_preloaded.take(_filename);
+	}
+
+	SampleBuffer* sb=future.result();
+	if(sb==NULL) return false;
+
+	// decoded without reversing, at the base rate of the time
+	// failed, update() decodes again and reports it on this thread
+	if(m_reversed ||
+	   sb->m_mmapped ||
+	   sb->m_data==NULL ||
+	   sb->m_frames<=1 ||
+	   sb->m_sampleRate!=Engine::mixer()->baseSampleRate())
+	{
+		delete sb;
+		return false;
+	}
+
+	if(m_origData && !m_mmapped) MM_FREE(m_origData);
+	m_origData=NULL;
+	m_origFrames=0;
+	m_mmapped=false;
+
+	m_data=sb->m_data;
+	m_frames=sb->m_frames;
+	sb->m_data=NULL;
+	sb->m_frames=0;
+	delete sb;
+
+	if( _keepSettings == false )
+	{
+		m_loopStartFrame = m_startFrame = 0;
+		m_loopEndFrame = m_endFrame = m_frames;
+	}
+
+	return true;
+}
 
 void SampleBuffer::clearMMap()
 {
+	QMutexLocker locker(&s_mmapMutex);
 	s_mmap_pointer.clear();
 	foreach(QFile* f,s_mmap_file)
 	{
@@ -224,6 +354,7 @@ void SampleBuffer::clearMMap()
 void SampleBuffer::update( bool _keepSettings )
 {
         //qInfo("SampleBuffer::update");
+	m_revision = nextRevision();
 	const bool lock = ( m_data != NULL );
 	if( lock )
 	{
@@ -239,9 +370,8 @@ void SampleBuffer::update( bool _keepSettings )
 		}
 	}
 
-	// File size and sample length limits
-	const int fileSizeMax = 1024; // MB
-	const int sampleLengthMax = 90; // Minutes
+	const int fileSizeMax = SAMPLE_FILE_SIZE_MAX;
+	const int sampleLengthMax = SAMPLE_LENGTH_MAX;
 
 	sample_rate_t samplerate = Engine::mixer()->baseSampleRate();
 	QString cchext="."+rawStereoSuffix();//QString(".f%1r%2").arg(DEFAULT_CHANNELS).arg(samplerate);
@@ -263,6 +393,11 @@ void SampleBuffer::update( bool _keepSettings )
 			m_loopEndFrame = m_endFrame = m_frames;
 		}
 	}
+	else if( !m_audioFile.isEmpty() && !t_preloading &&
+		 adoptPreloaded( tryToMakeAbsolute(m_audioFile), _keepSettings ) )
+	{
+		// decoded in advance by preloadAudioFiles()
+	}
 	else if( !m_audioFile.isEmpty() &&
 		 ( (filename=tryToMakeAbsolute(m_audioFile)).endsWith(cchext) ||
 		   QFile(filename+cchext).exists() ) )
@@ -271,6 +406,8 @@ void SampleBuffer::update( bool _keepSettings )
 		if(QFile(filename+cchext).exists()) filename+=cchext;
 		qInfo("SampleBuffer: Trying cache %s",qPrintable(filename));
 
+		QMutexLocker locker(&s_mmapMutex);
+
 		/*
 		if(n%BYTES_PER_FRAME!=0)
 		{
@@ -494,6 +631,8 @@ void SampleBuffer::update( bool _keepSettings )
 		m_loopEndFrame = m_endFrame = 1;
 	}
 
+	m_peaks.clear();
+
 	if( lock )
 	{
 		m_varLock.unlock();
@@ -502,7 +641,7 @@ void SampleBuffer::update( bool _keepSettings )
 
 	emit sampleUpdated();
 
-	if( fileLoadError )
+	if( fileLoadError && !t_preloading )
 	{
 		QString title = tr( "Fail to open file" );
 		QString message = tr( "Audio files are limited to %1 MB "
@@ -515,8 +654,14 @@ void SampleBuffer::update( bool _keepSettings )
 		}
 		else
 		{
+			// a render job fails with the song's error report instead of
+			// the whole process
 			qWarning("%s",qPrintable(message));
-			exit( EXIT_FAILURE );
+			if( Engine::getSong() )
+			{
+				Engine::getSong()->collectError( title + ": " +
+						m_audioFile + "\n" + message );
+			}
 		}
 	}
 
@@ -1286,6 +1431,27 @@ f_cnt_t SampleBuffer::findClosestZero(f_cnt_t _index)
 
 
 // fully rewriten. gi0e5b06
+void SampleBuffer::updatePeaks()
+{
+        // peaks of a mapped raw cache are kept next to it
+        QString cache,peaks;
+        if(m_mmapped && !m_audioFile.isEmpty())
+        {
+                const QString cchext="."+rawStereoSuffix();
+                cache=tryToMakeAbsolute(m_audioFile);
+                if(!cache.endsWith(cchext)) cache+=cchext;
+                peaks=cache+".peaks";
+                if(m_peaks.load(peaks,cache,m_frames)) return;
+        }
+
+        m_peaks.build(m_data,m_frames);
+
+        if(!peaks.isEmpty() &&
+           QFileInfo(QFileInfo(peaks).absolutePath()).isWritable())
+                m_peaks.save(peaks);
+}
+
+
 void SampleBuffer::visualize( QPainter & _p, const QRect & _r,
 			      const QRect & _clip, f_cnt_t _from, f_cnt_t _to)
 {
@@ -1303,32 +1469,72 @@ void SampleBuffer::visualize( QPainter & _p, const QRect & _r,
 	const int yr = _r.y();
 	const int wr = _r.width();
 	const int hr = _r.height();
+	const float yh = (hr-1.f)/2.f;
 
-	int nbp=qMin<int>(wr,_to-_from);
-	if(nbp<=1) return;
-        if(nbp>10000) nbp=10000;
-
-	QPointF* lc=new QPointF[nbp];
-	QPointF* rc=new QPointF[nbp];
+	// only painted from the GUI thread, keep the buffers around
+	static QVector<QPointF> lc,rc;
+	static QVector<QLineF> lp,rp,lrms,rrms;
 
-	for(int i=0;i<nbp;i++)
+	const f_cnt_t nbf=_to-_from;
+	if(nbf<=2*wr)
 	{
-                float tp=(float)i/(float)nbp;
-		f_cnt_t frame=_from+(_to-_from)*tp;
-		float xp =xr+(wr-1.f)/(nbp-1.f)*i;
-		float ypl=yr+(hr-1.f)/2.f*(1.f+m_amplification*m_data[frame][0]);
-		float ypr=yr+(hr-1.f)/2.f*(1.f+m_amplification*m_data[frame][1]);
-		lc[i]=QPointF(xp,ypl);
-		rc[i]=QPointF(xp,ypr);
+		// zoomed in, draw the frames themselves
+		const int nbp=qMin<int>(wr,nbf);
+		if(nbp<=1) return;
+
+		lc.resize(nbp);
+		rc.resize(nbp);
+		for(int i=0;i<nbp;i++)
+		{
+			float tp=(float)i/(float)nbp;
+			f_cnt_t frame=_from+nbf*tp;
+			float xp =xr+(wr-1.f)/(nbp-1.f)*i;
+			float ypl=yr+yh*(1.f+m_amplification*m_data[frame][0]);
+			float ypr=yr+yh*(1.f+m_amplification*m_data[frame][1]);
+			lc[i]=QPointF(xp,ypl);
+			rc[i]=QPointF(xp,ypr);
+		}
+
+		//_p.setRenderHint(QPainter::Antialiasing);
+		_p.setPen(Qt::black);
+		_p.drawPolyline(rc.constData(),nbp);
+		_p.setPen(Qt::white);
+		_p.drawPolyline(lc.constData(),nbp);
+		return;
+	}
+
+	// one min/max and one rms line per pixel, read from the peaks
+	if(m_peaks.frames()!=m_frames) updatePeaks();
+
+	lp.resize(wr);
+	rp.resize(wr);
+	lrms.resize(wr);
+	rrms.resize(wr);
+	const float a=m_amplification;
+	for(int x=0;x<wr;x++)
+	{
+		const f_cnt_t f0=_from+(qint64)nbf*x/wr;
+		const f_cnt_t f1=_from+(qint64)nbf*(x+1)/wr;
+		const SamplePeaks::Peak pk=m_peaks.peak(m_data,f0,f1);
+		const float xp=xr+x+0.5f;
+		lp[x]=QLineF(xp,yr+yh*(1.f+a*pk.min[0]),
+			     xp,yr+yh*(1.f+a*pk.max[0]));
+		rp[x]=QLineF(xp,yr+yh*(1.f+a*pk.min[1]),
+			     xp,yr+yh*(1.f+a*pk.max[1]));
+		lrms[x]=QLineF(xp,yr+yh*(1.f-a*pk.rms[0]),
+			       xp,yr+yh*(1.f+a*pk.rms[0]));
+		rrms[x]=QLineF(xp,yr+yh*(1.f-a*pk.rms[1]),
+			       xp,yr+yh*(1.f+a*pk.rms[1]));
 	}
 
-	//_p.setRenderHint(QPainter::Antialiasing);
         _p.setPen(Qt::black);
-	_p.drawPolyline(rc,nbp);
+	_p.drawLines(rp);
         _p.setPen(Qt::white);
-	_p.drawPolyline(lc,nbp);
-	delete[] lc;
-	delete[] rc;
+	_p.drawLines(lp);
+        _p.setPen(Qt::darkGray);
+	_p.drawLines(rrms);
+        _p.setPen(Qt::lightGray);
+	_p.drawLines(lrms);
 }
 
 /*
@@ -1596,6 +1802,96 @@ QString & SampleBuffer::toBase64( QString & _dst ) const
 
 
 
+void SampleBuffer::saveData( QDomDocument & _doc, QDomElement & _this,
+					const QString & _attr ) const
+{
+	DataFile * dataFile = dynamic_cast<DataFile *>( &_doc );
+	if( dataFile == NULL )
+	{
+		QString s;
+		_this.setAttribute( _attr, toBase64( s ) );
+		return;
+	}
+
+	// the bundles being written have this revision already
+	if( dataFile->hasChunk( m_revision ) )
+	{
+		dataFile->addBinaryData( _this, _attr, m_revision, QByteArray(),
+						std::function<QString()>() );
+		return;
+	}
+
+	// raw frames, the same layout as the uncompressed base64 data. The
+	// document may outlive this buffer, so it gets a copy.
+	const QByteArray data( (const char *) m_data,
+					m_frames * BYTES_PER_FRAME );
+	dataFile->addBinaryData( _this, _attr, m_revision, data,
+		[data]()
+		{
+			const SampleBuffer copy( (const sampleFrame *) data.constData(),
+					data.size() / BYTES_PER_FRAME, false );
+			QString s;
+			return copy.toBase64( s );
+		} );
+}
+
+
+
+
+bool SampleBuffer::loadData( const QDomElement & _this,
+						const QString & _attr )
+{
+	const QByteArray chunk = DataFile::binaryData( _this );
+	if( chunk.isNull() )
+	{
+		if( _this.attribute( _attr ).isEmpty() )
+		{
+			return false;
+		}
+		loadFromBase64( _this.attribute( _attr ) );
+		return true;
+	}
+
+	if( chunk.size() % BYTES_PER_FRAME != 0 )
+	{
+		qCritical( "SampleBuffer::loadData invalid data" );
+	}
+	m_origFrames = chunk.size() / BYTES_PER_FRAME;
+	if( !m_mmapped ) MM_FREE( m_origData );
+	else m_mmapped = false;
+	m_origData = MM_ALLOC( sampleFrame, m_origFrames );
+	memcpy( m_origData, chunk.constData(), m_origFrames * BYTES_PER_FRAME );
+
+	m_audioFile = QString();
+	update();
+
+	// unchanged since it was saved, the bundle can keep the chunk
+	m_revision = _this.attribute( "datachunk" ).toULongLong( NULL, 16 );
+	return true;
+}
+
+
+
+
+quint64 SampleBuffer::nextRevision()
+{
+	static QAtomicInteger<quint64> s_lastRevision( 0 );
+
+	const quint64 now =
+		quint64( QDateTime::currentMSecsSinceEpoch() ) << 16;
+	quint64 last = s_lastRevision.load();
+	quint64 next;
+	do
+	{
+		next = qMax( last + 1, now );
+	}
+	while( !s_lastRevision.testAndSetOrdered( last, next, last ) );
+	return next;
+}
+
+
+
+
 void SampleBuffer::resample( const sample_rate_t _srcSR,
                              const sample_rate_t _dstSR )
 {
@@ -1638,6 +1934,7 @@ void SampleBuffer::resample( const sample_rate_t _srcSR,
                 if(m_data!=m_origData) MM_FREE(m_data);
                 m_data=dst_data;
                 m_frames=dst_frames;
+                m_peaks.clear();
         }
         else MM_FREE(dst_data);
 }
@@ -1686,6 +1983,7 @@ void SampleBuffer::retune( //const sample_rate_t _srcSR,
                 if(m_data!=m_origData) MM_FREE(m_data);
                 m_data=dst_data;
                 m_frames=dst_frames;
+                m_peaks.clear();
 
                 //TODO: adjust points with ratio
         }
@@ -1737,7 +2035,12 @@ f_cnt_t SampleBuffer::decodeSampleMPG123(const char* _infile,
         int err = MPG123_OK;
         off_t samples = 0;
 
-        err = mpg123_init();
+        {
+                // mpg123_init() is not reentrant on older libmpg123
+                static QMutex s_initMutex;
+                QMutexLocker locker(&s_initMutex);
+                err = mpg123_init();
+        }
         if(err != MPG123_OK || (mh = mpg123_new(NULL, &err)) == NULL)
         {
                 qCritical("libmpg123: setup goes wrong: %s",
@@ -2100,6 +2403,8 @@ void SampleBuffer::setDataFrame(f_cnt_t _f,sample_t _ch0,sample_t _ch1)
         }
         m_origData[_f][0]=_ch0;
         m_origData[_f][1]=_ch1;
+        m_peaks.clear();
+        m_revision=nextRevision();
         if(_f==1000)
                 qInfo("SampleBuffer::setDataFrame f=%d ch0=%f ch1=%f",_f,_ch0,_ch1);
 }
@@ -2110,7 +2415,9 @@ void SampleBuffer::setDataFrame(f_cnt_t _f,sample_t _ch0,sample_t _ch1)
 void SampleBuffer::writeCacheData(QString _fileName) const
 {
         qInfo("SampleBuffer: Write cache %s",qPrintable(_fileName));
-        QFile file(_fileName);
+        // renamed when complete, the cache may be mapped meanwhile by
+        // another thread which sees it exist
+        QSaveFile file(_fileName);
         if(!file.open(QIODevice::WriteOnly))
                 qCritical("SampleBuffer: Can not write %s",qPrintable(_fileName));
         else
@@ -2123,10 +2430,12 @@ void SampleBuffer::writeCacheData(QString _fileName) const
                 quint64 n=m_frames*BYTES_PER_FRAME;
                 quint64 w=out.writeRawData((const char*)m_data,n);
                 if(n!=w)
+                {
+                        file.cancelWriting();
                         qWarning("SampleBuffer: Fail to fully write %s",qPrintable(_fileName));
-                else
+                }
+                if(file.commit())
                         qInfo("SampleBuffer: Cache written %s",qPrintable(_fileName));
-                file.close();
         }
 }
 
@@ -2201,6 +2510,12 @@ SampleBuffer::handleState::handleState( bool _varying_pitch, int interpolation_m
 	m_isBackwards( false )
 {
 	int error;
+	// voices starting during an overload resample more cheaply
+	if( Engine::mixer() != NULL )
+	{
+		interpolation_mode = Engine::mixer()->overloadManager().
+					interpolation( interpolation_mode );
+	}
 	m_interpolationMode = interpolation_mode;
 
 	if( ( m_resamplingData = src_new( interpolation_mode, DEFAULT_CHANNELS, &error ) ) == NULL )
@@ -0,0 +1,312 @@
+/*
+ * SamplePeaks.cpp - multi-resolution min/max/rms summary of sample data
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SamplePeaks.h"
+
+#include <cmath>
+#include <cfloat>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+
+static const quint32 PEAKS_MAGIC = 0x4c4d504b; // "LMPK"
+static const quint32 PEAKS_VERSION = 1;
+
+
+SamplePeaks::SamplePeaks() :
+	m_levels(),
+	m_frames( 0 )
+{
+}
+
+
+
+
+void SamplePeaks::clear()
+{
+	m_levels.clear();
+	m_frames = 0;
+}
+
+
+
+
+f_cnt_t SamplePeaks::blockFrames( int _level )
+{
+	f_cnt_t b = BLOCK_FRAMES;
+	for( int l = 0; l < _level; ++l )
+	{
+		b *= FACTOR;
+	}
+	return b;
+}
+
+
+
+
+void SamplePeaks::build( const sampleFrame * _data, f_cnt_t _frames )
+{
+	clear();
+	m_frames = _frames;
+
+	// first level from the data, only complete blocks are stored
+	QVector<Peak> level( _frames / BLOCK_FRAMES );
+	for( int i = 0; i < level.size(); ++i )
+	{
+		const sampleFrame * d = _data + i * BLOCK_FRAMES;
+		Peak & p = level[i];
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			float mn = d[0][ch];
+			float mx = d[0][ch];
+			float sq = 0.0f;
+			for( f_cnt_t f = 0; f < BLOCK_FRAMES; ++f )
+			{
+				const float v = d[f][ch];
+				mn = qMin( mn, v );
+				mx = qMax( mx, v );
+				sq += v * v;
+			}
+			p.min[ch] = mn;
+			p.max[ch] = mx;
+			p.rms[ch] = sqrtf( sq / BLOCK_FRAMES );
+		}
+	}
+
+	// every further level combines FACTOR blocks of the previous one
+	while( level.size() >= FACTOR )
+	{
+		QVector<Peak> next( level.size() / FACTOR );
+		for( int i = 0; i < next.size(); ++i )
+		{
+			Peak & p = next[i];
+			p = level[i * FACTOR];
+			float sq[DEFAULT_CHANNELS];
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				sq[ch] = p.rms[ch] * p.rms[ch];
+			}
+			for( int j = 1; j < FACTOR; ++j )
+			{
+				const Peak & q = level[i * FACTOR + j];
+				for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+				{
+					p.min[ch] = qMin( p.min[ch], q.min[ch] );
+					p.max[ch] = qMax( p.max[ch], q.max[ch] );
+					sq[ch] += q.rms[ch] * q.rms[ch];
+				}
+			}
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				p.rms[ch] = sqrtf( sq[ch] / FACTOR );
+			}
+		}
+		m_levels.append( level );
+		level = next;
+	}
+	if( !level.isEmpty() )
+	{
+		m_levels.append( level );
+	}
+}
+
+
+
+
+bool SamplePeaks::load( const QString & _file, const QString & _source,
+							f_cnt_t _frames )
+{
+	clear();
+
+	const QFileInfo info( _file );
+	if( !info.exists() ||
+		info.lastModified() < QFileInfo( _source ).lastModified() )
+	{
+		return false;
+	}
+
+	QFile file( _file );
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		return false;
+	}
+
+	QDataStream in( &file );
+
+	quint32 magic, version;
+	qint64 frames;
+	qint32 block, factor, levels;
+	in >> magic >> version >> frames >> block >> factor >> levels;
+	if( magic != PEAKS_MAGIC || version != PEAKS_VERSION ||
+		frames != _frames || block != BLOCK_FRAMES ||
+		factor != FACTOR || levels < 0 || levels > 32 )
+	{
+		return false;
+	}
+
+	for( int l = 0; l < levels; ++l )
+	{
+		qint32 count;
+		in >> count;
+		if( in.status() != QDataStream::Ok || count < 0 ||
+			count != _frames / blockFrames( l ) )
+		{
+			clear();
+			return false;
+		}
+		QVector<Peak> level( count );
+		const int bytes = count * sizeof( Peak );
+		if( in.readRawData( (char *) level.data(), bytes ) != bytes )
+		{
+			clear();
+			return false;
+		}
+		m_levels.append( level );
+	}
+
+	m_frames = _frames;
+	return true;
+}
+
+
+
+
+bool SamplePeaks::save( const QString & _file ) const
+{
+	QFile file( _file );
+	if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	{
+		qWarning( "SamplePeaks: Can not write %s",
+						qPrintable( _file ) );
+		return false;
+	}
+
+	QDataStream out( &file );
+	out << PEAKS_MAGIC << PEAKS_VERSION << (qint64) m_frames
+		<< (qint32) BLOCK_FRAMES << (qint32) FACTOR
+		<< (qint32) m_levels.size();
+	for( int l = 0; l < m_levels.size(); ++l )
+	{
+		const QVector<Peak> & level = m_levels[l];
+		out << (qint32) level.size();
+		// native layout, like the raw sample cache next to it
+		out.writeRawData( (const char *) level.constData(),
+					level.size() * sizeof( Peak ) );
+	}
+	return out.status() == QDataStream::Ok;
+}
+
+
+
+
+SamplePeaks::Peak SamplePeaks::peak( const sampleFrame * _data,
+					f_cnt_t _from, f_cnt_t _to ) const
+{
+	Sum s;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		s.min[ch] = FLT_MAX;
+		s.max[ch] = -FLT_MAX;
+		s.squares[ch] = 0.0;
+	}
+	s.frames = 0;
+
+	// coarsest level whose blocks still fit into the range
+	int level = -1;
+	while( level + 1 < m_levels.size() &&
+				blockFrames( level + 1 ) <= _to - _from )
+	{
+		++level;
+	}
+	accumulate( s, _data, _from, _to, level );
+
+	Peak p;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		if( s.frames == 0 )
+		{
+			p.min[ch] = p.max[ch] = p.rms[ch] = 0.0f;
+			continue;
+		}
+		p.min[ch] = s.min[ch];
+		p.max[ch] = s.max[ch];
+		p.rms[ch] = sqrt( s.squares[ch] / s.frames );
+	}
+	return p;
+}
+
+
+
+
+// complete blocks of _level are taken as they are, the partial blocks at
+// both ends are summarized from the next finer level
+void SamplePeaks::accumulate( Sum & _sum, const sampleFrame * _data,
+				f_cnt_t _from, f_cnt_t _to, int _level ) const
+{
+	if( _from >= _to )
+	{
+		return;
+	}
+
+	if( _level < 0 )
+	{
+		for( f_cnt_t f = _from; f < _to; ++f )
+		{
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				const float v = _data[f][ch];
+				_sum.min[ch] = qMin( _sum.min[ch], v );
+				_sum.max[ch] = qMax( _sum.max[ch], v );
+				_sum.squares[ch] += v * v;
+			}
+		}
+		_sum.frames += _to - _from;
+		return;
+	}
+
+	const QVector<Peak> & level = m_levels[_level];
+	const f_cnt_t b = blockFrames( _level );
+	const f_cnt_t first = ( _from + b - 1 ) / b;
+	const f_cnt_t last = qMin<f_cnt_t>( _to / b, level.size() );
+	if( first >= last )
+	{
+		accumulate( _sum, _data, _from, _to, _level - 1 );
+		return;
+	}
+
+	accumulate( _sum, _data, _from, first * b, _level - 1 );
+	for( f_cnt_t i = first; i < last; ++i )
+	{
+		const Peak & p = level[i];
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			_sum.min[ch] = qMin( _sum.min[ch], p.min[ch] );
+			_sum.max[ch] = qMax( _sum.max[ch], p.max[ch] );
+			_sum.squares[ch] += (double) p.rms[ch] * p.rms[ch] * b;
+		}
+	}
+	_sum.frames += ( last - first ) * b;
+	accumulate( _sum, _data, last * b, _to, _level - 1 );
+}
@@ -0,0 +1,376 @@
+/*
+ * SegmentedRenderer.cpp - renders a song in segments, each in its own process
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SegmentedRenderer.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QRegExp>
+
+#include "Song.h"
+
+static const int     CROSSFADE_MS  = 10;
+static const f_cnt_t STITCH_FRAMES = 4096;
+
+SegmentedRenderer::SegmentedRenderer(
+        const Mixer::qualitySettings&      qualitySettings,
+        const OutputSettings&              outputSettings,
+        ProjectRenderer::ExportFileFormats fmt,
+        const QString&                     outputPath,
+        const QString&                     project) :
+      m_qualitySettings(qualitySettings),
+      m_outputSettings(outputSettings), m_format(fmt),
+      m_outputPath(outputPath), m_project(project), m_fileDev(NULL),
+      m_jobs(1), m_next(0), m_running(0), m_preroll(0), m_overlap(0),
+      m_progress(0), m_aborted(false)
+{
+}
+
+SegmentedRenderer::~SegmentedRenderer()
+{
+    abortProcessing();
+    delete m_fileDev;
+}
+
+bool SegmentedRenderer::render(int                     jobs,
+                               const QVector<tick_t>&  cuts,
+                               tick_t                  preroll)
+{
+    if(!m_tempDir.isValid())
+    {
+        qCritical("Error: can not create a directory for the segments");
+        return false;
+    }
+
+    // the output is opened first, the segments are rendered at its rate
+    AudioFileDeviceInstantiaton audioEncoderFactory
+            = ProjectRenderer::fileEncodeDevices[m_format].m_getDevInst;
+    bool successful = false;
+    if(audioEncoderFactory)
+    {
+        m_fileDev = audioEncoderFactory(m_outputPath, m_outputSettings,
+                                        DEFAULT_CHANNELS, Engine::mixer(),
+                                        successful);
+    }
+    if(!successful)
+    {
+        delete m_fileDev;
+        m_fileDev = NULL;
+        qCritical("Error: can not write %s", qPrintable(m_outputPath));
+        return false;
+    }
+
+    Song* song = Engine::getSong();
+    song->updateLength();
+    const std::pair<MidiTime, MidiTime> endpoints = song->getExportEndpoints();
+    const tick_t begin = endpoints.first.getTicks();
+    const tick_t end   = endpoints.second.getTicks();
+
+    QVector<tick_t> points;
+    for(tick_t cut : cuts)
+    {
+        if(cut > begin && cut < end)
+        {
+            points.append(cut);
+        }
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    points.append(end);
+
+    tick_t from = begin;
+    for(int i = 0; i < points.size(); ++i)
+    {
+        Segment s;
+        s.begin    = from;
+        s.end      = points[i];
+        s.file     = m_tempDir.path() + QString("/segment%1").arg(i)
+                     + ProjectRenderer::getFileExtensionFromFormat(
+                             ProjectRenderer::RawFile);
+        s.process  = NULL;
+        s.progress = 0;
+        s.done     = false;
+        m_segments.append(s);
+        from = points[i];
+    }
+
+    m_jobs    = qMax(1, jobs);
+    // a process drops the first period it renders, so it has to start
+    // before its segment
+    m_preroll = qMax<tick_t>(MidiTime::ticksPerTact(), preroll);
+    m_overlap = qMax<f_cnt_t>(1, m_fileDev->sampleRate() * CROSSFADE_MS / 1000);
+
+    qWarning("Rendering %d segments, %d at once", m_segments.size(),
+             qMin(m_jobs, m_segments.size()));
+    startSegments();
+    return true;
+}
+
+void SegmentedRenderer::abortProcessing()
+{
+    m_aborted = true;
+    for(Segment& s : m_segments)
+    {
+        if(s.process != NULL)
+        {
+            s.process->disconnect(this);
+            s.process->kill();
+            s.process->waitForFinished();
+            delete s.process;
+            s.process = NULL;
+        }
+    }
+    m_running = 0;
+}
+
+void SegmentedRenderer::startSegments()
+{
+    while(m_running < m_jobs && m_next < m_segments.size())
+    {
+        Segment& s = m_segments[m_next];
+        s.process  = new QProcess(this);
+        connect(s.process, SIGNAL(readyReadStandardError()), this,
+                SLOT(segmentOutput()));
+        connect(s.process, SIGNAL(finished(int, QProcess::ExitStatus)), this,
+                SLOT(segmentFinished()));
+        s.process->start(QCoreApplication::applicationFilePath(),
+                         arguments(s, m_next == m_segments.size() - 1));
+        ++m_next;
+        ++m_running;
+    }
+}
+
+// lmms --render <project> --segment <from>:<write>:<cut>:<overlap> ...
+QStringList SegmentedRenderer::arguments(const Segment& segment,
+                                         bool           last) const
+{
+    static const char* const interpolations[]
+            = {"linear", "sincfastest", "sincmedium", "sincbest"};
+
+    const tick_t from = qMax(m_segments.first().begin,
+                             segment.begin - m_preroll);
+    const QString spec = QString("%1:%2:%3:%4")
+                                 .arg(from)
+                                 .arg(segment.begin)
+                                 .arg(segment.end)
+                                 .arg(last ? 0 : m_overlap);
+
+    QStringList args;
+    args << "--render" << m_project << "--output" << segment.file
+         << "--format"
+         << "raw"
+         << "--float"
+         << "--samplerate" << QString::number(m_fileDev->sampleRate())
+         << "--interpolation"
+         << interpolations[m_qualitySettings.interpolation]
+         << "--oversampling"
+         << QString::number(1 << m_qualitySettings.oversampling)
+         << "--segment" << spec;
+#ifndef LMMS_BUILD_WIN32
+    // this process has been checked already
+    args << "--allowroot";
+#endif
+    return args;
+}
+
+int SegmentedRenderer::segmentOf(QObject* process) const
+{
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        if(m_segments[i].process == process)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SegmentedRenderer::segmentOutput()
+{
+    const int i = segmentOf(sender());
+    if(i < 0)
+    {
+        return;
+    }
+    Segment& s = m_segments[i];
+
+    const QByteArray output = s.process->readAllStandardError();
+    // kept for the error message if it fails
+    s.log = (s.log + output).right(4096);
+
+    // the console progress of the segment, "|-----   |  42%  ..."
+    QRegExp     rx("(\\d+)%");
+    const QString text = QString::fromLocal8Bit(output);
+    for(int pos = 0; (pos = rx.indexIn(text, pos)) >= 0;
+        pos += rx.matchedLength())
+    {
+        s.progress = rx.cap(1).toInt();
+    }
+
+    tick_t done = 0;
+    tick_t total = 0;
+    for(const Segment& t : m_segments)
+    {
+        const tick_t length = t.end - t.begin;
+        done += (t.done ? 100 : t.progress) * length;
+        total += length;
+    }
+    const int progress = total > 0 ? done / total : 0;
+    if(progress != m_progress)
+    {
+        m_progress = progress;
+        emit progressChanged(m_progress);
+    }
+}
+
+void SegmentedRenderer::segmentFinished()
+{
+    const int i = segmentOf(sender());
+    if(i < 0 || m_aborted)
+    {
+        return;
+    }
+    Segment& s = m_segments[i];
+
+    const bool crashed = s.process->exitStatus() != QProcess::NormalExit
+                         || s.process->exitCode() != 0;
+    s.process->deleteLater();
+    s.process = NULL;
+    s.done    = true;
+    --m_running;
+
+    if(crashed)
+    {
+        fprintf(stderr, "\n%s\n", s.log.constData());
+        abortProcessing();
+        finish(QString("segment %1 failed").arg(i + 1));
+        return;
+    }
+
+    if(m_running > 0 || m_next < m_segments.size())
+    {
+        startSegments();
+        return;
+    }
+
+    QString error;
+    stitch(error);
+    finish(error);
+}
+
+// The segments overlap by m_overlap frames, over which one fades out and
+// the next one in, with gains adding up to 1. Both only carry the same
+// signal there if nothing carries over the cut, see the class comment.
+bool SegmentedRenderer::stitch(QString& error)
+{
+    surroundSampleFrame* buf  = new surroundSampleFrame[STITCH_FRAMES];
+    surroundSampleFrame* tail = new surroundSampleFrame[m_overlap];
+    f_cnt_t              tailFrames = 0;
+
+    for(int i = 0; i < m_segments.size() && error.isEmpty(); ++i)
+    {
+        QFile f(m_segments[i].file);
+        if(!f.open(QIODevice::ReadOnly))
+        {
+            error = QString("can not read segment %1").arg(i + 1);
+            break;
+        }
+
+        const f_cnt_t frames  = f.size() / sizeof(surroundSampleFrame);
+        const f_cnt_t overlap = i == m_segments.size() - 1 ? 0 : m_overlap;
+        if(frames < overlap)
+        {
+            error = QString("segment %1 is incomplete").arg(i + 1);
+            break;
+        }
+
+        const f_cnt_t body = frames - overlap;
+        for(f_cnt_t pos = 0; pos < body; pos += STITCH_FRAMES)
+        {
+            const f_cnt_t n = qMin(STITCH_FRAMES, body - pos);
+            f.read((char*)buf, n * sizeof(surroundSampleFrame));
+            for(f_cnt_t j = 0; j < n && pos + j < tailFrames; ++j)
+            {
+                const float in = float(pos + j + 1) / (tailFrames + 1);
+                for(ch_cnt_t ch = 0; ch < SURROUND_CHANNELS; ++ch)
+                {
+                    buf[j][ch] = buf[j][ch] * in
+                                 + tail[pos + j][ch] * (1.0f - in);
+                }
+            }
+            // the segments carry the master gain of their periods already
+            m_fileDev->writeBlock(buf, n, 1.0f);
+        }
+
+        f.read((char*)tail, overlap * sizeof(surroundSampleFrame));
+        tailFrames = overlap;
+        f.remove();
+    }
+
+    delete[] buf;
+    delete[] tail;
+
+    // closes the file
+    delete m_fileDev;
+    m_fileDev = NULL;
+    return error.isEmpty();
+}
+
+void SegmentedRenderer::finish(const QString& error)
+{
+    if(!error.isEmpty())
+    {
+        qCritical("Error: %s", qPrintable(error));
+        delete m_fileDev;
+        m_fileDev = NULL;
+        QFile::remove(m_outputPath);
+        emit failed(error);
+        return;
+    }
+
+    m_progress = 100;
+    emit progressChanged(m_progress);
+    emit finished();
+}
+
+void SegmentedRenderer::updateConsoleProgress()
+{
+    const int cols = 50;
+    char      prog[cols + 1];
+    for(int i = 0; i < cols; ++i)
+    {
+        prog[i] = (i * 100 / cols <= m_progress ? '-' : ' ');
+    }
+    prog[cols] = 0;
+
+    int done = 0;
+    for(const Segment& s : m_segments)
+    {
+        done += s.done ? 1 : 0;
+    }
+
+    fprintf(stderr, "\r|%s|    %3d%%   (%d/%d segments)  ", prog, m_progress,
+            done, m_segments.size());
+    fflush(stderr);
+}
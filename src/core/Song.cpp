@@ -50,6 +50,7 @@
 #include "TextFloat.h"
 #include "TimeLineWidget.h"
 #include "PeakController.h"
+#include "SampleBuffer.h"
 #include "VersionedSaveDialog.h"
 //#include "MemoryManagerArray.h"
 
@@ -87,6 +88,7 @@ Song::Song() :
 	m_exporting( false ),
 	m_exportLoop( false ),
 	m_renderBetweenMarkers( false ),
+	m_exportRange( false ),
 	m_playing( false ),
 	m_paused( false ),
 	m_loadingProject( false ),
@@ -505,7 +507,11 @@ void Song::processAutomations(const TrackList &tracklist, MidiTime timeStart, fp
 
 std::pair<MidiTime, MidiTime> Song::getExportEndpoints() const
 {
-	if ( m_renderBetweenMarkers )
+	if ( m_exportRange )
+	{
+		return std::pair<MidiTime, MidiTime>( m_exportRangeBegin, m_exportRangeEnd );
+	}
+	else if ( m_renderBetweenMarkers )
 	{
 		return std::pair<MidiTime, MidiTime>(
 			m_playPos[Mode_PlaySong].m_timeLine->loopBegin(),
@@ -762,7 +768,11 @@ void Song::stop()
 void Song::startExport()
 {
 	stop();
-	if(m_renderBetweenMarkers)
+	if(m_exportRange)
+	{
+		m_playPos[Mode_PlaySong].setTicks( m_exportRangeBegin.getTicks() );
+	}
+	else if(m_renderBetweenMarkers)
 	{
 		m_playPos[Mode_PlaySong].setTicks( m_playPos[Mode_PlaySong].m_timeLine->loopBegin().getTicks() );
 	}
@@ -786,6 +796,7 @@ void Song::stopExport()
 	stop();
 	m_exporting = false;
 	m_exportLoop = false;
+	m_exportRange = false;
 
 	m_vstSyncController.setPlaybackState( m_playing );
 }
@@ -1085,6 +1096,20 @@ void Song::loadProject( const QString & fileName )
 
 	m_oldFileName = m_fileName;
 
+	// decode the samples on the thread pool while the old project is
+	// cleared and the new tracks are restored; each sample buffer
+	// waits for its own file only
+	QStringList samples;
+	foreach( const QString& tag, QStringList() << "sampletco" << "audiofileprocessor" )
+	{
+		QDomNodeList list = dataFile.elementsByTagName( tag );
+		for( int i = 0; i < list.count(); ++i )
+		{
+			samples.append( list.item( i ).toElement().attribute( "src" ) );
+		}
+	}
+	SampleBuffer::preloadAudioFiles( samples );
+
 	clearProject();
 
 	clearErrors();
@@ -1206,6 +1231,8 @@ void Song::loadProject( const QString & fileName )
 	// resolve all IDs so that autoModels are automated
 	AutomationPattern::resolveAllIDs();
 
+	// join the decoders of samples that were not claimed
+	SampleBuffer::clearPreloadedAudioFiles();
 
 	Engine::mixer()->doneChangeInModel();
 
@@ -1263,7 +1290,33 @@ bool Song::saveProjectFile(const QString& _fileName)
 
 	DataFile::LocaleHelper localeHelper( DataFile::LocaleHelper::ModeSave );
 
+	// bundles keep their copies as bundles too, so they are updated
+	// incrementally as well
+	const bool bundle = QFileInfo( _fileName ).suffix().toLower() == "mmpb";
+	const bool copies = _fileName == m_fileName;
+	QString projectCopy, backupCopy;
+	if( copies )
+	{
+		const QString dir = projectDir() + QDir::separator();
+		projectCopy = dir + ( bundle ? "project.mmpb" : "project.mmp" );
+		backupCopy = dir + "backup" + QDir::separator() +
+				QDate::currentDate().toString( "yyyyMMdd" ) +
+				( bundle ? ".mmpb" : ".mmpz" );
+	}
+
 	DataFile dataFile( DataFile::SongProject );
+	// sample data only gets encoded if an XML file is written
+	dataFile.setDeferBinaryData( true );
+	if( bundle )
+	{
+		QStringList bundles( _fileName );
+		if( copies )
+		{
+			bundles << projectCopy << backupCopy;
+		}
+		// sample data already in them isn't copied again
+		dataFile.setBundleFiles( bundles );
+	}
 
 	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
 	m_timeSigModel.saveSettings( dataFile, dataFile.head(), "timesig" );
@@ -1290,12 +1343,11 @@ bool Song::saveProjectFile(const QString& _fileName)
 	m_savingProject = false;
 
 	bool r=dataFile.writeFile( _fileName );
-        if(r && (_fileName==m_fileName))
+        if(r && copies)
         {
                 //QFileInfo fi(filename);
-                dataFile.writeFile(projectDir()+QDir::separator()+"project.mmp");
-                dataFile.writeFile(projectDir()+QDir::separator()+"backup"+QDir::separator()+
-                                   QDate::currentDate().toString("yyyyMMdd")+".mmpz");
+                dataFile.writeFile(projectCopy);
+                dataFile.writeFile(backupCopy);
         }
         return r;
 }
@@ -1436,7 +1488,7 @@ QString Song::projectDir()
         QFileInfo fi(fname);
         QString   fs=fi.suffix().toLower();
         qInfo("Song::projectDir suffix is %s",qPrintable(fs));
-        if((fs!="mmp")&&(fs!="mmpz"))
+        if((fs!="mmp")&&(fs!="mmpz")&&(fs!="mmpb"))
         {
                 qWarning("Song::projectDir invalid project suffix: %s",
                          qPrintable(fi.suffix()));
@@ -25,7 +25,6 @@
 #include "WaveForm.h"
 
 #include "Backtrace.h"
-#include "SampleBuffer.h"
 //#include "ConfigManager.h"
 
 #include "lmms_math.h"  // REQUIRED
@@ -33,6 +32,67 @@
 #include <QDir>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <sndfile.h>
+
+// single cycle waves, longer files are not tables
+static const sf_count_t MAX_FILE_FRAMES = 1 << 20;
+
+// number of build requests not yet seen by the loader
+static QAtomicInt s_pending(0);
+
+// Builds the queued tables (mostly file-backed waves) out of the audio
+// thread. Requests made from the audio thread only raise s_pending and
+// are picked up at the next timeout; prewarm() wakes the loader at once.
+class WaveFormLoader : public QThread
+{
+  public:
+    WaveFormLoader() : m_stop(false)
+    {
+    }
+
+    void wake()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_cond.wakeAll();
+    }
+
+    void finish()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stop = true;
+            m_cond.wakeAll();
+        }
+        wait();
+    }
+
+  protected:
+    virtual void run()
+    {
+        QMutexLocker locker(&m_mutex);
+        while(!m_stop)
+        {
+            if(s_pending.fetchAndStoreOrdered(0) > 0)
+            {
+                locker.unlock();
+                WaveForm::WAVEFORMS.buildQueued();
+                locker.relock();
+                continue;
+            }
+            m_cond.wait(&m_mutex, 50);
+        }
+    }
+
+  private:
+    bool           m_stop;
+    QMutex         m_mutex;
+    QWaitCondition m_cond;
+};
+
+static WaveFormLoader* s_loader = NULL;
 
 WaveForm::Set::Set()
 {
@@ -284,9 +344,58 @@ void WaveForm::Set::fillIndexModel(ComboBoxModel& _model, const int _bank)
     }
 }
 
+void WaveForm::Set::buildFunctionTables()
+{
+    for(int b = MAX_BANK - MIN_BANK; b >= 0; --b)
+        for(int i = MAX_INDEX - MIN_INDEX; i >= 0; --i)
+        {
+            WaveForm* wf = const_cast<WaveForm*>(m_stock[b][i]);
+            if(wf != NULL && wf->m_func != NULL)
+                wf->build();
+        }
+}
+
+void WaveForm::Set::buildQueued()
+{
+    for(int b = MAX_BANK - MIN_BANK; b >= 0; --b)
+        for(int i = MAX_INDEX - MIN_INDEX; i >= 0; --i)
+        {
+            WaveForm* wf = const_cast<WaveForm*>(m_stock[b][i]);
+            if(wf != NULL && wf->m_state.loadAcquire() == Queued)
+                wf->build();
+        }
+}
+
 const WaveForm* WaveForm::get(const int _bank, const int _index)
 {
-    return WAVEFORMS.get(_bank, _index);
+    const WaveForm* wf = WAVEFORMS.get(_bank, _index);
+    if(wf->isBuilt())
+        return wf;
+
+    if(s_loader == NULL)
+    {
+        // no audio running yet, build in place
+        const_cast<WaveForm*>(wf)->build();
+        return wf;
+    }
+
+    wf->requestBuild();
+    return &ZERO;
+}
+
+void WaveForm::prewarm(const int _bank, const int _index)
+{
+    const WaveForm* wf = WAVEFORMS.get(_bank, _index);
+    if(wf->requestBuild() && s_loader != NULL)
+        s_loader->wake();
+}
+
+bool WaveForm::requestBuild() const
+{
+    if(!m_state.testAndSetOrdered(Unbuilt, Queued))
+        return false;
+    s_pending.ref();
+    return true;
 }
 
 void WaveForm::fillBankModel(ComboBoxModel& _model)
@@ -299,12 +408,35 @@ void WaveForm::fillIndexModel(ComboBoxModel& _model, const int _bank)
     WAVEFORMS.fillIndexModel(_model, _bank);
 }
 
+void WaveForm::buildFunctionTables()
+{
+    WAVEFORMS.buildFunctionTables();
+}
+
+void WaveForm::startLoader()
+{
+    if(s_loader != NULL)
+        return;
+    s_loader = new WaveFormLoader();
+    s_loader->start(QThread::LowPriority);
+}
+
+void WaveForm::stopLoader()
+{
+    if(s_loader == NULL)
+        return;
+    WaveFormLoader* loader = s_loader;
+    s_loader               = NULL;
+    loader->finish();
+    delete loader;
+}
+
 WaveForm::WaveForm(const char*           _name,
                    const int             _bank,
                    const int             _index,
                    const interpolation_t _mode,
                    const int             _quality) :
-      m_built(false),
+      m_state(Unbuilt),
       m_name(_name), m_bank(_bank), m_index(_index), m_mode(_mode),
       m_quality(_quality)
 {
@@ -326,7 +458,7 @@ WaveForm::WaveForm(const char*           _name,
 {
     m_func = _func;
     if(m_mode == Exact)
-        m_built = true;
+        m_state.storeRelease(Built);
 }
 
 WaveForm::WaveForm(const char*           _name,
@@ -357,7 +489,7 @@ WaveForm::WaveForm(const char*           _name,
     m_size = _size - 1;
     if(m_mode == Exact)
         m_mode = Linear;
-    m_built = true;
+    m_state.storeRelease(Built);
 }
 
 WaveForm::WaveForm(const char*           _name,
@@ -375,7 +507,7 @@ WaveForm::WaveForm(const char*           _name,
     m_size = _size - 1;
     if(m_mode == Exact)
         m_mode = Linear;
-    m_built = true;
+    m_state.storeRelease(Built);
 }
 
 WaveForm::~WaveForm()
@@ -386,34 +518,57 @@ WaveForm::~WaveForm()
 
 void WaveForm::build()
 {
-    if(m_built)
+    if(isBuilt())
         return;
     static QMutex s_building;
     QMutexLocker  locker(&s_building);
-    if(m_built)
+    if(isBuilt())
         return;
 
+    // the table is filled before being published by m_state
     if(m_func)
     {
         m_size = 128 * pow(2, m_quality) - 1;
         m_data = MM_ALLOC(float, m_size + 1);
         for(int i = m_size; i >= 0; --i)
             m_data[i] = m_func(float(i) / float(m_size));
-        m_built = true;
+        m_state.storeRelease(Built);
         return;
     }
     else if(m_file != "")
     {
-        SampleBuffer*      sb   = new SampleBuffer(m_file, false, false);
-        int                size = sb->frames();
-        const sampleFrame* data = sb->data();
+        // decoded here rather than through SampleBuffer, which isn't
+        // safe out of the GUI thread. The table is one cycle, so the
+        // rate of the file doesn't matter.
+        int     size     = 0;
+        float*  frames   = NULL;
+        SF_INFO sf_info;
+        sf_info.format   = 0;
+        SNDFILE* snd_file
+                = sf_open(m_file.toUtf8().constData(), SFM_READ, &sf_info);
+        if(snd_file != NULL)
+        {
+            if(sf_info.channels > 0 && sf_info.frames > 0
+               && sf_info.frames <= MAX_FILE_FRAMES)
+            {
+                frames = new float[sf_info.frames * sf_info.channels];
+                size   = sf_readf_float(snd_file, frames, sf_info.frames);
+            }
+            sf_close(snd_file);
+        }
+        if(size <= 0)
+            qWarning("WaveForm: can not decode %s", qPrintable(m_file));
 
-        m_data = MM_ALLOC(float, size);
+        // interpolation reads two entries
+        size   = qMax(size, 0);
+        m_data = MM_ALLOC(float, qMax(size, 2));
         for(int f = 0; f < size; ++f)
-            m_data[f] = data[f][0];
-        m_size = size - 1;
-        delete sb;
-        m_built = true;
+            m_data[f] = frames[f * sf_info.channels];
+        for(int f = size; f < 2; ++f)
+            m_data[f] = (size > 0 ? m_data[0] : 0.f);
+        m_size = qMax(size, 2) - 1;
+        delete[] frames;
+        m_state.storeRelease(Built);
         return;
     }
 
@@ -423,7 +578,8 @@ void WaveForm::build()
 // x must be between 0. and 1.
 float WaveForm::f(const float _x) const
 {
-    if(!m_built)
+    // only for direct users; get() returns built tables
+    if(!isBuilt())
             const_cast<WaveForm*>(this)->build();
 
     float r;
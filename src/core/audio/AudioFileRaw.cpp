@@ -81,8 +81,26 @@ void AudioFileRaw::writeBuffer(const surroundSampleFrame* _ab,
     Q_ASSERT(getOutputSettings().getBitDepth()
              == OutputSettings::Depth_32Bit);
 
-    // master gain is ignored
-    fwrite(_ab, sizeof(surroundSampleFrame), _frames, m_fh);
+    if(_master_gain == 1.0f)
+    {
+        fwrite(_ab, sizeof(surroundSampleFrame), _frames, m_fh);
+        return;
+    }
+
+    // the gain of this block, the master volume may be automated
+    surroundSampleFrame buf[256];
+    for(fpp_t pos = 0; pos < _frames; pos += 256)
+    {
+        const fpp_t n = qMin<fpp_t>(256, _frames - pos);
+        for(fpp_t f = 0; f < n; ++f)
+        {
+            for(ch_cnt_t ch = 0; ch < SURROUND_CHANNELS; ++ch)
+            {
+                buf[f][ch] = _ab[pos + f][ch] * _master_gain;
+            }
+        }
+        fwrite(buf, sizeof(surroundSampleFrame), n, m_fh);
+    }
 }
 
 void AudioFileRaw::finishEncoding()
@@ -59,6 +59,8 @@
 #include "OutputSettings.h"
 #include "ProjectRenderer.h"
 #include "RenderManager.h"
+#include "RenderService.h"
+#include "SegmentedRenderer.h"
 #include "Song.h"
 //#include "SetupDialog.h"
 
@@ -158,6 +160,8 @@ void printHelp()
 		"            [ --profile <out> ]\n"
 		"            [ -r <project file> ] [ options ]\n"
 		"            [ -s <samplerate> ]\n"
+		"            [ --segments <n> --cuts <bars> [ --preroll <bars> ] ]\n"
+		"            [ --serve <spool dir> ] [ options ]\n"
 		"            [ -u <in> <out> ]\n"
 		"            [ -v ]\n"
 		"            [ -x <value> ]\n"
@@ -168,7 +172,7 @@ void printHelp()
 		"-c, --config <configfile>     Get the configuration from <configfile>\n"
 		"-d, --dump <in>               Dump XML of compressed file <in>\n"
 		"-f, --format <format>         Specify format of render-output where\n"
-		"       Format is either 'wav', 'flac', 'ogg' or 'mp3'.\n"
+		"       Format is either 'wav', 'flac', 'ogg', 'mp3' or 'raw'.\n"
 		"    --geometry <geometry>     Specify the size and position of the main window\n"
 		"       geometry is <xsizexysize+xoffset+yoffsety>.\n"
 		"-h, --help                    Show this usage information and exit.\n"
@@ -192,10 +196,22 @@ void printHelp()
 		"       For --rendertracks, provide a directory path\n"
 		"-p, --play                    Play given project file\n"
 		"    --profile <out>           Dump profiling information to file <out>\n"
+		"       A .json file gets a Chrome trace of every node\n"
 		"-r, --render <project file>   Render given project file\n"
 		"    --rendertracks <project>  Render each track to a different file\n"
 		"-s, --samplerate <samplerate> Specify output samplerate in Hz\n"
 		"       Range: 44100 (default) to 192000\n"
+		"    --segments <n>            Render up to <n> segments of the song at\n"
+		"       once, each in its own process, and crossfade them\n"
+		"    --cuts <bars>             Cut the segments at the given bars,\n"
+		"       e.g. --cuts 33,65,129. LFOs and random values aren't carried\n"
+		"       over a cut, so cut where the song carries nothing over.\n"
+		"    --preroll <bars>          Bars rendered before each segment to\n"
+		"       warm up notes and effects, at least 1. Default: 2\n"
+		"    --segment <spec>          Render one segment (used by --segments)\n"
+		"    --serve <spool dir>       Keep running and render every <name>.job\n"
+		"       dropped into <spool dir>, see RenderService.h\n"
+		"       The render options above are the defaults for the jobs.\n"
 		"-u, --upgrade <in> [out]      Upgrade file <in> and save as <out>\n"
 		"       Standard out is used if no output file is specifed\n"
 		"-v, --version                 Show version information and exit.\n"
@@ -267,6 +283,11 @@ int main( int argc, char * * argv )
 	bool renderLoop = false;
 	bool renderTracks = false;
 	QString fileToLoad, fileToImport, playOut, renderOut, profilerOutputFile, configFile;
+	QString serveDir;
+	int renderSegments = 0;
+	QVector<int> cutBars;
+	int prerollBars = 2;
+	QString segmentSpec;
 
 	// first of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -276,7 +297,8 @@ int main( int argc, char * * argv )
 		if( arg == "--help"    || arg == "-h" ||
 		    arg == "--version" || arg == "-v" ||
 		    //arg == "--play"    || arg == "-p" ||
-		    arg == "--render"  || arg == "-r" )
+		    arg == "--render"  || arg == "-r" ||
+		    arg == "--serve" )
 		{
 			coreOnly = true;
 		}
@@ -420,10 +442,87 @@ int main( int argc, char * * argv )
                         */
 			renderOut = "yes";//fileToLoad;
 		}
+		else if( arg == "--serve" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				qWarning("Error: No spool directory specified.\n"
+                                         "     : Try \"%s --help\" for more information.",argv[0]);
+				return EXIT_FAILURE;
+			}
+
+			serveDir = QString::fromLocal8Bit( argv[i] );
+		}
 		else if( arg == "--loop" || arg == "-l" )
 		{
 			renderLoop = true;
 		}
+		else if( arg == "--segments" )
+		{
+			++i;
+
+			if( i == argc || QString( argv[i] ).toInt() < 1 )
+			{
+				qWarning("Error: No number of segments specified.\n"
+                                         "     : Try \"%s --help\" for more information.",argv[0]);
+				return EXIT_FAILURE;
+			}
+
+			renderSegments = QString( argv[i] ).toInt();
+		}
+		else if( arg == "--cuts" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				qWarning("Error: No cuts specified.\n"
+                                         "     : Try \"%s --help\" for more information.",argv[0]);
+				return EXIT_FAILURE;
+			}
+
+			for( const QString & bar : QString( argv[i] ).split( ',' ) )
+			{
+				bool ok = false;
+				const int b = bar.toInt( &ok );
+				if( !ok || b < 1 )
+				{
+					qWarning("Error: Invalid cut %s.\n"
+                                                 "     : Try \"%s --help\" for more information.",
+                                                 qPrintable( bar ), argv[0] );
+					return EXIT_FAILURE;
+				}
+				cutBars.append( b );
+			}
+		}
+		else if( arg == "--preroll" )
+		{
+			++i;
+
+			if( i == argc || QString( argv[i] ).toInt() < 1 )
+			{
+				qWarning("Error: No pre-roll of at least one bar specified.\n"
+                                         "     : Try \"%s --help\" for more information.",argv[0]);
+				return EXIT_FAILURE;
+			}
+
+			prerollBars = QString( argv[i] ).toInt();
+		}
+		else if( arg == "--segment" )
+		{
+			++i;
+
+			if( i == argc || QString( argv[i] ).split( ':' ).size() != 4 )
+			{
+				qWarning("Error: No segment specified.\n"
+                                         "     : Try \"%s --help\" for more information.",argv[0]);
+				return EXIT_FAILURE;
+			}
+
+			segmentSpec = QString( argv[i] );
+		}
 		else if( arg == "--song" )
 		{
 			renderTracks = false;
@@ -484,6 +583,10 @@ int main( int argc, char * * argv )
 			{
 				eff = ProjectRenderer::AUFile;
 			}
+			else if (ext == "raw")
+			{
+				eff = ProjectRenderer::RawFile;
+			}
 			else
 			{
 				qWarning("Error: Invalid output format %s.\n"
@@ -716,6 +819,14 @@ int main( int argc, char * * argv )
 		}
 	}
 
+	// where cuts are harmless is up to the user, see SegmentedRenderer
+	if( renderSegments > 0 && cutBars.isEmpty() )
+	{
+		qWarning("Error: --segments needs --cuts.\n"
+                         "     : Try \"%s --help\" for more information.",argv[0]);
+		return EXIT_FAILURE;
+	}
+
         if(playOut=="yes")
         {
                 playOut=fileToLoad;
@@ -840,33 +951,91 @@ int main( int argc, char * * argv )
 
 		Engine::getSong()->setExportLoop( renderLoop );
 
-		// create renderer
-		RenderManager * r = new RenderManager( qs, os, eff, renderOut );
-		QCoreApplication::instance()->connect( r,
-				SIGNAL( finished() ), SLOT( quit() ) );
+		// split the export among several processes
+		if( renderSegments > 0 && !renderTracks && renderOut != "-" )
+		{
+			const tick_t bar = MidiTime::ticksPerTact();
+			QVector<tick_t> cuts;
+			for( int b : cutBars )
+			{
+				cuts.append( ( b - 1 ) * bar );
+			}
 
-		// timer for progress-updates
-		QTimer * t = new QTimer( r );
-		r->connect( t, SIGNAL( timeout() ),
-				SLOT( updateConsoleProgress() ) );
-		t->start( 200 );
+			SegmentedRenderer * r = new SegmentedRenderer( qs, os, eff,
+						renderOut, QFileInfo( fileToLoad ).absoluteFilePath() );
+			QCoreApplication::instance()->connect( r,
+					SIGNAL( finished() ), SLOT( quit() ) );
+			// for scripts and render farms
+			QObject::connect( r, &SegmentedRenderer::failed,
+					[]() { QCoreApplication::exit( EXIT_FAILURE ); } );
 
-		if( profilerOutputFile.isEmpty() == false )
-		{
-			Engine::mixer()->profiler().setOutputFile( profilerOutputFile );
-		}
+			QTimer * t = new QTimer( r );
+			r->connect( t, SIGNAL( timeout() ),
+					SLOT( updateConsoleProgress() ) );
+			t->start( 200 );
 
-		// start now!
-		if ( renderTracks )
-		{
-			PL_BEGIN("Tracks Rendering")
-			r->renderTracks();
-			PL_END("Tracks Rendering")
+			PL_BEGIN("Project Rendering")
+			if( !r->render( renderSegments, cuts, prerollBars * bar ) )
+			{
+				exit( EXIT_FAILURE );
+			}
 		}
 		else
 		{
-			PL_BEGIN("Project Rendering")
-			r->renderProject();
+			// create renderer
+			RenderManager * r = new RenderManager( qs, os, eff, renderOut );
+			QCoreApplication::instance()->connect( r,
+					SIGNAL( finished() ), SLOT( quit() ) );
+
+			// one segment of a segmented export, see SegmentedRenderer
+			if( !segmentSpec.isEmpty() )
+			{
+				const QStringList spec = segmentSpec.split( ':' );
+				const tick_t from = spec[0].toInt();
+				const tick_t write = spec[1].toInt();
+				const tick_t cut = spec[2].toInt();
+				const f_cnt_t overlap = spec[3].toInt();
+				// with an overlap, it stops by itself after the cut
+				Engine::getSong()->setExportRange( MidiTime( from ),
+					MidiTime( overlap > 0 ? cut + MidiTime::ticksPerTact() : cut ) );
+				r->setSegment( write, cut, overlap );
+			}
+
+			// timer for progress-updates
+			QTimer * t = new QTimer( r );
+			r->connect( t, SIGNAL( timeout() ),
+					SLOT( updateConsoleProgress() ) );
+			t->start( 200 );
+
+			if( profilerOutputFile.isEmpty() == false )
+			{
+				Engine::mixer()->profiler().setOutputFile( profilerOutputFile );
+			}
+
+			// start now!
+			if ( renderTracks )
+			{
+				PL_BEGIN("Tracks Rendering")
+				r->renderTracks();
+				PL_END("Tracks Rendering")
+			}
+			else
+			{
+				PL_BEGIN("Project Rendering")
+				r->renderProject();
+			}
+		}
+	}
+	// keep the engine running and render the jobs of a spool directory
+	else if( !serveDir.isEmpty() )
+	{
+		Engine::init( true );
+		destroyEngine = true;
+
+		RenderService * service = new RenderService( serveDir, qs, os, eff );
+		if( !service->start() )
+		{
+			exit( EXIT_FAILURE );
 		}
 	}
 	// if we have playOut, just play the song
@@ -916,6 +1085,16 @@ int main( int argc, char * * argv )
 
 		bool recoveryFilePresent = QFileInfo( recoveryFile ).exists() &&
 				QFileInfo( recoveryFile ).isFile();
+		if( !recoveryFilePresent )
+		{
+			// left behind by a version without bundles
+			const QFileInfo legacy( ConfigManager::inst()->legacyRecoveryFile() );
+			if( legacy.exists() && legacy.isFile() )
+			{
+				recoveryFile = legacy.filePath();
+				recoveryFilePresent = true;
+			}
+		}
 		bool autoSaveEnabled =
 			ConfigManager::inst()->value( "ui", "enableautosave" ).toInt();
 
@@ -1094,7 +1273,7 @@ int main( int argc, char * * argv )
 		}
 		else
 		// Finally we start the auto save timer and also trigger the
-		// autosave one time as recover.mmp is a signal to possible other
+		// autosave one time as recover.mmpb is a signal to possible other
 		// instances of LMMS.
 		if( autoSaveEnabled )
 		{
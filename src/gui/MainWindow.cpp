@@ -48,6 +48,7 @@
 #include "FileDialog.h"
 #include "FxMixerView.h"
 #include "GuiApplication.h"
+#include "Model.h"
 #include "PianoRoll.h" // REQUIRED
 #include "PluginBrowser.h"
 #include "PluginFactory.h"
@@ -105,7 +106,7 @@ MainWindow::MainWindow() :
 	sideBar->appendTab( new FileBrowser(
 				confMgr->userProjectsDir() + "*" +
 				confMgr->factoryProjectsDir(),
-					"*.mmp *.mmpz *.xml *.mid",
+					"*.mmp *.mmpz *.mmpb *.xml *.mid",
 							tr( "My Projects" ),
 					embed::getIconPixmap( "project_file" ).transformed( QTransform().rotate( 90 ) ),
 							splitter, false, true ) );
@@ -206,7 +207,7 @@ MainWindow::MainWindow() :
 					"ui", "saveinterval" ).toInt();
 
 		// The auto save function mustn't run until there is a project
-		// to save or it will run over recover.mmp if you hesitate at the
+		// to save or it will run over recover.mmpb if you hesitate at the
 		// recover messagebox for a minute. It is now started in main.
 		// See autoSaveTimerReset() in MainWindow.h
 	}
@@ -929,7 +930,7 @@ void MainWindow::openProject()
 {
 	if( mayChangeProject(false) )
 	{
-		FileDialog ofd( this, tr( "Open Project" ), "", tr( "LMMS (*.mmp *.mmpz)" ) );
+		FileDialog ofd( this, tr( "Open Project" ), "", tr( "LMMS (*.mmp *.mmpz *.mmpb)" ) );
 
 		ofd.setDirectory( ConfigManager::inst()->userProjectsDir() );
 		ofd.setFileMode( FileDialog::ExistingFiles );
@@ -962,7 +963,8 @@ void MainWindow::updateRecentlyOpenedProjectsMenu()
 	{
 		QFileInfo recentFile( *it );
 		if ( recentFile.exists() && 
-				*it != ConfigManager::inst()->recoveryFile() )
+				*it != ConfigManager::inst()->recoveryFile() &&
+				*it != ConfigManager::inst()->legacyRecoveryFile() )
 		{
 			if( recentFile.suffix().toLower() == "mpt" )
 			{
@@ -1036,6 +1038,7 @@ bool MainWindow::saveProjectAs()
 {
 	VersionedSaveDialog sfd( this, tr( "Save Project" ), "",
 			tr( "LMMS Project" ) + " (*.mmpz *.mmp);;" +
+				tr( "LMMS Project Bundle" ) + " (*.mmpb);;" +
 				tr( "LMMS Project Template" ) + " (*.mpt)" );
 	QString f = Engine::getSong()->projectFileName();
 	if( f != "" )
@@ -1072,6 +1075,12 @@ bool MainWindow::saveProjectAs()
 				}
 			}
 		}
+		else if( sfd.selectedNameFilter().contains( "(*.mmpb)" ) &&
+					!sfd.selectedFiles()[0].endsWith( ".mmpb" ) )
+		{
+			fname.remove( "." + suffix );
+			fname += ".mmpb";
+		}
 		if( Engine::getSong()->guiSaveProjectAs( fname ) )
                 {
                         if( getSession() == Recover )
@@ -1558,6 +1567,7 @@ void MainWindow::sessionCleanup()
 {
 	// delete recover session files
 	QFile::remove( ConfigManager::inst()->recoveryFile() );
+	QFile::remove( ConfigManager::inst()->legacyRecoveryFile() );
 	setSession( Normal );
 }
 
@@ -1626,6 +1636,8 @@ void MainWindow::keyReleaseEvent( QKeyEvent * _ke )
 
 void MainWindow::timerEvent( QTimerEvent * _te)
 {
+	// repaint views of models changed by the audio thread
+	Model::flushChanges();
 	emit periodicUpdate();
 }
 
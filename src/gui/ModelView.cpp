@@ -84,8 +84,8 @@ void ModelView::doConnections()
 	{
                 //qWarning("ModelView::doConnections m_model=%p",m_model);
                 //m_model->disconnect(widget());
-		QObject::connect( m_model, SIGNAL( dataChanged() ), widget(), SLOT( update() ) );
-		QObject::connect( m_model, SIGNAL( propertiesChanged() ), widget(), SLOT( update() ) );
+		m_model->trackChanges();
+		QObject::connect( m_model, SIGNAL( changed() ), widget(), SLOT( update() ) );
 	}
 }
 
@@ -186,6 +186,10 @@ PianoRoll::PianoRoll() :
 	m_ctrlMode( ModeDraw ),
 	m_mouseDownRight( false ),
 	m_scrollBack( false ),
+	m_noteLayerRevision( 0 ),
+	m_noteLayerDirty( true ),
+	m_editingNotes( false ),
+	m_drawNoteNames( ConfigManager::inst()->value( "ui", "printnotelabels" ).toInt() ),
 	m_barLineColor( 0, 0, 0 ),
 	m_beatLineColor( 0, 0, 0 ),
 	m_lineColor( 0, 0, 0 ),
@@ -612,7 +616,9 @@ void PianoRoll::setCurrentPattern( Pattern* newPattern )
 {
 	if( hasValidPattern() )
 	{
+		m_pattern->disconnect( this );
 		m_pattern->instrumentTrack()->disconnect( this );
+		m_pattern->instrumentTrack()->pianoModel()->disconnect( this );
 	}
 
 	// force the song-editor to stop playing if it played pattern before
@@ -664,10 +670,11 @@ void PianoRoll::setCurrentPattern( Pattern* newPattern )
 
 	// make sure to always get informed about the pattern being destroyed
 	connect( m_pattern, SIGNAL( destroyedPattern( Pattern* ) ), this, SLOT( hidePattern( Pattern* ) ) );
+	connect( m_pattern, SIGNAL( dataChanged() ), this, SLOT( invalidateNoteLayer() ) );
 
 	connect( m_pattern->instrumentTrack(), SIGNAL( midiNoteOn( const Note& ) ), this, SLOT( startRecordNote( const Note& ) ) );
 	connect( m_pattern->instrumentTrack(), SIGNAL( midiNoteOff( const Note& ) ), this, SLOT( finishRecordNote( const Note& ) ) );
-	connect( m_pattern->instrumentTrack()->pianoModel(), SIGNAL( dataChanged() ), this, SLOT( update() ) );
+	connect( m_pattern->instrumentTrack()->pianoModel(), SIGNAL( dataChanged() ), this, SLOT( updateKeyboard() ) );
 
 	update();
 	emit currentPatternChanged();
@@ -1290,6 +1297,23 @@ void PianoRoll::keyReleaseEvent(QKeyEvent* ke )
 
 
 
+void PianoRoll::enterEvent( QEvent * e )
+{
+	// the setting may have been toggled while we were left, don't look
+	// it up on every paint
+	const bool drawNoteNames = ConfigManager::inst()->value( "ui", "printnotelabels" ).toInt();
+	if( drawNoteNames != m_drawNoteNames )
+	{
+		m_drawNoteNames = drawNoteNames;
+		updateKeyboard();
+	}
+
+	QWidget::enterEvent( e );
+}
+
+
+
+
 void PianoRoll::leaveEvent(QEvent * e )
 {
 	while( QApplication::overrideCursor() != NULL )
@@ -1375,7 +1399,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 			n->createDetuning();
 		}
 		detuningPattern = n->detuning()->automationPattern();
-		connect(detuningPattern.data(), SIGNAL(dataChanged()), this, SLOT(update()));
+		connect(detuningPattern.data(), SIGNAL(dataChanged()), this, SLOT(invalidateNoteLayer()));
 		gui->automationEditor()->open(detuningPattern);
 		return;
 	}
@@ -2141,6 +2165,7 @@ void PianoRoll::mouseMoveEvent( QMouseEvent * me )
 			// We iterate from last note in pattern to the first,
 			// chronologically
 			NoteVector::ConstIterator it = notes.begin()+notes.size()-1;
+			beginNoteEdit();
 			for( int i = 0; i < notes.size(); ++i )
 			{
 				Note* n = *it;
@@ -2160,6 +2185,7 @@ void PianoRoll::mouseMoveEvent( QMouseEvent * me )
 					if( m_noteEditMode == NoteEditVolume )
 					{
 						n->setVolume( vol );
+						markNote( n );
 
 						const int baseVelocity = m_pattern->instrumentTrack()->midiPort()->baseVelocity();
 
@@ -2168,6 +2194,7 @@ void PianoRoll::mouseMoveEvent( QMouseEvent * me )
 					else if( m_noteEditMode == NoteEditPanning )
 					{
 						n->setPanning( pan );
+						markNote( n );
 						MidiEvent evt( MidiMetaEvent, -1, n->key(), panningToMidi( pan ) );
 						evt.setMetaEvent( MidiNotePanning );
 						m_pattern->instrumentTrack()->processInEvent( evt );
@@ -2186,7 +2213,7 @@ void PianoRoll::mouseMoveEvent( QMouseEvent * me )
 			}
 
 			// Emit pattern has changed
-			m_pattern->dataChanged();
+			endNoteEdit();
 		}
 
 		else if( me->buttons() == Qt::NoButton && m_editMode == ModeDraw )
@@ -2466,6 +2493,12 @@ void PianoRoll::dragNotes( int x, int y, bool alt, bool shift, bool ctrl )
 	// get note-vector of current pattern
 	const NoteVector & notes = m_pattern->notes();
 
+	// sticky resizing also moves the notes behind the selection
+	const bool sticky = m_action == ActionResizeNote && shift &&
+					( ctrl || selectionCount() == 1 );
+	beginNoteEdit();
+	markNotes( !sticky );
+
 	if (m_action == ActionMoveNote)
 	{
 		for (Note *note : notes)
@@ -2609,8 +2642,9 @@ void PianoRoll::dragNotes( int x, int y, bool alt, bool shift, bool ctrl )
 		}
 	}
 
+	markNotes( !sticky );
 	m_pattern->updateLength();
-	m_pattern->dataChanged();
+	endNoteEdit();
 	Engine::getSong()->setModified();
 }
 
@@ -2620,23 +2654,450 @@ int PianoRoll::xCoordOfTick(int tick )
 		* m_ppt / MidiTime::ticksPerTact() );
 }
 
-void PianoRoll::paintEvent(QPaintEvent * pe )
+PianoRoll::LayerState PianoRoll::layerState() const
+{
+	LayerState s;
+	s.size = size();
+	s.position = m_currentPosition;
+	s.startKey = m_startKey;
+	s.ppt = m_ppt;
+	s.zoom = m_zoomingModel.value();
+	s.quantization = quantization();
+	s.timeSigNumerator = Engine::getSong()->getTimeSigModel().getNumerator();
+	s.timeSigDenominator = Engine::getSong()->getTimeSigModel().getDenominator();
+	s.noteEditMode = m_noteEditMode;
+	s.notesEditHeight = m_notesEditHeight;
+	s.pattern = hasValidPattern() ? m_pattern : NULL;
+	s.markedSemiTones = 0;
+	for( int i = 0; i < m_markedSemiTones.size(); ++i )
+	{
+		s.markedSemiTones = s.markedSemiTones * 31 + m_markedSemiTones.at( i ) + 1;
+	}
+	return s;
+}
+
+
+
+
+// the part of the note layer a note can draw to: its rectangle, its
+// volume/panning handle and the edges of both
+QRect PianoRoll::noteColumn( const Note * note ) const
+{
+	const int margin = NOTE_EDIT_LINE_WIDTH + 6;
+	const int len_ticks = note->length() < 0 ? 4 : note->length();
+	const int x = WHITE_KEY_WIDTH + ( note->pos() - m_currentPosition ) *
+					m_ppt / MidiTime::ticksPerTact();
+	const int w = len_ticks * m_ppt / MidiTime::ticksPerTact();
+	return QRect( x - margin, PR_TOP_MARGIN, w + 2 * margin,
+						height() - PR_TOP_MARGIN );
+}
+
+
+
+
+void PianoRoll::markNote( const Note * note )
+{
+	if( note->hasDetuningInfo() )
+	{
+		// the automation curve isn't bound to the note's column
+		m_noteLayerDirty = true;
+		return;
+	}
+	m_noteLayerDirtyRect |= noteColumn( note );
+}
+
+
+
+
+void PianoRoll::markNotes( bool selectedOnly )
+{
+	for( const Note *note : m_pattern->notes() )
+	{
+		if( !selectedOnly || note->selected() )
+		{
+			markNote( note );
+		}
+	}
+}
+
+
+
+
+// bracket an edit of single notes: the columns marked in between are all
+// that gets repainted, unless the notes changed elsewhere since the note
+// layer was drawn last
+void PianoRoll::beginNoteEdit()
+{
+	if( Note::revision() != m_noteLayerRevision )
+	{
+		m_noteLayerDirty = true;
+	}
+}
+
+
+
+
+void PianoRoll::endNoteEdit()
+{
+	m_noteLayerRevision = Note::revision();
+	m_editingNotes = true;
+	m_pattern->dataChanged();
+	m_editingNotes = false;
+	update();
+}
+
+
+
+
+void PianoRoll::updateGridLayer( const LayerState & state )
+{
+	if( !m_gridLayer.isNull() && state == m_gridLayerState )
+	{
+		return;
+	}
+
+	m_gridLayer = QPixmap( size() * devicePixelRatio() );
+	m_gridLayer.setDevicePixelRatio( devicePixelRatio() );
+	m_gridLayerState = state;
+
+	QPainter p( &m_gridLayer );
+	drawGrid( p );
+
+	// notes are positioned on the same grid
+	m_noteLayerDirty = true;
+}
+
+
+
+
+void PianoRoll::updateNoteLayer( const LayerState & state )
+{
+	if( m_noteLayer.isNull() || m_noteLayerDirty ||
+		!( state == m_noteLayerState ) ||
+		Note::revision() != m_noteLayerRevision )
+	{
+		m_noteLayer = QPixmap( size() * devicePixelRatio() );
+		m_noteLayer.setDevicePixelRatio( devicePixelRatio() );
+		m_noteLayer.fill( Qt::transparent );
+		m_noteLayerState = state;
+		m_noteLayerRevision = Note::revision();
+		m_noteLayerDirty = false;
+		m_noteLayerDirtyRect = QRect();
+
+		QPainter p( &m_noteLayer );
+		drawNotes( p );
+		return;
+	}
+
+	if( m_noteLayerDirtyRect.isEmpty() )
+	{
+		return;
+	}
+
+	QPainter p( &m_noteLayer );
+	p.setCompositionMode( QPainter::CompositionMode_Source );
+	p.fillRect( m_noteLayerDirtyRect, Qt::transparent );
+	p.setCompositionMode( QPainter::CompositionMode_SourceOver );
+	drawNotes( p, m_noteLayerDirtyRect );
+	m_noteLayerDirtyRect = QRect();
+}
+
+
+
+
+void PianoRoll::invalidateNoteLayer()
+{
+	// edits bracketed by beginNoteEdit()/endNoteEdit() marked what changed
+	if( !m_editingNotes )
+	{
+		m_noteLayerDirty = true;
+	}
+	update();
+}
+
+
+
+
+void PianoRoll::updateKeyboard()
 {
-	bool drawNoteNames = ConfigManager::inst()->value( "ui", "printnotelabels").toInt();
+	update( 0, PR_TOP_MARGIN, WHITE_KEY_WIDTH,
+					keyAreaBottom() - PR_TOP_MARGIN );
+}
+
 
+
+
+void PianoRoll::drawGrid( QPainter & p )
+{
 	QStyleOption opt;
 	opt.initFrom( this );
-	QPainter p( this );
 	style()->drawPrimitive( QStyle::PE_Widget, &opt, &p, this );
 
-	QBrush bgColor = p.background();
+	// a painter on a pixmap doesn't pick up the widget's settings
+	const QBrush bgColor = palette().brush( backgroundRole() );
+	p.setFont( font() );
 
 	// fill with bg color
 	p.fillRect( 0, 0, width(), height(), bgColor );
 
+	// display note marks before drawing other lines
+	for( int i = 0; i < m_markedSemiTones.size(); i++ )
+	{
+		const int key_num = m_markedSemiTones.at( i );
+		const int y = keyAreaBottom() + 5
+			- KEY_LINE_HEIGHT * ( key_num - m_startKey + 1 );
+
+		if( y > keyAreaBottom() )
+		{
+			break;
+		}
+
+		p.fillRect( WHITE_KEY_WIDTH + 1, y - KEY_LINE_HEIGHT / 2, width() - 10, KEY_LINE_HEIGHT,
+			    markedSemitoneColor() );
+	}
+
+	// display note editing info
+	QFont f = p.font();
+	f.setBold( false );
+	p.setFont( pointSize<10>( f ) );
+	p.setPen( noteModeColor() );
+	p.drawText( QRect( 0, keyAreaBottom(),
+					  WHITE_KEY_WIDTH, noteEditBottom() - keyAreaBottom() ),
+			   Qt::AlignCenter | Qt::TextWordWrap,
+			   m_nemStr.at( m_noteEditMode ) + ":" );
+
+	if( !hasValidPattern() )
+	{
+		return;
+	}
+
+	// not allowed to paint over keyboard...
+	p.setClipRect( WHITE_KEY_WIDTH, PR_TOP_MARGIN,
+				width() - WHITE_KEY_WIDTH,
+				height() - PR_TOP_MARGIN - PR_BOTTOM_MARGIN );
+
+	int q, x, tick;
+
+	if( m_zoomingModel.value() > 3 )
+	{
+		// If we're over 100% zoom, we allow all quantization level grids
+		q = quantization();
+	}
+	else if( quantization() % 3 != 0 )
+	{
+		// If we're under 100% zoom, we allow quantization grid up to 1/24 for triplets
+		// to ensure a dense doesn't fill out the background
+		q = quantization() < 8 ? 8 : quantization();
+	}
+	else {
+		// If we're under 100% zoom, we allow quantization grid up to 1/32 for normal notes
+		q = quantization() < 6 ? 6 : quantization();
+	}
+
+	// First we draw the vertical quantization lines
+	for( tick = m_currentPosition - m_currentPosition % q, x = xCoordOfTick( tick );
+		x <= width(); tick += q, x = xCoordOfTick( tick ) )
+	{
+		p.setPen( lineColor() );
+		p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+	}
+
+	// Draw horizontal lines
+	int key = m_startKey;
+	for( int y = keyAreaBottom() - 1; y > PR_TOP_MARGIN;
+			y -= KEY_LINE_HEIGHT )
+	{
+		if( static_cast<Keys>( key % KeysPerOctave ) == Key_C )
+		{
+			// C note gets accented
+			p.setPen( beatLineColor() );
+		}
+		else
+		{
+			p.setPen( lineColor() );
+		}
+		p.drawLine( WHITE_KEY_WIDTH, y, width(), y );
+		++key;
+	}
+
+
+	// Draw alternating shades on bars
+	float timeSignature = static_cast<float>( Engine::getSong()->getTimeSigModel().getNumerator() )
+			/ static_cast<float>( Engine::getSong()->getTimeSigModel().getDenominator() );
+	float zoomFactor = Editor::ZOOM_LEVELS[m_zoomingModel.value()];
+	//the bars which disappears at the left side by scrolling
+	int leftBars = m_currentPosition * zoomFactor / MidiTime::ticksPerTact();
+
+	//iterates the visible bars and draw the shading on uneven bars
+	for( int x = WHITE_KEY_WIDTH, barCount = leftBars; x < width() + m_currentPosition * zoomFactor / timeSignature; x += m_ppt, ++barCount )
+	{
+		if( ( barCount + leftBars )  % 2 != 0 )
+		{
+			p.fillRect( x - m_currentPosition * zoomFactor / timeSignature, PR_TOP_MARGIN, m_ppt,
+				height() - ( PR_BOTTOM_MARGIN + PR_TOP_MARGIN ), backgroundShade() );
+		}
+	}
+
+
+	// Draw the vertical beat lines
+	int ticksPerBeat = DefaultTicksPerTact /
+		Engine::getSong()->getTimeSigModel().getDenominator();
+
+	for( tick = m_currentPosition - m_currentPosition % ticksPerBeat,
+		x = xCoordOfTick( tick ); x <= width();
+		tick += ticksPerBeat, x = xCoordOfTick( tick ) )
+	{
+		p.setPen( beatLineColor() );
+		p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+	}
+
+	// Draw the vertical bar lines
+	for( tick = m_currentPosition - m_currentPosition % MidiTime::ticksPerTact(),
+		x = xCoordOfTick( tick ); x <= width();
+		tick += MidiTime::ticksPerTact(), x = xCoordOfTick( tick ) )
+	{
+		p.setPen( barLineColor() );
+		p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+	}
+}
+
+
+
+
+// draws all notes in visible area and the note editing stuff (volume,
+// panning, etc)
+void PianoRoll::drawNotes( QPainter & p, const QRect & area )
+{
+	const int y_base = keyAreaBottom() - 1;
+
+	p.setClipRect( WHITE_KEY_WIDTH, PR_TOP_MARGIN,
+			width() - WHITE_KEY_WIDTH,
+			height() - PR_TOP_MARGIN );
+	if( area.isValid() )
+	{
+		p.setClipRect( area, Qt::IntersectClip );
+	}
+
+	const int visible_keys = ( keyAreaBottom()-keyAreaTop() ) /
+						KEY_LINE_HEIGHT + 2;
+
+	QPolygonF editHandles;
+
+	for( const Note *note : m_pattern->notes() )
+	{
+		int len_ticks = note->length();
+
+		if( len_ticks == 0 )
+		{
+			continue;
+		}
+		else if( len_ticks < 0 )
+		{
+			len_ticks = 4;
+		}
+
+		if( area.isValid() && !area.intersects( noteColumn( note ) ) )
+		{
+			continue;
+		}
+
+		const int key = note->key() - m_startKey + 1;
+
+		int pos_ticks = note->pos();
+
+		int note_width = len_ticks * m_ppt / MidiTime::ticksPerTact();
+		const int x = ( pos_ticks - m_currentPosition ) *
+				m_ppt / MidiTime::ticksPerTact();
+		// skip this note if not in visible area at all
+		if( !( x + note_width >= 0 && x <= width() - WHITE_KEY_WIDTH ) )
+		{
+			continue;
+		}
+
+		// is the note in visible area?
+		if( key > 0 && key <= visible_keys )
+		{
+
+			// we've done and checked all, let's draw the
+			// note
+			drawNoteRect( p, x + WHITE_KEY_WIDTH,
+					y_base - key * KEY_LINE_HEIGHT,
+							note_width, note, noteColor(), selectedNoteColor(),
+						 	noteOpacity(), noteBorders() );
+		}
+
+		// draw note editing stuff
+		int editHandleTop = 0;
+		if( m_noteEditMode == NoteEditVolume )
+		{
+			QColor color = barColor().lighter( 30 + ( note->getVolume() * 90 / MaxVolume ) );
+			if( note->selected() )
+			{
+				color = selectedNoteColor();
+			}
+			p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
+
+			editHandleTop = noteEditBottom() -
+				( (float)( note->getVolume() - MinVolume ) ) /
+				( (float)( MaxVolume - MinVolume ) ) *
+				( (float)( noteEditBottom() - noteEditTop() ) );
+
+			p.drawLine( QLineF ( noteEditLeft() + x + 0.5, editHandleTop + 0.5,
+						noteEditLeft() + x + 0.5, noteEditBottom() + 0.5 ) );
+
+		}
+		else if( m_noteEditMode == NoteEditPanning )
+		{
+			QColor color = noteColor();
+			if( note->selected() )
+			{
+				color = selectedNoteColor();
+			}
+
+			p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
+
+			editHandleTop = noteEditBottom() -
+				( (float)( note->getPanning() - PanningLeft ) ) /
+				( (float)( (PanningRight - PanningLeft ) ) ) *
+				( (float)( noteEditBottom() - noteEditTop() ) );
+
+			p.drawLine( QLine( noteEditLeft() + x, noteEditTop() +
+					( (float)( noteEditBottom() - noteEditTop() ) ) / 2.0f,
+					    noteEditLeft() + x , editHandleTop ) );
+		}
+		editHandles << QPoint ( x + noteEditLeft(),
+					editHandleTop );
+
+		if( note->hasDetuningInfo() )
+		{
+			drawDetuningInfo( p, note,
+				x + WHITE_KEY_WIDTH,
+				y_base - key * KEY_LINE_HEIGHT );
+		}
+	}
+
+	p.setPen( QPen( noteColor(), NOTE_EDIT_LINE_WIDTH + 2 ) );
+	p.drawPoints( editHandles );
+}
+
+
+
+
+void PianoRoll::paintEvent(QPaintEvent * pe )
+{
+	const LayerState state = layerState();
+	updateGridLayer( state );
+
+	QPainter p( this );
+	p.drawPixmap( 0, 0, m_gridLayer );
+
 	// set font-size to 8
 	p.setFont( pointSize<8>( p.font() ) );
 
+	// keys that should be only half-visible must not reach into the
+	// note edit area
+	p.setClipRect( 0, 0, WHITE_KEY_WIDTH, keyAreaBottom() );
+
 	// y_offset is used to align the piano-keys on the key-lines
 	int y_offset = 0;
 
@@ -2662,24 +3123,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 	int keys_processed = 0;
 
 	int key = m_startKey;
-
-	// display note marks before drawing other lines
-	for( int i = 0; i < m_markedSemiTones.size(); i++ )
-	{
-		const int key_num = m_markedSemiTones.at( i );
-		const int y = keyAreaBottom() + 5
-			- KEY_LINE_HEIGHT * ( key_num - m_startKey + 1 );
-
-		if( y > keyAreaBottom() )
-		{
-			break;
-		}
-
-		p.fillRect( WHITE_KEY_WIDTH + 1, y - KEY_LINE_HEIGHT / 2, width() - 10, KEY_LINE_HEIGHT,
-			    markedSemitoneColor() );
-	}
-
-
 	// draw all white keys...
 	for( int y = key_line_y + 1 + y_offset; y > PR_TOP_MARGIN;
 			key_line_y -= KEY_LINE_HEIGHT, ++keys_processed )
@@ -2763,7 +3206,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		if( Piano::isWhiteKey( key ) )
 		{
 			// Draw note names if activated in the preferences, C notes are always drawn
-			if ( key % 12 == 0 || drawNoteNames )
+			if ( key % 12 == 0 || m_drawNoteNames )
 			{
 				QString noteString = getNoteString( key );
 
@@ -2861,118 +3304,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
         //qInfo("paintEvent key=%d top=%d",key,PR_TOP_MARGIN);
         bool redline=(key>=NumKeys);
 
-	// erase the area below the piano, because there might be keys that
-	// should be only half-visible
-	p.fillRect( QRect( 0, keyAreaBottom(),
-			WHITE_KEY_WIDTH, noteEditBottom() - keyAreaBottom() ), bgColor );
-
-	// display note editing info
-	QFont f = p.font();
-	f.setBold( false );
-	p.setFont( pointSize<10>( f ) );
-	p.setPen( noteModeColor() );
-	p.drawText( QRect( 0, keyAreaBottom(),
-					  WHITE_KEY_WIDTH, noteEditBottom() - keyAreaBottom() ),
-			   Qt::AlignCenter | Qt::TextWordWrap,
-			   m_nemStr.at( m_noteEditMode ) + ":" );
-
-	// set clipping area, because we are not allowed to paint over
-	// keyboard...
-	p.setClipRect( WHITE_KEY_WIDTH, PR_TOP_MARGIN,
-				width() - WHITE_KEY_WIDTH,
-				height() - PR_TOP_MARGIN - PR_BOTTOM_MARGIN );
-
-	// draw the grid
-	if( hasValidPattern() )
-	{
-		int q, x, tick;
-
-		if( m_zoomingModel.value() > 3 )
-		{
-			// If we're over 100% zoom, we allow all quantization level grids
-			q = quantization();
-		}
-		else if( quantization() % 3 != 0 )
-		{
-			// If we're under 100% zoom, we allow quantization grid up to 1/24 for triplets
-			// to ensure a dense doesn't fill out the background
-			q = quantization() < 8 ? 8 : quantization();
-		}
-		else {
-			// If we're under 100% zoom, we allow quantization grid up to 1/32 for normal notes
-			q = quantization() < 6 ? 6 : quantization();
-		}
-
-		// First we draw the vertical quantization lines
-		for( tick = m_currentPosition - m_currentPosition % q, x = xCoordOfTick( tick );
-			x <= width(); tick += q, x = xCoordOfTick( tick ) )
-		{
-			p.setPen( lineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
-
-		// Draw horizontal lines
-		key = m_startKey;
-		for( int y = keyAreaBottom() - 1; y > PR_TOP_MARGIN;
-				y -= KEY_LINE_HEIGHT )
-		{
-			if( static_cast<Keys>( key % KeysPerOctave ) == Key_C )
-			{
-				// C note gets accented
-				p.setPen( beatLineColor() );
-			}
-			else
-			{
-				p.setPen( lineColor() );
-			}
-			p.drawLine( WHITE_KEY_WIDTH, y, width(), y );
-			++key;
-		}
-
-
-		// Draw alternating shades on bars
-		float timeSignature = static_cast<float>( Engine::getSong()->getTimeSigModel().getNumerator() )
-				/ static_cast<float>( Engine::getSong()->getTimeSigModel().getDenominator() );
-		float zoomFactor = Editor::ZOOM_LEVELS[m_zoomingModel.value()];
-		//the bars which disappears at the left side by scrolling
-		int leftBars = m_currentPosition * zoomFactor / MidiTime::ticksPerTact();
-
-		//iterates the visible bars and draw the shading on uneven bars
-		for( int x = WHITE_KEY_WIDTH, barCount = leftBars; x < width() + m_currentPosition * zoomFactor / timeSignature; x += m_ppt, ++barCount )
-		{
-			if( ( barCount + leftBars )  % 2 != 0 )
-			{
-				p.fillRect( x - m_currentPosition * zoomFactor / timeSignature, PR_TOP_MARGIN, m_ppt,
-					height() - ( PR_BOTTOM_MARGIN + PR_TOP_MARGIN ), backgroundShade() );
-			}
-		}
-
-
-		// Draw the vertical beat lines
-		int ticksPerBeat = DefaultTicksPerTact /
-			Engine::getSong()->getTimeSigModel().getDenominator();
-
-		for( tick = m_currentPosition - m_currentPosition % ticksPerBeat,
-			x = xCoordOfTick( tick ); x <= width();
-			tick += ticksPerBeat, x = xCoordOfTick( tick ) )
-		{
-			p.setPen( beatLineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
-
-		// Draw the vertical bar lines
-		for( tick = m_currentPosition - m_currentPosition % MidiTime::ticksPerTact(),
-			x = xCoordOfTick( tick ); x <= width();
-			tick += MidiTime::ticksPerTact(), x = xCoordOfTick( tick ) )
-		{
-			p.setPen( barLineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
-	}
-
-
-	// following code draws all notes in visible area
-	// and the note editing stuff (volume, panning, etc)
+	p.setClipping( false );
 
 	// setup selection-vars
 	int sel_pos_start = m_selectStartTick;
@@ -2992,106 +3324,13 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 	int y_base = keyAreaBottom() - 1;
 	if( hasValidPattern() )
 	{
-		p.setClipRect( WHITE_KEY_WIDTH, PR_TOP_MARGIN,
-				width() - WHITE_KEY_WIDTH,
-				height() - PR_TOP_MARGIN );
-
-		const int visible_keys = ( keyAreaBottom()-keyAreaTop() ) /
-							KEY_LINE_HEIGHT + 2;
-
-		QPolygonF editHandles;
-
-		for( const Note *note : m_pattern->notes() )
+		// repaints of the keyboard alone don't need the notes
+		if( pe->rect().right() >= WHITE_KEY_WIDTH ||
+			pe->rect().bottom() >= keyAreaBottom() )
 		{
-			int len_ticks = note->length();
-
-			if( len_ticks == 0 )
-			{
-				continue;
-			}
-			else if( len_ticks < 0 )
-			{
-				len_ticks = 4;
-			}
-
-			const int key = note->key() - m_startKey + 1;
-
-			int pos_ticks = note->pos();
-
-			int note_width = len_ticks * m_ppt / MidiTime::ticksPerTact();
-			const int x = ( pos_ticks - m_currentPosition ) *
-					m_ppt / MidiTime::ticksPerTact();
-			// skip this note if not in visible area at all
-			if( !( x + note_width >= 0 && x <= width() - WHITE_KEY_WIDTH ) )
-			{
-				continue;
-			}
-
-			// is the note in visible area?
-			if( key > 0 && key <= visible_keys )
-			{
-
-				// we've done and checked all, let's draw the
-				// note
-				drawNoteRect( p, x + WHITE_KEY_WIDTH,
-						y_base - key * KEY_LINE_HEIGHT,
-								note_width, note, noteColor(), selectedNoteColor(),
-							 	noteOpacity(), noteBorders() );
-			}
-
-			// draw note editing stuff
-			int editHandleTop = 0;
-			if( m_noteEditMode == NoteEditVolume )
-			{
-				QColor color = barColor().lighter( 30 + ( note->getVolume() * 90 / MaxVolume ) );
-				if( note->selected() )
-				{
-					color = selectedNoteColor();
-				}
-				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
-
-				editHandleTop = noteEditBottom() -
-					( (float)( note->getVolume() - MinVolume ) ) /
-					( (float)( MaxVolume - MinVolume ) ) *
-					( (float)( noteEditBottom() - noteEditTop() ) );
-
-				p.drawLine( QLineF ( noteEditLeft() + x + 0.5, editHandleTop + 0.5,
-							noteEditLeft() + x + 0.5, noteEditBottom() + 0.5 ) );
-
-			}
-			else if( m_noteEditMode == NoteEditPanning )
-			{
-				QColor color = noteColor();
-				if( note->selected() )
-				{
-					color = selectedNoteColor();
-				}
-
-				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
-
-				editHandleTop = noteEditBottom() -
-					( (float)( note->getPanning() - PanningLeft ) ) /
-					( (float)( (PanningRight - PanningLeft ) ) ) *
-					( (float)( noteEditBottom() - noteEditTop() ) );
-
-				p.drawLine( QLine( noteEditLeft() + x, noteEditTop() +
-						( (float)( noteEditBottom() - noteEditTop() ) ) / 2.0f,
-						    noteEditLeft() + x , editHandleTop ) );
-			}
-			editHandles << QPoint ( x + noteEditLeft(),
-						editHandleTop );
-
-			if( note->hasDetuningInfo() )
-			{
-				drawDetuningInfo( p, note,
-					x + WHITE_KEY_WIDTH,
-					y_base - key * KEY_LINE_HEIGHT );
-			}
+			updateNoteLayer( state );
+			p.drawPixmap( 0, 0, m_noteLayer );
 		}
-
-		p.setPen( QPen( noteColor(), NOTE_EDIT_LINE_WIDTH + 2 ) );
-		p.drawPoints( editHandles );
-
 	}
 	else
 	{
@@ -3248,12 +3487,14 @@ void PianoRoll::wheelEvent(QWheelEvent * we )
 		if( nv.size() > 0 )
 		{
 			const int step = we->delta() > 0 ? 1.0 : -1.0;
+			beginNoteEdit();
 			if( m_noteEditMode == NoteEditVolume )
 			{
 				for ( Note * n : nv )
 				{
 					volume_t vol = tLimit<int>( n->getVolume() + step, MinVolume, MaxVolume );
 					n->setVolume( vol );
+					markNote( n );
 				}
 				bool allVolumesEqual = std::all_of( nv.begin(), nv.end(),
 					[nv](const Note *note)
@@ -3273,6 +3514,7 @@ void PianoRoll::wheelEvent(QWheelEvent * we )
 				{
 					panning_t pan = tLimit<int>( n->getPanning() + step, PanningLeft, PanningRight );
 					n->setPanning( pan );
+					markNote( n );
 				}
 				bool allPansEqual = std::all_of( nv.begin(), nv.end(),
 					[nv](const Note *note)
@@ -3286,7 +3528,7 @@ void PianoRoll::wheelEvent(QWheelEvent * we )
 					showPanTextFloat( nv[0]->getPanning(), we->pos(), 1000 );
 				}
 			}
-			update();
+			endNoteEdit();
 		}
 	}
 
@@ -1123,7 +1123,8 @@ void Knob::doConnections()
 	{
                 //qInfo("Knob::doConnections p=%p model()=%p",this,m);
                 m->disconnect(this);
-		QObject::connect( m, SIGNAL( dataChanged() ),
+                m->trackChanges();
+		QObject::connect( m, SIGNAL( changed() ),
                                   this, SLOT( friendlyUpdate() ) );
 		QObject::connect( m, SIGNAL( propertiesChanged() ),
                                   this, SLOT( mandatoryUpdate() ) );
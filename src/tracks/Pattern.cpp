@@ -24,9 +24,12 @@
  */
 #include "Pattern.h"
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
+#include <QDataStream>
+#include <QSet>
 #include <QTimer>
 #include <QMenu>
 #include <QMouseEvent>
@@ -421,6 +424,283 @@ void Pattern::loadSettings( const QDomElement & _this )
 
 
 
+// a note as kept in the journal data of a pattern
+struct JournalNote
+{
+	qint32 key;
+	qint32 volume;
+	qint32 panning;
+	qint32 length;
+	qint32 pos;
+
+	bool operator==( const JournalNote & _other ) const
+	{
+		return key == _other.key && volume == _other.volume &&
+			panning == _other.panning &&
+			length == _other.length && pos == _other.pos;
+	}
+
+	bool operator<( const JournalNote & _other ) const
+	{
+		if( pos != _other.pos ) return pos < _other.pos;
+		if( key != _other.key ) return key < _other.key;
+		if( length != _other.length ) return length < _other.length;
+		if( volume != _other.volume ) return volume < _other.volume;
+		return panning < _other.panning;
+	}
+} ;
+
+
+static inline uint qHash( const JournalNote & _note )
+{
+	return ( _note.pos * 31u + _note.key ) * 31u + _note.length;
+}
+
+
+static QDataStream & operator<<( QDataStream & _out, const JournalNote & _note )
+{
+	return _out << _note.key << _note.volume << _note.panning
+					<< _note.length << _note.pos;
+}
+
+
+static QDataStream & operator>>( QDataStream & _in, JournalNote & _note )
+{
+	return _in >> _note.key >> _note.volume >> _note.panning
+					>> _note.length >> _note.pos;
+}
+
+
+static JournalNote journalNote( const Note * _note )
+{
+	JournalNote n;
+	n.key = _note->key();
+	n.volume = _note->getVolume();
+	n.panning = _note->getPanning();
+	n.length = _note->length();
+	n.pos = _note->pos();
+	return n;
+}
+
+
+// the header of the journal data is taken as it is, the notes sorted
+static QVector<JournalNote> readJournalNotes( const QByteArray & _data,
+							QByteArray * _header )
+{
+	QDataStream in( _data );
+	qint32 type, pos, steps, stepResolution, count;
+	QString name;
+	bool muted;
+	in >> type >> name >> pos >> muted >> steps >> stepResolution;
+	if( _header != NULL )
+	{
+		*_header = _data.left( in.device()->pos() );
+	}
+	in >> count;
+
+	QVector<JournalNote> notes;
+	notes.reserve( qMax<qint32>( count, 0 ) );
+	for( qint32 i = 0; i < count && !in.atEnd(); ++i )
+	{
+		JournalNote n;
+		in >> n;
+		notes.push_back( n );
+	}
+	std::sort( notes.begin(), notes.end() );
+	return notes;
+}
+
+
+
+
+// same state as saveSettings(), but as plain binary so every note edit in
+// the piano roll doesn't cost an XML document in the undo journal
+bool Pattern::saveJournalData( QDataStream & _out ) const
+{
+	for( NoteVector::ConstIterator it = m_notes.begin();
+						it != m_notes.end(); ++it )
+	{
+		if( ( *it )->hasDetuningInfo() )
+		{
+			// detuning automation needs the full state
+			return false;
+		}
+	}
+
+	_out << static_cast<qint32>( m_patternType ) << name()
+		<< static_cast<qint32>( startPosition() ) << isMuted()
+		<< static_cast<qint32>( m_steps )
+		<< static_cast<qint32>( m_stepResolution )
+		<< static_cast<qint32>( m_notes.size() );
+
+	for( NoteVector::ConstIterator it = m_notes.begin();
+						it != m_notes.end(); ++it )
+	{
+		_out << journalNote( *it );
+	}
+	return true;
+}
+
+
+
+
+void Pattern::restoreJournalData( QDataStream & _in )
+{
+	restoreJournalHeader( _in );
+
+	// the notes are replaced under the same lock as in applyJournalDiff()
+	instrumentTrack()->lock();
+	for( NoteVector::Iterator it = m_notes.begin();
+					it != m_notes.end(); ++it )
+	{
+		delete *it;
+	}
+	m_notes.clear();
+
+	qint32 count;
+	_in >> count;
+	for( qint32 i = 0; i < count && !_in.atEnd(); ++i )
+	{
+		JournalNote n;
+		_in >> n;
+		m_notes.push_back( new Note( n.length, n.pos, n.key, n.volume,
+								n.panning ) );
+	}
+	instrumentTrack()->unlock();
+
+	checkType();
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
+// A note which was moved, resized and so on is removed and added again, so
+// a check point before editing a few notes of a large pattern only keeps
+// those instead of all of them.
+bool Pattern::diffJournalData( const QByteArray & _from,
+				const QByteArray & _to, QDataStream & _out ) const
+{
+	QByteArray header;
+	const QVector<JournalNote> from = readJournalNotes( _from, NULL );
+	const QVector<JournalNote> to = readJournalNotes( _to, &header );
+
+	QVector<JournalNote> removed;
+	QVector<JournalNote> added;
+	int i = 0;
+	int j = 0;
+	while( i < from.size() || j < to.size() )
+	{
+		if( j == to.size() || ( i < from.size() && from[i] < to[j] ) )
+		{
+			removed.push_back( from[i++] );
+		}
+		else if( i == from.size() || to[j] < from[i] )
+		{
+			added.push_back( to[j++] );
+		}
+		else
+		{
+			++i;
+			++j;
+		}
+	}
+
+	_out.writeRawData( header.constData(), header.size() );
+	_out << removed << added;
+	return true;
+}
+
+
+
+
+void Pattern::applyJournalDiff( QDataStream & _in )
+{
+	restoreJournalHeader( _in );
+
+	QVector<JournalNote> removed;
+	QVector<JournalNote> added;
+	_in >> removed >> added;
+
+	instrumentTrack()->lock();
+	if( !removed.isEmpty() )
+	{
+		QMultiHash<JournalNote, Note *> notes;
+		for( NoteVector::ConstIterator it = m_notes.begin();
+						it != m_notes.end(); ++it )
+		{
+			notes.insert( journalNote( *it ), *it );
+		}
+
+		QSet<Note *> gone;
+		for( const JournalNote & n : removed )
+		{
+			QMultiHash<JournalNote, Note *>::Iterator it =
+								notes.find( n );
+			if( it != notes.end() )
+			{
+				gone.insert( it.value() );
+				notes.erase( it );
+			}
+		}
+
+		NoteVector kept;
+		kept.reserve( m_notes.size() - gone.size() );
+		for( NoteVector::ConstIterator it = m_notes.begin();
+						it != m_notes.end(); ++it )
+		{
+			if( gone.contains( *it ) )
+			{
+				delete *it;
+			}
+			else
+			{
+				kept.push_back( *it );
+			}
+		}
+		m_notes = kept;
+	}
+
+	for( const JournalNote & n : added )
+	{
+		m_notes.push_back( new Note( n.length, n.pos, n.key, n.volume,
+								n.panning ) );
+	}
+	rearrangeAllNotes();
+	instrumentTrack()->unlock();
+
+	checkType();
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
+void Pattern::restoreJournalHeader( QDataStream & _in )
+{
+	qint32 type, pos, steps, stepResolution;
+	QString name;
+	bool muted;
+	_in >> type >> name >> pos >> muted >> steps >> stepResolution;
+
+	m_patternType = static_cast<PatternTypes>( type );
+	setName( name );
+	movePosition( pos );
+	if( muted != isMuted() )
+	{
+		toggleMute();
+	}
+	m_steps = steps;
+	m_stepResolution = stepResolution;
+}
+
+
+
+
 Pattern *  Pattern::previousPattern() const
 {
 	return adjacentPatternByOffset(-1);
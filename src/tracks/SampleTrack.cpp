@@ -296,8 +296,7 @@ void SampleTCO::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	_this.setAttribute( "src", sampleFile() );
 	if( sampleFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "data", m_sampleBuffer->toBase64( s ) );
+		m_sampleBuffer->saveData( _doc, _this );
 	}
 	// TODO: start- and end-frame
 }
@@ -309,8 +308,8 @@ void SampleTCO::loadSettings( const QDomElement & _this )
 {
         TrackContentObject::loadSettings(_this);
 	setSampleFile( _this.attribute( "src" ) );
-	if( sampleFile().isEmpty() && _this.hasAttribute( "data" ) )
-		m_sampleBuffer->loadFromBase64( _this.attribute( "data" ) );
+	if( sampleFile().isEmpty() )
+		m_sampleBuffer->loadData( _this );
         setInitialPlayTick( _this.attribute( "initial" ).toInt() );
 
         /*
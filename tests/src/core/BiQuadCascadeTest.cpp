@@ -0,0 +1,181 @@
+/*
+ * BiQuadCascadeTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "BiQuadCascade.h"
+
+// peaking equalizer from the RBJ cookbook, f as a fraction of the rate
+static BiQuadCoefficients peak(double f, double gainDb, double q)
+{
+	const double A = pow(10, gainDb / 40);
+	const double w0 = 2 * M_PI * f;
+	const double alpha = sin(w0) / (2 * q);
+	const double a0 = 1 + alpha / A;
+	BiQuadCoefficients c;
+	c.b0 = (1 + alpha * A) / a0;
+	c.b1 = -2 * cos(w0) / a0;
+	c.b2 = (1 - alpha * A) / a0;
+	c.a1 = -2 * cos(w0) / a0;
+	c.a2 = (1 - alpha / A) / a0;
+	return c;
+}
+
+// interleaved frames
+typedef std::vector<float> Signal;
+
+static sampleFrame* frames(Signal& buf)
+{
+	return reinterpret_cast<sampleFrame*>(buf.data());
+}
+
+// the stages one after the other in direct form I, in double precision
+static void reference(const std::vector<BiQuadCoefficients>& stages,
+				Signal& buf)
+{
+	for (const BiQuadCoefficients& c : stages)
+	{
+		for (int ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+			for (size_t f = 0; f < buf.size() / DEFAULT_CHANNELS; ++f)
+			{
+				float& sample = frames(buf)[f][ch];
+				const double x = sample;
+				const double y = c.b0 * x + c.b1 * x1 + c.b2 * x2
+							- c.a1 * y1 - c.a2 * y2;
+				x2 = x1;
+				x1 = x;
+				y2 = y1;
+				y1 = y;
+				sample = y;
+			}
+		}
+	}
+}
+
+static Signal noise(int frames)
+{
+	Signal buf(frames * DEFAULT_CHANNELS);
+	unsigned int seed = 12345;
+	for (float& sample : buf)
+	{
+		seed = seed * 1103515245 + 12345;
+		sample = ((seed >> 8) & 0xffff) / 65536.0f - 0.5f;
+	}
+	return buf;
+}
+
+class BiQuadCascadeTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	// the whole signal is processed in blocks of the given lengths
+	void compare(int stageCount, const std::vector<int>& blocks)
+	{
+		std::vector<BiQuadCoefficients> stages;
+		BiQuadCascade cascade;
+		for (int s = 0; s < stageCount; ++s)
+		{
+			stages.push_back(peak(0.01 + 0.03 * s, s % 2 ? -6 : 9, 0.7 + 0.5 * s));
+			cascade.setStage(s, stages.back());
+			cascade.setActive(s, true);
+		}
+
+		int length = 0;
+		for (int b : blocks)
+		{
+			length += b;
+		}
+		Signal expected = noise(length);
+		Signal actual = expected;
+		reference(stages, expected);
+
+		int pos = 0;
+		for (int b : blocks)
+		{
+			cascade.process(frames(actual) + pos, b);
+			pos += b;
+		}
+
+		for (size_t i = 0; i < actual.size(); ++i)
+		{
+			if (fabsf(actual[i] - expected[i]) > 1e-4f)
+			{
+				QFAIL(qPrintable(QString("%1 stages, frame %2, channel %3: %4 instead of %5")
+					.arg(stageCount).arg(i / DEFAULT_CHANNELS)
+					.arg(i % DEFAULT_CHANNELS)
+					.arg(actual[i]).arg(expected[i])));
+			}
+		}
+	}
+
+private slots:
+	void SingleStageTests()
+	{
+		compare(1, {1});
+		compare(1, {7, 64});
+	}
+
+	void PairedStageTests()
+	{
+		compare(2, {1, 1, 1});
+		compare(4, {33, 1, 256});
+	}
+
+	void OddStageCountTests()
+	{
+		compare(3, {1});
+		compare(3, {5, 127, 2});
+		compare(5, {255, 3});
+		compare(7, {17, 1, 64});
+	}
+
+	void InactiveStageTests()
+	{
+		// an inactive stage in the middle is left out of the chain
+		BiQuadCascade cascade;
+		std::vector<BiQuadCoefficients> stages;
+		for (int s = 0; s < 3; ++s)
+		{
+			cascade.setStage(s, peak(0.02 + 0.05 * s, 6, 1));
+			cascade.setActive(s, s != 1);
+			if (s != 1)
+			{
+				stages.push_back(peak(0.02 + 0.05 * s, 6, 1));
+			}
+		}
+		Signal expected = noise(99);
+		Signal actual = expected;
+		reference(stages, expected);
+		cascade.process(frames(actual), 99);
+		for (size_t i = 0; i < actual.size(); ++i)
+		{
+			QVERIFY(fabsf(actual[i] - expected[i]) < 1e-4f);
+		}
+	}
+} BiQuadCascadeTests;
+
+#include "BiQuadCascadeTest.moc"
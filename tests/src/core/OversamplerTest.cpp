@@ -0,0 +1,176 @@
+/*
+ * OversamplerTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Engine.h"
+#include "Mixer.h"
+#include "Oversampler.h"
+
+// interleaved frames
+typedef std::vector<float> Signal;
+
+static sampleFrame* frames(Signal& buf)
+{
+	return reinterpret_cast<sampleFrame*>(buf.data());
+}
+
+// amplitude of frequency f (as a fraction of the rate) in the left channel,
+// measured with a Hann window
+static double amplitude(const sampleFrame* buf, int length, double f)
+{
+	double re = 0, im = 0, weight = 0;
+	for (int n = 0; n < length; ++n)
+	{
+		const double w = 0.5 - 0.5 * cos(2 * M_PI * n / length);
+		re += w * buf[n][0] * cos(2 * M_PI * f * n);
+		im += w * buf[n][0] * sin(2 * M_PI * f * n);
+		weight += w;
+	}
+	return 2 * sqrt(re * re + im * im) / weight;
+}
+
+static void sine(sampleFrame* buf, int length, double f, int start)
+{
+	for (int n = 0; n < length; ++n)
+	{
+		buf[n][0] = buf[n][1] = sin(2 * M_PI * f * (start + n));
+	}
+}
+
+static double dB(double amplitude)
+{
+	return 20 * log10(amplitude);
+}
+
+class OversamplerTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	static const int Periods = 32;
+	// enough for the filters of all stages to settle
+	static const int SkippedPeriods = 4;
+
+	// a sine at f (a fraction of the base rate) through up() and down()
+	// without any processing in between
+	double passband(int factor, double f)
+	{
+		const int fpp = Engine::mixer()->framesPerPeriod();
+		Oversampler oversampler(factor);
+		Signal out(Periods * fpp * DEFAULT_CHANNELS);
+		for (int p = 0; p < Periods; ++p)
+		{
+			sampleFrame* buf = frames(out) + p * fpp;
+			sine(buf, fpp, f, p * fpp);
+			oversampler.up(buf, fpp);
+			oversampler.down(buf, fpp);
+		}
+		const int skipped = SkippedPeriods * fpp;
+		return amplitude(frames(out) + skipped, out.size() / DEFAULT_CHANNELS - skipped, f);
+	}
+
+	// level of the image of a sine at f in the output of up(), relative to
+	// the sine
+	double image(int factor, double f)
+	{
+		const int fpp = Engine::mixer()->framesPerPeriod();
+		Oversampler oversampler(factor);
+		Signal in(fpp * DEFAULT_CHANNELS);
+		Signal up(Periods * fpp * factor * DEFAULT_CHANNELS);
+		for (int p = 0; p < Periods; ++p)
+		{
+			sine(frames(in), fpp, f, p * fpp);
+			const sampleFrame* buf = oversampler.up(frames(in), fpp);
+			std::copy(buf[0], buf[0] + fpp * factor * DEFAULT_CHANNELS,
+				up.begin() + p * fpp * factor * DEFAULT_CHANNELS);
+		}
+		const int skipped = SkippedPeriods * fpp * factor;
+		const int length = up.size() / DEFAULT_CHANNELS - skipped;
+		return dB(amplitude(frames(up) + skipped, length, (1 - f) / factor) /
+				amplitude(frames(up) + skipped, length, f / factor));
+	}
+
+	// level of a sine at f (above half the base rate) that folds back when
+	// down() brings it to the base rate
+	double alias(int factor, double f)
+	{
+		const int fpp = Engine::mixer()->framesPerPeriod();
+		Oversampler oversampler(factor);
+		Signal silence(fpp * DEFAULT_CHANNELS);
+		Signal out(Periods * fpp * DEFAULT_CHANNELS);
+		for (int p = 0; p < Periods; ++p)
+		{
+			sampleFrame* buf = oversampler.up(frames(silence), fpp);
+			sine(buf, fpp * factor, f / factor, p * fpp * factor);
+			oversampler.down(frames(out) + p * fpp, fpp);
+		}
+		const int skipped = SkippedPeriods * fpp;
+		return dB(amplitude(frames(out) + skipped,
+				out.size() / DEFAULT_CHANNELS - skipped, 1 - f));
+	}
+
+private slots:
+	void PassbandTests()
+	{
+		for (int factor = 2; factor <= Oversampler::MaxFactor; factor *= 2)
+		{
+			for (double f : {0.01, 0.1, 0.2})
+			{
+				const double a = passband(factor, f);
+				QVERIFY2(fabs(a - 1) < 0.01, qPrintable(QString(
+					"factor %1, %2: gain %3").arg(factor).arg(f).arg(a)));
+			}
+		}
+	}
+
+	void ImageTests()
+	{
+		for (int factor = 2; factor <= Oversampler::MaxFactor; factor *= 2)
+		{
+			for (double f : {0.05, 0.15})
+			{
+				const double level = image(factor, f);
+				QVERIFY2(level < -60, qPrintable(QString(
+					"factor %1, %2: image at %3 dB").arg(factor).arg(f).arg(level)));
+			}
+		}
+	}
+
+	void AliasTests()
+	{
+		for (int factor = 2; factor <= Oversampler::MaxFactor; factor *= 2)
+		{
+			for (double f : {0.8, 0.9})
+			{
+				const double level = alias(factor, f);
+				QVERIFY2(level < -60, qPrintable(QString(
+					"factor %1, %2: alias at %3 dB").arg(factor).arg(f).arg(level)));
+			}
+		}
+	}
+} OversamplerTests;
+
+#include "OversamplerTest.moc"